@@ -12,6 +12,7 @@
 #include "common.hpp"
 #include "jtag.hpp"
 #include "device.hpp"
+#include "display.hpp"
 #include "epcq.hpp"
 #include "progressBar.hpp"
 #include "rawParser.hpp"
@@ -80,8 +81,6 @@ void Altera::programMem(RawParser &_bit)
 	int byte_length = _bit.getLength()/8;
 	uint8_t *data = _bit.getData();
 
-	uint32_t clk_period = 1e9/static_cast<float>(_jtag->getClkFreq());
-
 	unsigned char cmd[2];
 	unsigned char tx[864/8], rx[864/8];
 
@@ -93,9 +92,9 @@ void Altera::programMem(RawParser &_bit)
 	/* ir 0x02 IRLENGTH */
 	*reinterpret_cast<uint16_t *>(cmd) = 0x02;
 	_jtag->shiftIR(cmd, NULL, IRLENGTH, Jtag::PAUSE_IR);
-	/* RUNTEST IDLE 12000 TCK ENDSTATE IDLE; */
+	/* RUNTEST IDLE 12000 TCK ENDSTATE IDLE; (1ms @ 12MHz) */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
-	_jtag->toggleClk(1000000/clk_period);
+	_jtag->delay(1000000, 12000);
 	/* write */
 	ProgressBar progress("Flash SRAM", byte_length, 50, _quiet);
 
@@ -120,9 +119,9 @@ void Altera::programMem(RawParser &_bit)
 	/* SIR 10 TDI (004); */
 	*reinterpret_cast<uint16_t *>(cmd) = 0x04;
 	_jtag->shiftIR(cmd, NULL, IRLENGTH, Jtag::PAUSE_IR);
-	/* RUNTEST 60 TCK; */
+	/* RUNTEST 60 TCK; (5us @ 12MHz) */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
-	_jtag->toggleClk(5000/clk_period);
+	_jtag->delay(5000, 60);
 	/*
 	 * SDR 864 TDI
 	 * (000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000)
@@ -136,9 +135,9 @@ void Altera::programMem(RawParser &_bit)
 	/* SIR 10 TDI (003); */
 	*reinterpret_cast<uint16_t *>(cmd) = 0x003;
 	_jtag->shiftIR(cmd, NULL, IRLENGTH, Jtag::PAUSE_IR);
-	/* RUNTEST 49152 TCK; */
+	/* RUNTEST 49152 TCK; (4.1ms @ 12MHz) */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
-	_jtag->toggleClk(4099645/clk_period);
+	_jtag->delay(4099645, 49152);
 	/* RUNTEST 512 TCK; */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
 	_jtag->toggleClk(512);
@@ -146,9 +145,9 @@ void Altera::programMem(RawParser &_bit)
 	*reinterpret_cast<uint16_t *>(cmd) = BYPASS;
 	_jtag->shiftIR(cmd, NULL, IRLENGTH, Jtag::PAUSE_IR);
 
-	/* RUNTEST 12000 TCK; */
+	/* RUNTEST 12000 TCK; (1ms @ 12MHz) */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
-	_jtag->toggleClk(1000000/clk_period);
+	_jtag->delay(1000000, 12000);
 	/* -> idle */
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
 }
@@ -195,7 +194,7 @@ bool Altera::load_bridge()
 	bitname = PathHelper::absolutePath(bitname);
 #endif
 
-	std::cout << "use: " << bitname << std::endl;
+	printInfo("use: " + bitname);
 
 	/* first: load spi over jtag */
 	try {
@@ -317,19 +316,19 @@ int Altera::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 
 		count++;
 		if (count == timeout){
-			printf("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
+			printfInfo("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
 			break;
 		}
 
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		}
 	} while ((tmp & mask) != cond);
 	_jtag->set_state(Jtag::UPDATE_DR);
 
 	if (count == timeout) {
-		printf("%x\n", tmp);
-		std::cout << "wait: Error" << std::endl;
+		printfInfo("%x\n", tmp);
+		printError("wait: Error");
 		return -1;
 	}
 	return 0;
@@ -346,7 +345,7 @@ void Altera::shiftVIR(uint32_t reg)
 
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
 
-	_jtag->shiftIR(tx_ir, NULL, IRLENGTH, Jtag::UPDATE_IR);
+	_jtag->shiftIR_cached(tx_ir, IRLENGTH, Jtag::UPDATE_IR);
 	/* len + 1 + 1 => IRLENGTH + Slave ID + 1 (ASMI/SFL) */
 	_jtag->shiftDR(tx, NULL, len/* + 2*/, Jtag::UPDATE_DR);
 }
@@ -356,6 +355,6 @@ void Altera::shiftVDR(uint8_t * tx, uint8_t * rx, uint32_t len,
 {
 	(void) debug;
 	uint8_t tx_ir[2] = {USER0, 0};
-	_jtag->shiftIR(tx_ir, NULL, IRLENGTH, Jtag::UPDATE_IR);
+	_jtag->shiftIR_cached(tx_ir, IRLENGTH, Jtag::UPDATE_IR);
 	_jtag->shiftDR(tx, rx, len, end_state);
 }
@@ -11,6 +11,7 @@
 #include "anlogicBitParser.hpp"
 #include "jtag.hpp"
 #include "device.hpp"
+#include "bitOps.hpp"
 #include "display.hpp"
 #include "progressBar.hpp"
 #include "spiFlash.hpp"
@@ -193,21 +194,16 @@ int Anlogic::spi_put(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint32_t len)
 	uint8_t jrx[xfer_len];
 
 	jtx[0] = AnlogicBitParser::reverseByte(cmd);
-	if (tx != NULL) {
-		for (uint32_t i = 0; i < len; i++)
-			jtx[i+1] = AnlogicBitParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx + 1, tx, len);
 
 	/* write anlogic command before sending packet */
 	uint8_t op = 0x60;
 	_jtag->shiftDR(&op, NULL, 8);
 
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = AnlogicBitParser::reverseByte(jrx[i+1]>>1)
-				| (jrx[i+2]&0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx + 1, len);
 	return 0;
 }
 int Anlogic::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
@@ -218,21 +214,16 @@ int Anlogic::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	uint8_t jtx[xfer_len];
 	uint8_t jrx[xfer_len];
 
-	if (tx != NULL) {
-		for (uint32_t i = 0; i < len; i++)
-			jtx[i] = AnlogicBitParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx, tx, len);
 
 	/* write anlogic command before sending packet */
 	uint8_t op = 0x60;
 	_jtag->shiftDR(&op, NULL, 8);
 
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = AnlogicBitParser::reverseByte(jrx[i]>>1) |
-				(jrx[i+1]&0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx, len);
 	return 0;
 }
 int Anlogic::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
@@ -251,16 +242,16 @@ int Anlogic::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		tmp = (AnlogicBitParser::reverseByte(rx[1]>>1)) | (0x01 & rx[2]);
 		count ++;
 		if (count == timeout) {
-			printf("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
+			printfInfo("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
 			break;
 		}
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		}
 	} while ((tmp & mask) != cond);
 
 	if (count == timeout) {
-		printf("%02x\n", tmp);
+		printfInfo("%02x\n", tmp);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	}
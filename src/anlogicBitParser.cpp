@@ -88,12 +88,12 @@ int AnlogicBitParser::parse()
 
 		pos += 2;
 		if ((len & 7) != 0) {
-			printf("error\n");
+			printfInfo("error\n");
 			return EXIT_FAILURE;
 		}
 		len >>= 3;
 		if ((pos + len) > _raw_data.size()) {
-			printf("error\n");
+			printfInfo("error\n");
 			return EXIT_FAILURE;
 		}
 
@@ -14,6 +14,7 @@
 
 #include "anlogicCable.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -122,7 +123,7 @@ int AnlogicCable::setClkFreq(uint32_t clkHZ)
 		clkHZ = 90000;
 	}
 
-	ret = libusb_bulk_transfer(dev_handle, ANLOGICCABLE_CONF_EP,
+	ret = stats_libusb_bulk_transfer(dev_handle, ANLOGICCABLE_CONF_EP,
 			        buf, 2, &actual_length, 1000);
 	if (ret < 0) {
 		cerr << "setClkFreq: usb bulk write failed " << ret << endl;
@@ -274,14 +275,14 @@ int AnlogicCable::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 int AnlogicCable::write(uint8_t *in_buf, uint8_t *out_buf, int len, int rd_len)
 {
 	int actual_length;
-	int ret = libusb_bulk_transfer(dev_handle, ANLOGICCABLE_WRITE_EP,
+	int ret = stats_libusb_bulk_transfer(dev_handle, ANLOGICCABLE_WRITE_EP,
 			in_buf, len, &actual_length, 1000);
 	if (ret < 0) {
 		cerr << "write: usb bulk write failed " << ret << endl;
 		return -EXIT_FAILURE;
 	}
 	/* all write must be followed by a read */
-	ret = libusb_bulk_transfer(dev_handle, ANLOGICCABLE_READ_EP,
+	ret = stats_libusb_bulk_transfer(dev_handle, ANLOGICCABLE_READ_EP,
 			in_buf, len, &actual_length, 1000);
 	if (ret < 0) {
 		cerr << "write: usb bulk read failed " << ret << endl;
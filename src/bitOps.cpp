@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "bitOps.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* return n bits (n <= 56) starting at bit off (< 8) of src.
+ * Only required bytes are read
+ */
+static inline uint64_t load_bits(const uint8_t *src, uint32_t off, uint32_t n)
+{
+	uint32_t nb = (off + n + 7) >> 3;
+	uint64_t v = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (nb == 8) {
+		memcpy(&v, src, 8);
+	} else
+#endif
+	{
+		for (uint32_t i = 0; i < nb; i++)
+			v |= static_cast<uint64_t>(src[i]) << (8 * i);
+	}
+	return (v >> off) & ((1ULL << n) - 1);
+}
+
+void bit_copy(uint8_t *dst, uint32_t dst_off, const uint8_t *src,
+	uint32_t src_off, uint32_t len)
+{
+	if (len == 0)
+		return;
+
+	dst += dst_off >> 3;
+	dst_off &= 0x07;
+	src += src_off >> 3;
+	src_off &= 0x07;
+
+	/* head: align destination on a byte boundary */
+	if (dst_off != 0) {
+		uint32_t n = 8 - dst_off;
+		if (n > len)
+			n = len;
+		uint8_t mask = ((1 << n) - 1) << dst_off;
+		uint8_t v = static_cast<uint8_t>(load_bits(src, src_off, n) << dst_off);
+		*dst = (*dst & ~mask) | (v & mask);
+		dst++;
+		len -= n;
+		src_off += n;
+		src += src_off >> 3;
+		src_off &= 0x07;
+	}
+
+	/* body: same alignment -> plain copy, otherwise 7 bytes by step */
+	if (src_off == 0) {
+		memcpy(dst, src, len >> 3);
+		dst += len >> 3;
+		src += len >> 3;
+		len &= 0x07;
+	} else {
+		while (len >= 56) {
+			uint64_t v = load_bits(src, src_off, 56);
+			for (int i = 0; i < 7; i++)
+				dst[i] = static_cast<uint8_t>(v >> (8 * i));
+			dst += 7;
+			src += 7;
+			len -= 56;
+		}
+		while (len >= 8) {
+			*dst++ = static_cast<uint8_t>(load_bits(src, src_off, 8));
+			src++;
+			len -= 8;
+		}
+	}
+
+	/* tail: less than 8 bits */
+	if (len != 0) {
+		uint8_t mask = (1 << len) - 1;
+		uint8_t v = static_cast<uint8_t>(load_bits(src, src_off, len));
+		*dst = (*dst & ~mask) | (v & mask);
+	}
+}
+
+void bit_fill(uint8_t *dst, uint32_t dst_off, uint32_t len, bool val)
+{
+	if (len == 0)
+		return;
+
+	uint8_t fill = (val) ? 0xff : 0x00;
+	dst += dst_off >> 3;
+	dst_off &= 0x07;
+
+	if (dst_off != 0) {
+		uint32_t n = 8 - dst_off;
+		if (n > len)
+			n = len;
+		uint8_t mask = ((1 << n) - 1) << dst_off;
+		*dst = (*dst & ~mask) | (fill & mask);
+		dst++;
+		len -= n;
+	}
+
+	memset(dst, fill, len >> 3);
+	dst += len >> 3;
+	len &= 0x07;
+
+	if (len != 0) {
+		uint8_t mask = (1 << len) - 1;
+		*dst = (*dst & ~mask) | (fill & mask);
+	}
+}
+
+uint32_t bit_run_length(const uint8_t *buf, uint32_t pos, uint32_t len,
+	bool val)
+{
+	uint8_t ref = (val) ? 0xff : 0x00;
+	uint32_t run = 0;
+
+	/* head and tail are checked bit by bit, body byte by byte */
+	while (run < len && ((pos + run) & 0x07) != 0) {
+		if (bit_get(buf, pos + run) != (val ? 1 : 0))
+			return run;
+		run++;
+	}
+	while (len - run >= 8 && buf[(pos + run) >> 3] == ref)
+		run += 8;
+	while (run < len) {
+		if (bit_get(buf, pos + run) != (val ? 1 : 0))
+			return run;
+		run++;
+	}
+	return run;
+}
+
+/* reverse bits in each byte of a 64bits word */
+static inline uint64_t reverse_word(uint64_t v)
+{
+	v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+	v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+	v = ((v >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((v & 0x0f0f0f0f0f0f0f0fULL) << 4);
+	return v;
+}
+
+static inline uint8_t reverse_byte(uint8_t v)
+{
+	return static_cast<uint8_t>(reverse_word(v));
+}
+
+#if defined(__AVX2__)
+#define VEC_LEN 32
+typedef __m256i vec_t;
+static inline vec_t vec_load(const uint8_t *p)
+{ return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));}
+static inline void vec_store(uint8_t *p, vec_t v)
+{ _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);}
+static inline vec_t vec_set1(uint8_t c) { return _mm256_set1_epi8(c);}
+static inline vec_t vec_and(vec_t a, vec_t b) { return _mm256_and_si256(a, b);}
+static inline vec_t vec_or(vec_t a, vec_t b) { return _mm256_or_si256(a, b);}
+/* 16bits lanes shifts: callers mask bits crossing bytes */
+#define vec_srl(a, n) _mm256_srli_epi16(a, n)
+#define vec_sll(a, n) _mm256_slli_epi16(a, n)
+#elif defined(__SSE2__)
+#define VEC_LEN 16
+typedef __m128i vec_t;
+static inline vec_t vec_load(const uint8_t *p)
+{ return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));}
+static inline void vec_store(uint8_t *p, vec_t v)
+{ _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);}
+static inline vec_t vec_set1(uint8_t c)
+{ return _mm_set1_epi8(static_cast<char>(c));}
+static inline vec_t vec_and(vec_t a, vec_t b) { return _mm_and_si128(a, b);}
+static inline vec_t vec_or(vec_t a, vec_t b) { return _mm_or_si128(a, b);}
+#define vec_srl(a, n) _mm_srli_epi16(a, n)
+#define vec_sll(a, n) _mm_slli_epi16(a, n)
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define VEC_LEN 16
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+static inline vec_t vec_reverse(vec_t v)
+{
+	const vec_t m1 = vec_set1(0x55), m2 = vec_set1(0x33), m4 = vec_set1(0x0f);
+	v = vec_or(vec_and(vec_srl(v, 1), m1), vec_sll(vec_and(v, m1), 1));
+	v = vec_or(vec_and(vec_srl(v, 2), m2), vec_sll(vec_and(v, m2), 2));
+	v = vec_or(vec_and(vec_srl(v, 4), m4), vec_sll(vec_and(v, m4), 4));
+	return v;
+}
+#endif
+
+void bit_reverse_bytes(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	uint32_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+	for (; i + VEC_LEN <= len; i += VEC_LEN)
+		vec_store(dst + i, vec_reverse(vec_load(src + i)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for (; i + VEC_LEN <= len; i += VEC_LEN)
+		vst1q_u8(dst + i, vrbitq_u8(vld1q_u8(src + i)));
+#endif
+	for (; i + 8 <= len; i += 8) {
+		uint64_t v;
+		memcpy(&v, src + i, 8);
+		v = reverse_word(v);
+		memcpy(dst + i, &v, 8);
+	}
+	for (; i < len; i++)
+		dst[i] = reverse_byte(src[i]);
+}
+
+void bit_reverse_shift1(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	/* reverse(x >> 1) == reverse(x) << 1 and (x & 0x01) == reverse(x) >> 7:
+	 * dst is reversed stream shifted by one bit (MSB first)
+	 */
+	uint32_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+	const vec_t hi = vec_set1(0xfe), lo = vec_set1(0x01);
+	for (; i + VEC_LEN <= len; i += VEC_LEN) {
+		vec_t r0 = vec_reverse(vec_load(src + i));
+		vec_t r1 = vec_reverse(vec_load(src + i + 1));
+		vec_store(dst + i, vec_or(vec_and(vec_sll(r0, 1), hi),
+			vec_and(vec_srl(r1, 7), lo)));
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for (; i + VEC_LEN <= len; i += VEC_LEN) {
+		uint8x16_t r0 = vrbitq_u8(vld1q_u8(src + i));
+		uint8x16_t r1 = vrbitq_u8(vld1q_u8(src + i + 1));
+		vst1q_u8(dst + i, vorrq_u8(vshlq_n_u8(r0, 1), vshrq_n_u8(r1, 7)));
+	}
+#endif
+	for (; i + 8 <= len; i += 8) {
+		uint64_t v0, v1;
+		memcpy(&v0, src + i, 8);
+		memcpy(&v1, src + i + 1, 8);
+		v0 = (reverse_word(v0) << 1) & 0xfefefefefefefefeULL;
+		v1 = (reverse_word(v1) >> 7) & 0x0101010101010101ULL;
+		v0 |= v1;
+		memcpy(dst + i, &v0, 8);
+	}
+	for (; i < len; i++)
+		dst[i] = static_cast<uint8_t>(reverse_byte(src[i]) << 1) |
+			(src[i + 1] & 0x01);
+}
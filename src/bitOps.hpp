@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_BITOPS_HPP_
+#define SRC_BITOPS_HPP_
+
+#include <cstdint>
+
+/*!
+ * \file bitOps.hpp
+ * \brief bit span helpers for JTAG buffers. Bit n of a buffer is
+ *        bit (n & 0x07) of byte (n >> 3) (LSB first)
+ */
+
+/*!
+ * \brief read one bit
+ * \param[in] buf: buffer
+ * \param[in] pos: bit position
+ * \return bit value (0 or 1)
+ */
+static inline uint8_t bit_get(const uint8_t *buf, uint32_t pos)
+{
+	return (buf[pos >> 3] >> (pos & 0x07)) & 0x01;
+}
+
+/*!
+ * \brief write one bit
+ * \param[in] buf: buffer
+ * \param[in] pos: bit position
+ * \param[in] val: bit value
+ */
+static inline void bit_set(uint8_t *buf, uint32_t pos, bool val)
+{
+	if (val)
+		buf[pos >> 3] |= (1 << (pos & 0x07));
+	else
+		buf[pos >> 3] &= ~(1 << (pos & 0x07));
+}
+
+/*!
+ * \brief copy len bits from src (starting at src_off) to dst
+ *        (starting at dst_off). Bits outside destination span are
+ *        unchanged
+ * \param[out] dst: destination buffer
+ * \param[in] dst_off: first bit in destination
+ * \param[in] src: source buffer
+ * \param[in] src_off: first bit in source
+ * \param[in] len: number of bits
+ */
+void bit_copy(uint8_t *dst, uint32_t dst_off, const uint8_t *src,
+	uint32_t src_off, uint32_t len);
+
+/*!
+ * \brief set len bits to val, starting at dst_off
+ * \param[out] dst: destination buffer
+ * \param[in] dst_off: first bit in destination
+ * \param[in] len: number of bits
+ * \param[in] val: bits value
+ */
+void bit_fill(uint8_t *dst, uint32_t dst_off, uint32_t len, bool val);
+
+/*!
+ * \brief count consecutive bits equal to val, starting at pos
+ * \param[in] buf: buffer
+ * \param[in] pos: first bit
+ * \param[in] len: max number of bits to check
+ * \param[in] val: bits value
+ * \return number of bits equal to val (<= len)
+ */
+uint32_t bit_run_length(const uint8_t *buf, uint32_t pos, uint32_t len,
+	bool val);
+
+/*!
+ * \brief reverse bits order in each byte (MSB first <-> LSB first)
+ *        SSE2/AVX2/NEON when available at compile time
+ * \param[out] dst: destination buffer (may be equal to src)
+ * \param[in] src: source buffer
+ * \param[in] len: number of bytes
+ */
+void bit_reverse_bytes(uint8_t *dst, const uint8_t *src, uint32_t len);
+
+/*!
+ * \brief reverse bits order and shift stream by one bit:
+ *        dst[i] = reverse(src[i] >> 1) | (src[i+1] & 0x01). Used to
+ *        realign SPI over JTAG read back (one bit delay)
+ * \param[out] dst: destination buffer (len bytes, not overlapping src)
+ * \param[in] src: source buffer (len + 1 bytes)
+ * \param[in] len: number of bytes to produce
+ */
+void bit_reverse_shift1(uint8_t *dst, const uint8_t *src, uint32_t len);
+
+#endif  // SRC_BITOPS_HPP_
@@ -21,7 +21,7 @@
 using namespace std;
 
 #define display(...) \
-	do { if (_verbose) fprintf(stdout, __VA_ARGS__);} while(0)
+	do { if (_verbose) printfInfo(__VA_ARGS__);} while(0)
 
 BitParser::BitParser(const string &filename, bool reverseOrder, bool verbose):
 	ConfigBitstreamParser(filename, ConfigBitstreamParser::BIN_MODE,
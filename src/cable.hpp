@@ -28,6 +28,7 @@ enum communication_type {
 	MODE_JETSONNANO_BITBANG, /*! Bitbang gpio pins */
 	MODE_REMOTEBITBANG,    /*! Remote Bitbang mode */
 	MODE_CH347,            /*! CH347 JTAG mode */
+	MODE_VIRTUAL,          /*! TAP simulator */
 };
 
 /*!
@@ -129,6 +130,9 @@ static std::map <std::string, cable_t> cable_list = {
 #ifdef ENABLE_REMOTEBITBANG
 	{"remote-bitbang",     CABLE_DEF(MODE_REMOTEBITBANG, 0x0000, 0x0000                )},
 #endif
+#ifdef ENABLE_VIRTUAL_JTAG
+	{"virtual",            CABLE_DEF(MODE_VIRTUAL, 0x0000, 0x0000                      )},
+#endif
 };
 
 #endif  // SRC_CABLE_HPP_
@@ -18,6 +18,7 @@
 
 #include "ch347jtag.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -49,13 +50,14 @@ static void LIBUSB_CALL sync_cb(struct libusb_transfer *transfer) {
 }
 
 int CH347Jtag::usb_xfer(unsigned wlen, unsigned rlen, unsigned *ract) {
+	uint64_t t = stats_start();
 	wcomplete = 0;
 	if (_verbose) {
-		fprintf(stderr, "obuf[%d] = {", wlen);
+		printfError("obuf[%d] = {", wlen);
 		for (unsigned i = 0; i < wlen; ++i) {
-			fprintf(stderr, "%02x ", obuf[i]);
+			printfError("%02x ", obuf[i]);
 		}
-		fprintf(stderr, "}\n\n");
+		printfError("}\n\n");
 	}
 	libusb_fill_bulk_transfer(wtrans, dev_handle, CH347JTAG_WRITE_EP, obuf,
 		wlen, sync_cb, &wcomplete, CH347JTAG_TIMEOUT);
@@ -86,6 +88,8 @@ int CH347Jtag::usb_xfer(unsigned wlen, unsigned rlen, unsigned *ract) {
 			wcomplete = 1;
 		}
 	}
+	stats_xfer_out(wtrans->actual_length, t);
+	t = stats_start();
 	unsigned rdone = 0;
 wait_rcompletion:
 	while (!rcomplete) {
@@ -118,13 +122,14 @@ wait_rcompletion:
 				return r;
 			goto wait_rcompletion;
 		}
+		stats_xfer_in(rdone, t);
 		if (ract) *ract = rdone;
 		if (_verbose) {
-			fprintf(stderr, "ibuf[%d] = {", rdone);
+			printfError("ibuf[%d] = {", rdone);
 			for (unsigned i = 0; i < rdone; ++i) {
-				fprintf(stderr, "%02x ", ibuf[i]);
+				printfError("%02x ", ibuf[i]);
 			}
-			fprintf(stderr, "}\n\n");
+			printfError("}\n\n");
 		}
 	}
 	return 0;
@@ -191,7 +196,7 @@ CH347Jtag::CH347Jtag(uint32_t clkHZ, int8_t verbose):
 		printError("libusb failed to alloc transfers");
 		goto usb_release;
 	}
-	libusb_bulk_transfer(dev_handle, CH347JTAG_READ_EP, ibuf, 512,
+	stats_libusb_bulk_transfer(dev_handle, CH347JTAG_READ_EP, ibuf, 512,
 		&actual_length, CH347JTAG_TIMEOUT);
 	setClkFreq(clkHZ);
 	return;
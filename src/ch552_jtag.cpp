@@ -23,7 +23,7 @@ using namespace std;
 #ifdef DEBUG
 #define display(...) \
 	do { \
-		if (_verbose) fprintf(stdout, __VA_ARGS__); \
+		if (_verbose) printfInfo(__VA_ARGS__); \
 	}while(0)
 #else
 #define display(...) do {}while(0)
@@ -56,8 +56,7 @@ CH552_jtag::~CH552_jtag()
 	mpsse_store(tbuf, 16);
 	read = mpsse_read(tbuf, 5);
 	if (read != 5)
-		fprintf(stderr,
-			"Loopback failed, expect problems on later runs %d\n", read);
+		printfError("Loopback failed, expect problems on later runs %d\n", read);
 }
 
 void CH552_jtag::init_internal(const mpsse_bit_config &cable)
@@ -69,6 +68,11 @@ void CH552_jtag::init_internal(const mpsse_bit_config &cable)
 	display("%x\n", cable.bit_high_val);
 	display("%x\n", cable.bit_high_dir);
 
+	/* MPSSE emulation: always use full init sequence and
+	 * blocking writes
+	 */
+	_fast_attach = false;
+	_async_write = false;
 	init(5, 0xfb, BITMODE_MPSSE);
 	ftdi_set_event_char(_ftdi, 0, 0);
 	ftdi_set_error_char(_ftdi, 0, 0);
@@ -213,7 +217,7 @@ int CH552_jtag::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 			printError("writeTDI: fails to flush write");
 
 	if ((nb_byte * 8) + nb_bit != real_len) {
-		printf("pas cool\n");
+		printfInfo("pas cool\n");
 		throw std::exception();
 	}
 
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "display.hpp"
+#include "transportStats.hpp"
 
 #include "cmsisDAP.hpp"
 
@@ -215,7 +216,7 @@ CmsisDAP::CmsisDAP(const cable_t &cable, int index, int8_t verbose):_verbose(ver
 	}
 
 	if (verbose)
-		printf("Hardware cap %02x %02x %02x\n", _buffer[0], _buffer[1], _buffer[2]);
+		printfInfo("Hardware cap %02x %02x %02x\n", _buffer[0], _buffer[1], _buffer[2]);
 	if (!(_buffer[2] & (1 << 1))) {
 		hid_close(_dev);
 		hid_exit();
@@ -508,13 +509,17 @@ int CmsisDAP::xfer(uint8_t instruction, int tx_len,
 	_ll_buffer[0] = 0;
 	_ll_buffer[1] = instruction;
 
+	uint64_t t = stats_start();
 	int ret = hid_write(_dev, _ll_buffer, 65);
+	stats_xfer_out((ret < 0) ? 0 : ret, t);
 	if (ret == -1) {
-		printf("Error\n");
+		printfInfo("Error\n");
 		return ret;
 	}
 
+	t = stats_start();
 	ret = hid_read_timeout(_dev, _ll_buffer, 65, 1000);
+	stats_xfer_in((ret < 0) ? 0 : ret, t);
 	if (ret <= 0) {
 		if (ret == 0)
 			printError("Error timeout\n");
@@ -523,7 +528,7 @@ int CmsisDAP::xfer(uint8_t instruction, int tx_len,
 		return ret;
 	}
 	if (_ll_buffer[0] != instruction && _ll_buffer[1] != DAP_OK) {
-		printf("Error: command error");
+		printfInfo("Error: command error");
 		return -1;
 	}
 
@@ -544,18 +549,22 @@ int CmsisDAP::xfer(int tx_len, uint8_t *rx_buff, int rx_len)
 
 	_ll_buffer[0] = 0;
 
+	uint64_t t = stats_start();
 	int ret = hid_write(_dev, _ll_buffer, 65);
+	stats_xfer_out((ret < 0) ? 0 : ret, t);
 	if (ret == -1) {
-		printf("Error\n");
+		printfInfo("Error\n");
 		return ret;
 	}
 
+	t = stats_start();
 	ret = hid_read_timeout(_dev, _ll_buffer, 65, 1000);
+	stats_xfer_in((ret < 0) ? 0 : ret, t);
 	if (ret <= 0) {
 		if (ret == 0)
-			printf("Error timeout\n");
+			printfInfo("Error timeout\n");
 		else if (ret == -1)
-			printf("Error comm\n");
+			printfInfo("Error comm\n");
 		return ret;
 	}
 	if (rx_len)
@@ -582,7 +591,7 @@ void CmsisDAP::display_info(uint8_t info, uint8_t type)
 	memset(buffer, 0, 65);
 	int ret = read_info(info, buffer, 64);
 	if (ret < 0) {
-		printf("received error %d for command %d\n", ret, info);
+		printfInfo("received error %d for command %d\n", ret, info);
 		return;
 	}
 
@@ -619,37 +628,37 @@ void CmsisDAP::display_info(uint8_t info, uint8_t type)
 	bool fail = true;
 
 	if (type == DAPLINK_INFO_BYTE && ret != 1) {
-		printf("Error: Waiting for 1Byte received %d\n", ret);
+		printfInfo("Error: Waiting for 1Byte received %d\n", ret);
 	} else if (type == DAPLINK_INFO_SHORT && ret != 2) {
-		printf("Error: Waiting for 2Byte received %d\n", ret);
+		printfInfo("Error: Waiting for 2Byte received %d\n", ret);
 	} else if (type == DAPLINK_INFO_WORD && ret != 4) {
-		printf("Error: Waiting for 2Byte received %d\n", ret);
+		printfInfo("Error: Waiting for 2Byte received %d\n", ret);
 	} else {
 		fail = false;
 	}
 
 	if (fail == true) {
 		for (int i = 0; i < 64; i++) {
-			printf("%02x ", buffer[i]);
+			printfInfo("%02x ", buffer[i]);
 		}
-		printf("\n");
+		printfInfo("\n");
 		return;
 	}
 
 	printInfo("\t" + cmsisdap_info_id_str[info] + " : ", false);
 
 	if (type == DAPLINK_INFO_BYTE) {
-		printf("%02x\n", buffer[2]);
+		printfInfo("%02x\n", buffer[2]);
 	} else if (type == DAPLINK_INFO_SHORT) {
 		uint16_t val = (buffer[3] << 8) | buffer[2];
-		printf("%d\n", val);
+		printfInfo("%d\n", val);
 	} else if (type == DAPLINK_INFO_WORD) {
 		uint32_t val = (buffer[5] << 24) | (buffer[4] << 16) |
 						(buffer[3] << 8) | buffer[2];
-		printf("%u\n", val);
+		printfInfo("%u\n", val);
 	} else {
 		char val[ret];
 		memcpy(val, &buffer[2], ret);
-		printf("%s\n", val);
+		printfInfo("%s\n", val);
 	}
 }
@@ -52,8 +52,8 @@ CologneChip::CologneChip(Jtag* jtag, const std::string &filename,
 	_fail_pin = DBUS6;
 	_oen_pin   = spi_board->oe_pin;
 
-	/* cast _jtag->_jtag from JtagInterface to FtdiJtagMPSSE to access GPIO */
-	_ftdi_jtag = reinterpret_cast<FtdiJtagMPSSE *>(_jtag->_jtag);
+	/* cast converter from JtagInterface to FtdiJtagMPSSE to access GPIO */
+	_ftdi_jtag = reinterpret_cast<FtdiJtagMPSSE *>(_jtag->get_ll_class());
 
 	_ftdi_jtag->gpio_set_input(_done_pin | _fail_pin);
 	_ftdi_jtag->gpio_set_output(_rstn_pin | _oen_pin);
@@ -103,14 +103,11 @@ bool CologneChip::cfgDone()
  */
 void CologneChip::waitCfgDone()
 {
-	uint32_t timeout = 1000;
+	FTDIpp_MPSSE *ftdi = (_spi) ? static_cast<FTDIpp_MPSSE *>(_spi) :
+		static_cast<FTDIpp_MPSSE *>(_ftdi_jtag);
 
 	printInfo("Wait for CFG_DONE ", false);
-	do {
-		timeout--;
-		usleep(SLEEP_US);
-	} while (!cfgDone() && timeout > 0);
-	if (timeout == 0) {
+	if (!ftdi->gpio_wait(_done_pin, true, SLEEP_US, 1000) || !cfgDone()) {
 		printError("FAIL");
 	} else {
 		printSuccess("DONE");
@@ -246,7 +243,7 @@ void CologneChip::programSPI_flash(unsigned int offset, uint8_t *data,
 	flash.reset();
 	flash.power_up();
 
-	printf("%02x\n", flash.read_status_reg());
+	printfInfo("%02x\n", flash.read_status_reg());
 	flash.read_id();
 	flash.erase_and_prog(offset, data, length);
 
@@ -313,7 +310,7 @@ void CologneChip::programJTAG_flash(unsigned int offset, uint8_t *data,
 	flash.reset();
 	flash.power_up();
 
-	printf("%02x\n", flash.read_status_reg());
+	printfInfo("%02x\n", flash.read_status_reg());
 	flash.read_id();
 	flash.erase_and_prog(offset, data, length);
 
@@ -410,17 +407,17 @@ int CologneChip::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 
 		count++;
 		if (count == timeout) {
-			printf("timeout: %x %u\n", tmp, count);
+			printfInfo("timeout: %x %u\n", tmp, count);
 			break;
 		}
 
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		}
 	} while ((tmp & mask) != cond);
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
 	if (count == timeout) {
-		printf("%x\n", tmp);
+		printfInfo("%x\n", tmp);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	} else {
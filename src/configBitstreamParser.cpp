@@ -4,8 +4,11 @@
  */
 
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <stdint.h>
 #include <strings.h>
 #include <unistd.h>
@@ -28,6 +31,18 @@
 
 using namespace std;
 
+/* files content shared between parsers: filename -> (real filename, data) */
+static bool file_cache_enabled = false;
+static std::mutex file_cache_mutex;
+static std::map<string, std::pair<string, string>> file_cache;
+
+void ConfigBitstreamParser::setFileCache(bool enable)
+{
+	std::lock_guard<std::mutex> lock(file_cache_mutex);
+	file_cache_enabled = enable;
+	file_cache.clear();
+}
+
 ConfigBitstreamParser::ConfigBitstreamParser(const string &filename, int mode,
 			bool verbose): _filename(filename), _bit_length(0),
 			_file_size(0), _verbose(verbose),
@@ -35,6 +50,21 @@ ConfigBitstreamParser::ConfigBitstreamParser(const string &filename, int mode,
 {
 	(void) mode;
 	if (!filename.empty()) {
+		/* held until file is read: other parsers wait for the data */
+		std::unique_lock<std::mutex> lock(file_cache_mutex);
+		if (!file_cache_enabled) {
+			lock.unlock();
+		} else {
+			auto cached = file_cache.find(filename);
+			if (cached != file_cache.end()) {
+				_filename = cached->second.first;
+				_raw_data = cached->second.second;
+				_file_size = _raw_data.size();
+				_bit_data.reserve(_file_size);
+				return;
+			}
+		}
+
 		size_t offset =  filename.find_last_of(".");
 
 		FILE *_fd = fopen(filename.c_str(), "rb");
@@ -75,6 +105,8 @@ ConfigBitstreamParser::ConfigBitstreamParser(const string &filename, int mode,
 		}
 		_bit_data.reserve(_file_size);
 
+		if (lock.owns_lock())
+			file_cache[filename] = std::make_pair(_filename, _raw_data);
 	} else if (!isatty(fileno(stdin))) {
 		_file_size = 0;
 		string tmp;
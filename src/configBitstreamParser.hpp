@@ -47,6 +47,14 @@ class ConfigBitstreamParser {
 
 		static uint8_t reverseByte(uint8_t src);
 
+		/**
+		 * \brief keep files content (after decompression) in memory:
+		 *        a file used by many parsers (multi-cable mode) is read
+		 *        only once. Thread safe
+		 * \param[in] enable: enable/disable (and clear) cache
+		 */
+		static void setFileCache(bool enable);
+
 	private:
 		/**
 		 * \brief decompress bitstream in gzip format
@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "daemonSocket.hpp"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "display.hpp"
+
+#define DAEMON_MAGIC         0x444c464f  /* "OFLD" */
+#define DAEMON_FD_BITSTREAM  (1 << 0)
+#define DAEMON_FD_SECONDARY  (1 << 1)
+#define DAEMON_MAX_FDS       4
+#define DAEMON_MAX_ARGS_LEN  65536
+#define DAEMON_RECV_TIMEOUT  5  /* seconds: idle client can't block daemon */
+
+/* first message: header with fds, followed by args ('\0' separated) */
+typedef struct {
+	uint32_t magic;
+	uint32_t flags;     /* which optional fds are attached */
+	uint32_t args_len;
+} daemon_hdr_t;
+
+static bool fill_addr(const std::string &path, struct sockaddr_un *addr)
+{
+	if (path.size() >= sizeof(addr->sun_path)) {
+		printError("daemon: socket path too long: " + path);
+		return false;
+	}
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	strncpy(addr->sun_path, path.c_str(), sizeof(addr->sun_path) - 1);
+	return true;
+}
+
+static bool write_all(int sock, const void *buf, size_t len)
+{
+	const uint8_t *ptr = static_cast<const uint8_t *>(buf);
+	while (len > 0) {
+		ssize_t ret = write(sock, ptr, len);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+		ptr += ret;
+		len -= ret;
+	}
+	return true;
+}
+
+static bool read_all(int sock, void *buf, size_t len)
+{
+	uint8_t *ptr = static_cast<uint8_t *>(buf);
+	while (len > 0) {
+		ssize_t ret = read(sock, ptr, len);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+		ptr += ret;
+		len -= ret;
+	}
+	return true;
+}
+
+int daemon_listen(const std::string &path)
+{
+	struct sockaddr_un addr;
+	if (!fill_addr(path, &addr))
+		return -1;
+
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		printError("daemon: socket creation failed");
+		return -1;
+	}
+
+	unlink(path.c_str());
+	if (::bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			listen(sock, 4) < 0) {
+		printError("daemon: can't listen on " + path + ": " +
+			strerror(errno));
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+int daemon_accept(int sock)
+{
+	return accept(sock, NULL, NULL);
+}
+
+bool daemon_recv_job(int client, daemon_job_t *job)
+{
+	daemon_hdr_t hdr = {0, 0, 0};
+	int fds[DAEMON_MAX_FDS];
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = {&hdr, sizeof(hdr)};
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+
+	job->args.clear();
+	job->out_fd = job->err_fd = job->bit_fd = job->secondary_fd = -1;
+
+	struct timeval tv = {DAEMON_RECV_TIMEOUT, 0};
+	if (setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0)
+		return false;
+
+	ssize_t ret = recvmsg(client, &msg, 0);
+	if (ret < 0)
+		return false;
+
+	/* collect fds first: they must be closed even if job is invalid */
+	int nb_fds = 0;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+			cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+		int nb = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		int *data = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+		for (int i = 0; i < nb; i++) {
+			if (nb_fds < DAEMON_MAX_FDS)
+				fds[nb_fds++] = data[i];
+			else
+				close(data[i]);
+		}
+	}
+	int expected = 2 + ((hdr.flags & DAEMON_FD_BITSTREAM) ? 1 : 0) +
+		((hdr.flags & DAEMON_FD_SECONDARY) ? 1 : 0);
+	if (ret != sizeof(hdr) || (msg.msg_flags & MSG_CTRUNC) ||
+			hdr.magic != DAEMON_MAGIC || nb_fds != expected ||
+			hdr.args_len > DAEMON_MAX_ARGS_LEN) {
+		for (int i = 0; i < nb_fds; i++)
+			close(fds[i]);
+		printError("daemon: invalid job");
+		return false;
+	}
+
+	int pos = 0;
+	job->out_fd = fds[pos++];
+	job->err_fd = fds[pos++];
+	if (hdr.flags & DAEMON_FD_BITSTREAM)
+		job->bit_fd = fds[pos++];
+	if (hdr.flags & DAEMON_FD_SECONDARY)
+		job->secondary_fd = fds[pos++];
+
+	std::vector<char> args(hdr.args_len);
+	if (!read_all(client, args.data(), args.size())) {
+		daemon_close_job(job);
+		return false;
+	}
+	size_t start = 0;
+	for (size_t i = 0; i < args.size(); i++) {
+		if (args[i] == '\0') {
+			job->args.push_back(std::string(&args[start], i - start));
+			start = i + 1;
+		}
+	}
+	return true;
+}
+
+bool daemon_send_result(int client, int32_t ret)
+{
+	return write_all(client, &ret, sizeof(ret));
+}
+
+void daemon_close_job(daemon_job_t *job)
+{
+	int *fds[] = {&job->out_fd, &job->err_fd, &job->bit_fd,
+		&job->secondary_fd};
+	for (int *fd : fds) {
+		if (*fd >= 0)
+			close(*fd);
+		*fd = -1;
+	}
+}
+
+int daemon_connect(const std::string &path)
+{
+	struct sockaddr_un addr;
+	if (!fill_addr(path, &addr))
+		return -1;
+
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		printError("daemon: socket creation failed");
+		return -1;
+	}
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printError("daemon: can't connect to " + path + ": " +
+			strerror(errno));
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+bool daemon_send_job(int sock, const daemon_job_t &job)
+{
+	std::string args;
+	for (const std::string &arg : job.args) {
+		args += arg;
+		args += '\0';
+	}
+
+	daemon_hdr_t hdr = {DAEMON_MAGIC, 0, (uint32_t)args.size()};
+	int fds[DAEMON_MAX_FDS];
+	int nb_fds = 0;
+	fds[nb_fds++] = job.out_fd;
+	fds[nb_fds++] = job.err_fd;
+	if (job.bit_fd >= 0) {
+		hdr.flags |= DAEMON_FD_BITSTREAM;
+		fds[nb_fds++] = job.bit_fd;
+	}
+	if (job.secondary_fd >= 0) {
+		hdr.flags |= DAEMON_FD_SECONDARY;
+		fds[nb_fds++] = job.secondary_fd;
+	}
+
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = {&hdr, sizeof(hdr)};
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	memset(cbuf, 0, sizeof(cbuf));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = CMSG_SPACE(nb_fds * sizeof(int));
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(nb_fds * sizeof(int));
+	memcpy(CMSG_DATA(cmsg), fds, nb_fds * sizeof(int));
+
+	if (sendmsg(sock, &msg, 0) != sizeof(hdr))
+		return false;
+	return write_all(sock, args.data(), args.size());
+}
+
+bool daemon_recv_result(int sock, int32_t *ret)
+{
+	return read_all(sock, ret, sizeof(*ret));
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_DAEMONSOCKET_HPP_
+#define SRC_DAEMONSOCKET_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \file daemonSocket.hpp
+ * \brief UNIX socket transport for daemon mode. A job is the client
+ *        command line with its file descriptors (stdout, stderr and
+ *        bitstream files passed with SCM_RIGHTS), the answer is the
+ *        job return code
+ */
+
+typedef struct {
+	std::vector<std::string> args; /*!< command line (without argv[0]) */
+	int out_fd;                    /*!< client stdout */
+	int err_fd;                    /*!< client stderr */
+	int bit_fd;                    /*!< bitstream (-1: none) */
+	int secondary_fd;              /*!< secondary bitstream (-1: none) */
+} daemon_job_t;
+
+/*!
+ * \brief create socket and wait for connections (stale socket file
+ *        is removed)
+ * \param[in] path: socket file
+ * \return socket or -1
+ */
+int daemon_listen(const std::string &path);
+
+/*!
+ * \brief wait for a client
+ * \param[in] sock: daemon_listen() socket
+ * \return client socket or -1 (interrupted by a signal)
+ */
+int daemon_accept(int sock);
+
+/*!
+ * \brief receive a job
+ * \param[in] client: client socket
+ * \param[out] job: command line and file descriptors (owned by caller)
+ * \return false when message is invalid
+ */
+bool daemon_recv_job(int client, daemon_job_t *job);
+
+/*!
+ * \brief send job return code to client
+ */
+bool daemon_send_result(int client, int32_t ret);
+
+/*!
+ * \brief close file descriptors received with a job
+ */
+void daemon_close_job(daemon_job_t *job);
+
+/*!
+ * \brief connect to a daemon
+ * \param[in] path: socket file
+ * \return socket or -1
+ */
+int daemon_connect(const std::string &path);
+
+/*!
+ * \brief send a job (file descriptors are duplicated by the kernel)
+ */
+bool daemon_send_job(int sock, const daemon_job_t &job);
+
+/*!
+ * \brief wait for end of job
+ * \param[out] ret: job return code
+ * \return false if connection is lost
+ */
+bool daemon_recv_result(int sock, int32_t *ret);
+
+#endif  // SRC_DAEMONSOCKET_HPP_
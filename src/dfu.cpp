@@ -150,7 +150,7 @@ DFU::DFU(const string &filename, bool bypass_bitstream,
 		throw std::runtime_error("Fail to claim device");
 	}
 
-	printf("%02x %02x\n", _vid, _pid);
+	printfInfo("%02x %02x\n", _vid, _pid);
 
 	if (_verbose > 0) {
 		if ((ret = get_status(&status)) < 0) {
@@ -311,7 +311,7 @@ int DFU::searchDFUDevices()
 		}
 
 		if (_verbose > 0) {
-			printf("%04x:%04x (bus %d, device %2d)\n",
+			printfInfo("%04x:%04x (bus %d, device %2d)\n",
             	desc.idVendor, desc.idProduct,
             	libusb_get_bus_number(usb_dev),
 				libusb_get_device_address(usb_dev));
@@ -621,51 +621,51 @@ int DFU::poll_state(uint8_t state) {
 void DFU::displayDFU()
 {
 	/* display dfu device */
-	printf("Found DFU:\n");
+	printfInfo("Found DFU:\n");
 	for (unsigned int i = 0; i < dfu_dev.size(); i++) {
-		printf("%04x:%04x (bus %d, device %2d),",
+		printfInfo("%04x:%04x (bus %d, device %2d),",
             dfu_dev[i].vid, dfu_dev[i].pid,
             dfu_dev[i].bus, dfu_dev[i].device);
-		printf(" path: %d",dfu_dev[i].path[0]);
+		printfInfo(" path: %d",dfu_dev[i].path[0]);
 		for (size_t j = 1; j < strlen(((const char *)dfu_dev[i].path)); j++)
-			printf(".%d", dfu_dev[i].path[j]);
-		printf(", alt: %d, iProduct \"%s\", iInterface \"%s\"",
+			printfInfo(".%d", dfu_dev[i].path[j]);
+		printfInfo(", alt: %d, iProduct \"%s\", iInterface \"%s\"",
 				dfu_dev[i].altsettings,
 				dfu_dev[i].iProduct, dfu_dev[i].iInterface);
-		printf("\n");
-		printf("\tDFU details\n");
-		printf("\t\tbLength         %02x\n", dfu_dev[i].dfu_desc.bLength);
-		printf("\t\tbDescriptorType %02x\n",
+		printfInfo("\n");
+		printfInfo("\tDFU details\n");
+		printfInfo("\t\tbLength         %02x\n", dfu_dev[i].dfu_desc.bLength);
+		printfInfo("\t\tbDescriptorType %02x\n",
 				dfu_dev[i].dfu_desc.bDescriptorType);
-		printf("\t\tbmAttributes    %02x\n", dfu_dev[i].dfu_desc.bmAttributes);
-		printf("\t\twDetachTimeOut  %04x\n",
+		printfInfo("\t\tbmAttributes    %02x\n", dfu_dev[i].dfu_desc.bmAttributes);
+		printfInfo("\t\twDetachTimeOut  %04x\n",
 				dfu_dev[i].dfu_desc.wDetachTimeOut);
-		printf("\t\twTransferSize   %04d\n",
+		printfInfo("\t\twTransferSize   %04d\n",
 				libusb_le16_to_cpu(dfu_dev[i].dfu_desc.wTransferSize));
-		printf("\t\tbcdDFUVersion   %04x\n",
+		printfInfo("\t\tbcdDFUVersion   %04x\n",
 				libusb_le16_to_cpu(dfu_dev[i].dfu_desc.bcdDFUVersion));
 		uint8_t bmAttributes = dfu_dev[i].dfu_desc.bmAttributes;
-		printf("\tDFU attributes %02x\n", bmAttributes);
-		printf("\t\tDFU_DETACH            : ");
+		printfInfo("\tDFU attributes %02x\n", bmAttributes);
+		printfInfo("\t\tDFU_DETACH            : ");
 		if (bmAttributes & (1 << 3))
-			printf("ON\n");
+			printfInfo("ON\n");
 		else
-			printf("OFF\n");
-		printf("\t\tBitManifestionTolerant: ");
+			printfInfo("OFF\n");
+		printfInfo("\t\tBitManifestionTolerant: ");
 		if (bmAttributes & (1 << 2))
-			printf("ON\n");
+			printfInfo("ON\n");
 		else
-			printf("OFF\n");
-		printf("\t\tUPLOAD                : ");
+			printfInfo("OFF\n");
+		printfInfo("\t\tUPLOAD                : ");
 		if (bmAttributes & (1 << 1))
-			printf("ON\n");
+			printfInfo("ON\n");
 		else
-			printf("OFF\n");
-		printf("\t\tDOWNLOAD              : ");
+			printfInfo("OFF\n");
+		printfInfo("\t\tDOWNLOAD              : ");
 		if (bmAttributes & (1 << 0))
-			printf("ON\n");
+			printfInfo("ON\n");
 		else
-			printf("OFF\n");
+			printfInfo("OFF\n");
 	}
 }
 
@@ -738,7 +738,7 @@ int DFU::download()
 		ret = send(true, DFU_DNLOAD, transaction,
 				(xfer_len) ? ptr : NULL, xfer_len);
 		if (ret != xfer_len) {  // can't be wrong here
-			printf("Fails to send packet %s\n", libusb_error_name(ret));
+			printfInfo("Fails to send packet %s\n", libusb_error_name(ret));
 			ret_val = -4;
 			break;
 		}
@@ -749,7 +749,7 @@ int DFU::download()
 		ret_val = poll_state(STATE_dfuDNLOAD_IDLE);
 
 		if (ret_val != STATE_dfuDNLOAD_IDLE) {
-			printf("download: failed %d %d\n", ret_val, STATE_dfuDNLOAD_IDLE);
+			printfInfo("download: failed %d %d\n", ret_val, STATE_dfuDNLOAD_IDLE);
 			break;
 		}
 		progress.display(transaction);
@@ -785,8 +785,8 @@ int DFU::download()
 			 * is ret == 0
 			 */
 			if (ret < 0 && ret != LIBUSB_ERROR_NO_DEVICE) {
-				printf("Error: fail to get status %d\n", ret);
-				printf("%s\n", libusb_error_name(ret));
+				printfInfo("Error: fail to get status %d\n", ret);
+				printfInfo("%s\n", libusb_error_name(ret));
 				ret_val = ret;
 			}
 			break;
@@ -807,8 +807,8 @@ int DFU::download()
 				if (ret < 0) {
 					/* dfu device may be disconnected */
 					if (ret != LIBUSB_ERROR_NOT_FOUND) {
-						printf("%s\n", libusb_error_name(ret));
-						printf("ret %d\n", ret);
+						printfInfo("%s\n", libusb_error_name(ret));
+						printfInfo("ret %d\n", ret);
 						ret_val = -7;
 					}
 				}
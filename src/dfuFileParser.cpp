@@ -148,7 +148,7 @@ int DFUFileParser::parse()
 
 		if (crc != _dwCRC) {
 			printError("Error: CRC didn't match computed value");
-			printf("%08x instead of %08x\n", crc, _dwCRC);
+			printfInfo("%08x instead of %08x\n", crc, _dwCRC);
 			return EXIT_FAILURE;
 		}
 	}
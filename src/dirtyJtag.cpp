@@ -15,6 +15,7 @@
 
 #include "dirtyJtag.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -112,14 +113,14 @@ bool DirtyJtag::getVersion()
 	uint8_t buf[] = {CMD_INFO,
 					CMD_STOP};
 	uint8_t rx_buf[64];
-	ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+	ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 			        buf, 2, &actual_length, DIRTYJTAG_TIMEOUT);
 	if (ret < 0) {
 		cerr << "getVersion: usb bulk write failed " << ret << endl;
 		return false;
 	}
 	do {
-		ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
+		ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
 						rx_buf, 64, &actual_length, DIRTYJTAG_TIMEOUT);
 		if (ret < 0) {
 			cerr << "getVersion: read: usb bulk read failed " << ret << endl;
@@ -161,7 +162,7 @@ int DirtyJtag::setClkFreq(uint32_t clkHZ)
 					static_cast<uint8_t>(0xff & ((clkHZ / 1000) >> 8)),
 					static_cast<uint8_t>(0xff & ((clkHZ / 1000)     )),
 					CMD_STOP};
-	ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+	ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 			        buf, 4, &actual_length, DIRTYJTAG_TIMEOUT);
 	if (ret < 0) {
 		cerr << "setClkFreq: usb bulk write failed " << ret << endl;
@@ -200,7 +201,7 @@ int DirtyJtag::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 				buf[buffer_idx++] = val;
 			}
 			buf[buffer_idx++] = CMD_STOP;
-			int ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+			int ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 										   buf, buffer_idx, &actual_length,
 										   DIRTYJTAG_TIMEOUT);
 			if (ret < 0)
@@ -224,7 +225,7 @@ int DirtyJtag::toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len)
 	while (clk_len > 0) {
 		buf[2] = (clk_len > 64) ? 64 : (uint8_t)clk_len;
 
-		int ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+		int ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 				buf, 4, &actual_length, DIRTYJTAG_TIMEOUT);
 		if (ret < 0) {
 			cerr << "toggleClk: usb bulk write failed " << ret << endl;
@@ -285,7 +286,7 @@ int DirtyJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 				tx_buf[header_offset + (i >> 3)] |= (0x80 >> (i & 0x07));
 
 		actual_length = 0;
-		int ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+		int ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 		        (unsigned char *)tx_buf, (byte_to_send + header_offset),
 				&actual_length, DIRTYJTAG_TIMEOUT);
 		if ((ret < 0) || (actual_length != (int)(byte_to_send + header_offset))) {
@@ -298,7 +299,7 @@ int DirtyJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 		if (rx || (_version <= 1)) {
 			int transfer_length = (bit_to_send > 255) ? byte_to_send :32;
 			do {
-				ret = libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
+				ret = stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
 					rx_buf, transfer_length, &actual_length, DIRTYJTAG_TIMEOUT);
 				if (ret < 0) {
 					cerr << "writeTDI: read: usb bulk read failed " << ret << endl;
@@ -342,7 +343,7 @@ int DirtyJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 				CMD_GETSIG,  // <---Read instruction
 				CMD_STOP,
 			};
-			if (libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+			if (stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 									 buf, sizeof(buf), &actual_length,
 									 DIRTYJTAG_TIMEOUT) < 0)
 			{
@@ -351,7 +352,7 @@ int DirtyJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 			}
 			do
 			{
-				if (libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
+				if (stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_READ_EP,
 											&sig, 1, &actual_length,
 											DIRTYJTAG_TIMEOUT) < 0)
 				{
@@ -366,7 +367,7 @@ int DirtyJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
 			}
 			buf[2] &= ~SIG_TCK;
 			buf[3] = CMD_STOP;
-			if (libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
+			if (stats_libusb_bulk_transfer(dev_handle, DIRTYJTAG_WRITE_EP,
 									 buf, 4, &actual_length,
 									 DIRTYJTAG_TIMEOUT) < 0)
 			{
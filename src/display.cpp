@@ -3,9 +3,13 @@
  * Copyright (C) 2019 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
  */
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <unistd.h>
 
 #include <iostream>
+#include <mutex>
+#include <streambuf>
 #include <string>
 
 #include "display.hpp"
@@ -20,8 +24,106 @@
 #define KCYN  "\x1B[36m"
 #define KWHT  "\x1B[37m"
 
+/* per thread messages buffer (NULL: console) */
+static thread_local std::string *thread_log = NULL;
+
+/* std::cout/std::cerr buffer: characters written by a thread with a log
+ * are appended to it, others go to the original buffer
+ */
+class ThreadLogBuf : public std::streambuf {
+ public:
+	explicit ThreadLogBuf(std::streambuf *console): _console(console) {}
+
+ protected:
+	int overflow(int c) override
+	{
+		if (c == traits_type::eof())
+			return traits_type::not_eof(c);
+		if (thread_log) {
+			thread_log->push_back(static_cast<char>(c));
+			return c;
+		}
+		return _console->sputc(static_cast<char>(c));
+	}
+	std::streamsize xsputn(const char *s, std::streamsize n) override
+	{
+		if (thread_log) {
+			thread_log->append(s, n);
+			return n;
+		}
+		return _console->sputn(s, n);
+	}
+	int sync() override
+	{
+		return (thread_log) ? 0 : _console->pubsync();
+	}
+
+ private:
+	std::streambuf *_console;
+};
+
+void setThreadLog(std::string *log)
+{
+	static std::once_flag installed;
+	if (log) {
+		std::call_once(installed, [] {
+			static ThreadLogBuf out_buf(std::cout.rdbuf());
+			static ThreadLogBuf err_buf(std::cerr.rdbuf());
+			std::cout.rdbuf(&out_buf);
+			std::cerr.rdbuf(&err_buf);
+		});
+	}
+	thread_log = log;
+}
+
+static void vprint(FILE *fd, const char *fmt, va_list ap)
+{
+	if (!thread_log) {
+		vfprintf(fd, fmt, ap);
+		return;
+	}
+	va_list ap2;
+	va_copy(ap2, ap);
+	int len = vsnprintf(NULL, 0, fmt, ap2);
+	va_end(ap2);
+	if (len <= 0)
+		return;
+	std::string mess(len + 1, '\0');
+	vsnprintf(&mess[0], len + 1, fmt, ap);
+	mess.resize(len);
+	thread_log->append(mess);
+}
+
+void printfInfo(const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	vprint(stdout, fmt, ap);
+	va_end(ap);
+}
+
+void printfError(const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	vprint(stderr, fmt, ap);
+	va_end(ap);
+}
+
+static bool log_message(const std::string &mess, bool eol)
+{
+	if (!thread_log)
+		return false;
+	thread_log->append(mess);
+	if (eol)
+		thread_log->append("\n");
+	return true;
+}
+
 void printError(const std::string &err, bool eol)
 {
+	if (log_message(err, eol))
+		return;
 	if (isatty(STDERR_FILENO))
 		std::cerr << KRED << err << "\e[0m";
 	else
@@ -33,6 +135,8 @@ void printError(const std::string &err, bool eol)
 
 void printWarn(const std::string &warn, bool eol)
 {
+	if (log_message(warn, eol))
+		return;
 	if (isatty(STDOUT_FILENO))
 		std::cout << KYEL << warn << "\e[0m" << std::flush;
 	else
@@ -44,6 +148,8 @@ void printWarn(const std::string &warn, bool eol)
 
 void printInfo(const std::string &info, bool eol)
 {
+	if (log_message(info, eol))
+		return;
 	if (isatty(STDOUT_FILENO))
 		std::cout << KBLUL << info << "\e[0m" << std::flush;
 	else
@@ -55,6 +161,8 @@ void printInfo(const std::string &info, bool eol)
 
 void printSuccess(const std::string &success, bool eol)
 {
+	if (log_message(success, eol))
+		return;
 	if (isatty(STDOUT_FILENO))
 		std::cout << KGRN << success << "\e[0m" << std::flush;
 	else
@@ -14,4 +14,24 @@ void printWarn(const std::string &warn, bool eol = true);
 void printInfo(const std::string &info, bool eol = true);
 void printSuccess(const std::string &success, bool eol = true);
 
+/*!
+ * \brief printf replacement (no color, no end of line added): output
+ *        goes to the thread log when set, to stdout otherwise
+ */
+void printfInfo(const char *fmt, ...)
+	__attribute__((format(printf, 1, 2)));
+/*!
+ * \brief same as printfInfo for stderr
+ */
+void printfError(const char *fmt, ...)
+	__attribute__((format(printf, 1, 2)));
+
+/*!
+ * \brief redirect messages printed by the current thread to a buffer
+ *        (multi-cable mode: one log per target). Applies to display
+ *        functions and to std::cout/std::cerr
+ * \param[in] log: buffer, NULL to print on console
+ */
+void setThreadLog(std::string *log);
+
 #endif  // DISPLAY_HPP_
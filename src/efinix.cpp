@@ -11,9 +11,11 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "common.hpp"
 #include "device.hpp"
+#include "bitOps.hpp"
 #include "display.hpp"
 #include "efinixHexParser.hpp"
 #include "ftdiJtagMPSSE.hpp"
@@ -148,17 +150,12 @@ void Efinix::reset()
 		printError("jtag: reset not supported");
 		return;
 	}
-	uint32_t timeout = 1000;
 	_spi->gpio_clear(_rst_pin | _oe_pin);
 	usleep(1000);
 	_spi->gpio_set(_rst_pin | _oe_pin);
 
 	printInfo("Reset ", false);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -227,7 +224,6 @@ bool Efinix::dumpFlash(uint32_t base_addr, uint32_t len)
 		return false;
 	}
 
-	uint32_t timeout = 1000;
 	_spi->gpio_clear(_rst_pin);
 
 	/* prepare SPI access */
@@ -248,11 +244,7 @@ bool Efinix::dumpFlash(uint32_t base_addr, uint32_t len)
 	usleep(12000);
 
 	printInfo("Wait for CDONE ", false);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -270,7 +262,7 @@ void Efinix::programSPI(unsigned int offset, const uint8_t *data,
 	flash.reset();
 	flash.power_up();
 
-	printf("%02x\n", flash.read_status_reg());
+	printfInfo("%02x\n", flash.read_status_reg());
 	flash.read_id();
 	flash.erase_and_prog(offset, const_cast<uint8_t *>(data), length);
 
@@ -292,7 +284,9 @@ void Efinix::programSPI(unsigned int offset, const uint8_t *data,
 void Efinix::programJTAG(const uint8_t *data, const int length)
 {
 	int xfer_len = 512, tx_end;
-	uint8_t tx[512];
+	/* bitstream in wire order, reversed once */
+	std::vector<uint8_t> wire(length);
+	bit_reverse_bytes(wire.data(), data, length);
 
 	if (_fpga_family == TITANIUM_FAMILY)
 		_jtag->set_state(Jtag::RUN_TEST_IDLE);
@@ -328,10 +322,7 @@ void Efinix::programJTAG(const uint8_t *data, const int length)
 		} else {
 			tx_end = Jtag::SHIFT_DR;
 		}
-		for (int pos = 0; pos < xfer_len; pos++)
-			tx[pos] = EfinixHexParser::reverseByte(data[i+pos]);
-
-		_jtag->shiftDR(tx, NULL, xfer_len*8, tx_end);
+		_jtag->shiftDR(wire.data() + i, NULL, xfer_len*8, tx_end);
 		progress.display(i);
 	}
 
@@ -341,12 +332,12 @@ void Efinix::programJTAG(const uint8_t *data, const int length)
 
 	_jtag->shiftIR(ENTERUSER, _irlen, Jtag::EXIT1_IR);
 
-	memset(tx, 0, 512);
+	uint8_t tx[13] = {0};  // 100 bits
 	_jtag->shiftDR(tx, NULL, 100);
 	_jtag->shiftIR(IDCODE, _irlen);
 	uint8_t idc[4];
 	_jtag->shiftDR(NULL, idc, 4);
-	printf("%02x%02x%02x%02x\n",
+	printfInfo("%02x%02x%02x%02x\n",
 			idc[0], idc[1], idc[2], idc[3]);
 }
 
@@ -421,10 +412,8 @@ int Efinix::spi_put(uint8_t cmd,
 	uint8_t jtx[kXferLen];
 	jtx[0] = EfinixHexParser::reverseByte(cmd);
 	uint8_t jrx[kXferLen];
-	if (tx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i+1] = EfinixHexParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx + 1, tx, len);
 	/* addr BSCAN user1 */
 	_jtag->shiftIR(USER1, _irlen);
 	/* send first already stored cmd,
@@ -433,10 +422,8 @@ int Efinix::spi_put(uint8_t cmd,
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*kXferLen);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = EfinixHexParser::reverseByte(jrx[i+1] >> 1) | (jrx[i+2] & 0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx + 1, len);
 	return 0;
 }
 
@@ -445,10 +432,8 @@ int Efinix::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	int kXferLen = len + ((rx == NULL) ? 0 : 1);
 	uint8_t jtx[kXferLen];
 	uint8_t jrx[kXferLen];
-	if (tx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i] = EfinixHexParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx, tx, len);
 	/* addr BSCAN user1 */
 	_jtag->shiftIR(USER1, _irlen);
 	/* send first already stored cmd,
@@ -457,10 +442,8 @@ int Efinix::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*kXferLen);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = EfinixHexParser::reverseByte(jrx[i] >> 1) | (jrx[i+1] & 0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx, len);
 	return 0;
 }
 
@@ -479,18 +462,18 @@ int Efinix::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		tmp = (EfinixHexParser::reverseByte(rx[0] >> 1)) | (0x01 & rx[1]);
 		count++;
 		if (count == timeout){
-			printf("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
+			printfInfo("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
 			break;
 		}
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		}
 	} while ((tmp & mask) != cond);
 	_jtag->shiftDR(dummy, rx, 8*2, Jtag::EXIT1_DR);
 	_jtag->go_test_logic_reset();
 
 	if (count == timeout) {
-		printf("%x\n", tmp);
+		printfInfo("%x\n", tmp);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	}
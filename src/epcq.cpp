@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <strings.h>
 
+#include "display.hpp"
 #include "epcq.hpp"
 
 #define RD_STATUS_REG       0x05
@@ -53,18 +54,18 @@ void EPCQ::read_id()
 	_spi->spi_put(0x9F, NULL, rx_buf, 3);
 	_device_id = rx_buf[2];
 	if (_verbose)
-		printf("device id 0x%x attendu 0x15\n", _device_id);
+		printfInfo("device id 0x%x attendu 0x15\n", _device_id);
 	/* read EPCQ silicon id */
 	/* 3 dummy_byte + 1 byte*/
 	_spi->spi_put(0xAB, NULL, rx_buf, 4);
 	_silicon_id = rx_buf[3];
 	if (_verbose)
-		printf("silicon id 0x%x attendu 0x14\n", _silicon_id);
+		printfInfo("silicon id 0x%x attendu 0x14\n", _silicon_id);
 }
 
 void EPCQ::reset()
 {
-	printf("reset\n");
+	printfInfo("reset\n");
 	_spi->spi_put(0x66, NULL, NULL, 0);
 	_spi->spi_put(0x99, NULL, NULL, 0);
 }
@@ -247,7 +247,7 @@ int FsParser::parse()
 		_checksum += (uint16_t)bitToVal(&tmp[pos], 16);
 
 	if (_verbose)
-		printf("checksum 0x%04x\n", _checksum);
+		printfInfo("checksum 0x%04x\n", _checksum);
 
 	printSuccess("Done");
 
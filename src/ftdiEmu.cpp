@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+/* libftdi replacement (ENABLE_MPSSE_EMU): FTDI devices are software
+ * models (MpsseEmu), no USB access. Only functions used by
+ * openFPGALoader are provided.
+ */
+
+#include <ftdi.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <exception>
+
+#include "display.hpp"
+#include "mpsseEmu.hpp"
+
+/* ftdi_context must be the first member: ftdi_new() returns its
+ * address and others functions cast it back
+ */
+typedef struct {
+	struct ftdi_context ftdi;
+	MpsseEmu *emu;
+} ftdi_emu_t;
+
+static MpsseEmu *get_emu(struct ftdi_context *ftdi)
+{
+	return (ftdi) ? reinterpret_cast<ftdi_emu_t *>(ftdi)->emu : NULL;
+}
+
+static int emu_error(struct ftdi_context *ftdi, int code, const char *str)
+{
+	ftdi->error_str = str;
+	return code;
+}
+
+static int emu_open(struct ftdi_context *ftdi, int vendor, int product)
+{
+	ftdi_emu_t *ctx = reinterpret_cast<ftdi_emu_t *>(ftdi);
+	if (vendor != 0x0403)
+		return emu_error(ftdi, -3, "device not found");
+
+	switch (product) {
+	case 0x6001:
+		ftdi->type = TYPE_R;
+		break;
+	case 0x6011:
+		ftdi->type = TYPE_4232H;
+		break;
+	case 0x6014:
+		ftdi->type = TYPE_232H;
+		break;
+	default:
+		ftdi->type = TYPE_2232H;
+		break;
+	}
+	bool high_speed = (ftdi->type == TYPE_2232H ||
+		ftdi->type == TYPE_4232H || ftdi->type == TYPE_232H);
+
+	delete ctx->emu;
+	try {
+		ctx->emu = new MpsseEmu(high_speed);
+	} catch (std::exception &e) {
+		printError(e.what());
+		ctx->emu = NULL;
+		return emu_error(ftdi, -3, "device not found");
+	}
+	ftdi->max_packet_size = ctx->emu->max_packet_size();
+	ftdi->usb_dev = NULL;
+	return 0;
+}
+
+struct ftdi_context *ftdi_new(void)
+{
+	ftdi_emu_t *ctx = new ftdi_emu_t();
+	memset(&ctx->ftdi, 0, sizeof(ctx->ftdi));
+	ctx->emu = NULL;
+	ctx->ftdi.type = TYPE_BM;
+	ctx->ftdi.interface = 0;
+	ctx->ftdi.index = INTERFACE_A;
+	ctx->ftdi.max_packet_size = 64;
+	ctx->ftdi.readbuffer_chunksize = 4096;
+	ctx->ftdi.writebuffer_chunksize = 4096;
+	ctx->ftdi.module_detach_mode = AUTO_DETACH_SIO_MODULE;
+	return &ctx->ftdi;
+}
+
+void ftdi_free(struct ftdi_context *ftdi)
+{
+	if (!ftdi)
+		return;
+	ftdi_emu_t *ctx = reinterpret_cast<ftdi_emu_t *>(ftdi);
+	delete ctx->emu;
+	delete ctx;
+}
+
+const char *ftdi_get_error_string(struct ftdi_context *ftdi)
+{
+	return (ftdi && ftdi->error_str) ? ftdi->error_str : "";
+}
+
+int ftdi_set_interface(struct ftdi_context *ftdi,
+	enum ftdi_interface interface)
+{
+	ftdi->index = (interface == INTERFACE_ANY) ? INTERFACE_A : interface;
+	ftdi->interface = ftdi->index - INTERFACE_A;
+	return 0;
+}
+
+/* open / close */
+
+int ftdi_usb_open(struct ftdi_context *ftdi, int vendor, int product)
+{
+	return emu_open(ftdi, vendor, product);
+}
+
+int ftdi_usb_open_desc(struct ftdi_context *ftdi, int vendor, int product,
+	const char *description, const char *serial)
+{
+	(void)description;
+	(void)serial;
+	return emu_open(ftdi, vendor, product);
+}
+
+int ftdi_usb_open_desc_index(struct ftdi_context *ftdi, int vendor,
+	int product, const char *description, const char *serial,
+	unsigned int index)
+{
+	(void)description;
+	(void)serial;
+	if (index != 0)
+		return emu_error(ftdi, -3, "device not found");
+	return emu_open(ftdi, vendor, product);
+}
+
+int ftdi_usb_open_bus_addr(struct ftdi_context *ftdi, uint8_t bus,
+	uint8_t addr)
+{
+	(void)bus;
+	(void)addr;
+	return emu_open(ftdi, 0x0403, 0x6010);
+}
+
+int ftdi_usb_close(struct ftdi_context *ftdi)
+{
+	ftdi_emu_t *ctx = reinterpret_cast<ftdi_emu_t *>(ftdi);
+	delete ctx->emu;
+	ctx->emu = NULL;
+	return 0;
+}
+
+int ftdi_usb_reset(struct ftdi_context *ftdi)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -2, "USB device unavailable");
+	emu->purge_rx();
+	emu->purge_tx();
+	return 0;
+}
+
+/* buffers */
+
+int ftdi_usb_purge_rx_buffer(struct ftdi_context *ftdi)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -2, "USB device unavailable");
+	emu->purge_rx();
+	return 0;
+}
+
+int ftdi_usb_purge_tx_buffer(struct ftdi_context *ftdi)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -2, "USB device unavailable");
+	emu->purge_tx();
+	return 0;
+}
+
+int ftdi_usb_purge_buffers(struct ftdi_context *ftdi)
+{
+	int ret = ftdi_usb_purge_rx_buffer(ftdi);
+	if (ret < 0)
+		return ret;
+	return ftdi_usb_purge_tx_buffer(ftdi);
+}
+
+int ftdi_tciflush(struct ftdi_context *ftdi)
+{
+	return ftdi_usb_purge_rx_buffer(ftdi);
+}
+
+int ftdi_tcoflush(struct ftdi_context *ftdi)
+{
+	return ftdi_usb_purge_tx_buffer(ftdi);
+}
+
+int ftdi_tcioflush(struct ftdi_context *ftdi)
+{
+	return ftdi_usb_purge_buffers(ftdi);
+}
+
+int ftdi_read_data_set_chunksize(struct ftdi_context *ftdi,
+	unsigned int chunksize)
+{
+	ftdi->readbuffer_chunksize = chunksize;
+	return 0;
+}
+
+int ftdi_write_data_set_chunksize(struct ftdi_context *ftdi,
+	unsigned int chunksize)
+{
+	ftdi->writebuffer_chunksize = chunksize;
+	return 0;
+}
+
+/* configuration */
+
+int ftdi_set_baudrate(struct ftdi_context *ftdi, int baudrate)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -3, "USB device unavailable");
+	if (baudrate <= 0)
+		return emu_error(ftdi, -1, "Silly baudrate <= 0.");
+	emu->set_baudrate(baudrate);
+	ftdi->baudrate = baudrate;
+	return 0;
+}
+
+int ftdi_set_bitmode(struct ftdi_context *ftdi, unsigned char bitmask,
+	unsigned char mode)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -2, "USB device unavailable");
+	emu->set_bitmode(bitmask, mode);
+	ftdi->bitbang_mode = mode;
+	ftdi->bitbang_enabled = (mode == BITMODE_RESET) ? 0 : 1;
+	return 0;
+}
+
+int ftdi_set_latency_timer(struct ftdi_context *ftdi, unsigned char latency)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -3, "USB device unavailable");
+	if (latency < 1)
+		return emu_error(ftdi, -1, "latency out of range. Only valid for "
+			"1-255");
+	emu->set_latency(latency);
+	return 0;
+}
+
+int ftdi_set_event_char(struct ftdi_context *ftdi, unsigned char eventch,
+	unsigned char enable)
+{
+	(void)eventch;
+	(void)enable;
+	return (get_emu(ftdi)) ? 0 :
+		emu_error(ftdi, -2, "USB device unavailable");
+}
+
+int ftdi_set_error_char(struct ftdi_context *ftdi, unsigned char errorch,
+	unsigned char enable)
+{
+	(void)errorch;
+	(void)enable;
+	return (get_emu(ftdi)) ? 0 :
+		emu_error(ftdi, -2, "USB device unavailable");
+}
+
+/* data */
+
+int ftdi_write_data(struct ftdi_context *ftdi, const unsigned char *buf,
+	int size)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -666, "USB device unavailable");
+	return emu->write(buf, size);
+}
+
+int ftdi_read_data(struct ftdi_context *ftdi, unsigned char *buf, int size)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return emu_error(ftdi, -666, "USB device unavailable");
+	return emu->read(buf, size);
+}
+
+/* asynchronous writes are completed at submit time */
+struct ftdi_transfer_control *ftdi_write_data_submit(
+	struct ftdi_context *ftdi, unsigned char *buf, int size)
+{
+	MpsseEmu *emu = get_emu(ftdi);
+	if (!emu)
+		return NULL;
+	struct ftdi_transfer_control *tc =
+		(struct ftdi_transfer_control *)calloc(1, sizeof(*tc));
+	if (!tc)
+		return NULL;
+	tc->ftdi = ftdi;
+	tc->buf = buf;
+	tc->size = size;
+	tc->offset = emu->write(buf, size);
+	tc->completed = 1;
+	return tc;
+}
+
+int ftdi_transfer_data_done(struct ftdi_transfer_control *tc)
+{
+	int ret = tc->offset;
+	free(tc);
+	return ret;
+}
+
+void ftdi_transfer_data_cancel(struct ftdi_transfer_control *tc,
+	struct timeval *to)
+{
+	(void)to;
+	free(tc);
+}
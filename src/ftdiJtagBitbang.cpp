@@ -16,6 +16,7 @@
 #include "display.hpp"
 #include "ftdiJtagBitbang.hpp"
 #include "ftdipp_mpsse.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -24,7 +25,7 @@ using namespace std;
 #ifdef DEBUG
 #define display(...) \
 	do { \
-		if (_verbose) fprintf(stdout, __VA_ARGS__); \
+		if (_verbose) printfInfo(__VA_ARGS__); \
 	}while(0)
 #else
 #define display(...) do {}while(0)
@@ -43,7 +44,7 @@ FtdiJtagBitBang::FtdiJtagBitBang(const cable_t &cable,
 		pin_conf->tdi_pin, pin_conf->tdo_pin};
 	for (uint32_t i = 0; i < sizeof(pins) / sizeof(pins[0]); i++) {
 		if (pins[i] > FT232RL_RI || pins[i] < FT232RL_TXD) {
-			printf("%d\n", pins[i]);
+			printfInfo("%d\n", pins[i]);
 			printError("Invalid pin ID");
 			throw std::exception();
 		}
@@ -96,7 +97,7 @@ int FtdiJtagBitBang::setClkFreq(uint32_t clkHZ)
 	printInfo("Jtag frequency : requested " + std::to_string(user_clk) +
 			"Hz -> real " + std::to_string(clkHZ) + "Hz");
 	int ret = ftdi_set_baudrate(_ftdi, clkHZ);
-	printf("ret %d\n", ret);
+	printfInfo("ret %d\n", ret);
 	return ret;
 }
 
@@ -250,18 +251,24 @@ int FtdiJtagBitBang::write(uint8_t *tdo, int nb_bit)
 
 	setBitmode((tdo) ? BITMODE_SYNCBB : BITMODE_BITBANG);
 
+	uint64_t t = stats_start();
 	ret = ftdi_write_data(_ftdi, _buffer, _num);
 	if (ret != _num) {
-		printf("problem %d written\n", ret);
+		printfInfo("problem %d written\n", ret);
 		return ret;
 	}
+	stats_xfer_out(_num, t);
+	if (!isFull())
+		stats_forced_flush();
 
 	if (tdo) {
+			t = stats_start();
 		ret = ftdi_read_data(_ftdi, _buffer, _num);
 		if (ret != _num) {
-			printf("problem %d read\n", ret);
+			printfInfo("problem %d read\n", ret);
 			return ret;
 		}
+		stats_xfer_in(_num, t);
 		/* need to reconstruct received word 
 		 * even bit are discarded since JTAG read in rising edge
 		 * since jtag is LSB first we need to shift right content by 1
@@ -7,12 +7,14 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <vector>
 #include <stdexcept>
 #include <string>
 
+#include "bitOps.hpp"
 #include "display.hpp"
 #include "ftdiJtagMPSSE.hpp"
 #include "ftdipp_mpsse.hpp"
@@ -24,7 +26,7 @@ using namespace std;
 #ifdef DEBUG
 #define display(...) \
 	do { \
-		if (_verbose) fprintf(stdout, __VA_ARGS__); \
+		if (_verbose) printfInfo(__VA_ARGS__); \
 	}while(0)
 #else
 #define display(...) do {}while(0)
@@ -37,7 +39,7 @@ FtdiJtagMPSSE::FtdiJtagMPSSE(const cable_t &cable,
 			_write_mode(MPSSE_WRITE_NEG),  // always write on neg edge
 			_read_mode(0),
 			_invert_read_edge(invert_read_edge), // false: pos, true: neg
-			_tdo_pos(0)
+			_defer_read(false)
 {
 	init_internal(cable.config);
 }
@@ -61,8 +63,7 @@ FtdiJtagMPSSE::~FtdiJtagMPSSE()
 	mpsse_store(tbuf, 16);
 	read = mpsse_read(tbuf, 5);
 	if (read != 5)
-		fprintf(stderr,
-			"Loopback failed, expect problems on later runs %d\n", read);
+		printfError("Loopback failed, expect problems on later runs %d\n", read);
 }
 
 void FtdiJtagMPSSE::init_internal(const mpsse_bit_config &cable)
@@ -71,6 +72,11 @@ void FtdiJtagMPSSE::init_internal(const mpsse_bit_config &cable)
 
 	if (!strncmp((const char *)_iproduct, "Sipeed-Debug", 12)) {
 		_ch552WA = true;
+		/* CH552 MPSSE emulation: always use full init sequence
+		 * and blocking writes
+		 */
+		_fast_attach = false;
+		_async_write = false;
 	}
 
 	display("%x\n", cable.bit_low_val);
@@ -137,13 +143,13 @@ int FtdiJtagMPSSE::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 		if (pos == iter * 3) {
 			pos = 0;
 			if (mpsse_write() < 0)
-				printf("writeTMS: error\n");
+				printfInfo("writeTMS: error\n");
 
 			if (_ch552WA) {
 				uint8_t c[len/8+1];
 				int ret = ftdi_read_data(_ftdi, c, len/8+1);
 				if (ret != 0) {
-					printf("ret : %d\n", ret);
+					printfInfo("ret : %d\n", ret);
 				}
 			}
 		}
@@ -203,11 +209,78 @@ int FtdiJtagMPSSE::toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len)
 	return ret;
 }
 
+int FtdiJtagMPSSE::delay(uint8_t tms, uint64_t ns, uint32_t min_clocks)
+{
+	/* without clock only command host sleep is cheaper */
+	if (_ftdi->type != TYPE_2232H && _ftdi->type != TYPE_4232H &&
+				_ftdi->type != TYPE_232H)
+		return JtagInterface::delay(tms, ns, min_clocks);
+
+	/* 3 bytes for 512k cycles: duration is converted to cycles
+	 * to keep timing in the commands flow
+	 */
+	uint64_t clk = (ns * getClkFreq() + 999999999ULL) / 1000000000ULL;
+	if (clk < min_clocks)
+		clk = min_clocks;
+	while (clk > 0) {
+		uint32_t chunk = (clk > 0x10000000) ? 0x10000000 : (uint32_t)clk;
+		if (toggleClk(tms, 0, chunk) < 0)
+			return -1;
+		clk -= chunk;
+	}
+	return 0;
+}
+
 int FtdiJtagMPSSE::flush()
 {
 	return mpsse_write();
 }
 
+bool FtdiJtagMPSSE::setDeferredRead(bool enable)
+{
+	/* CH552 workaround requires a read after each write */
+	_defer_read = enable && !_ch552WA;
+	return _defer_read;
+}
+
+int FtdiJtagMPSSE::flushDeferred()
+{
+	if (mpsse_flush_read() < 0)
+		return -1;
+	return mpsse_write();
+}
+
+/* min constant (0x00/0xFF) bytes to use clock only command:
+ * 1 data byte + 3 bytes for clocks instead of n data bytes
+ */
+#define TDI_RUN_MIN 8
+
+/* number of bytes identical to buf[0] when constant (0x00/0xFF) */
+static int tdi_run_length(const uint8_t *buf, int len)
+{
+	if (buf[0] != 0x00 && buf[0] != 0xff)
+		return 0;
+	int i = 1;
+	while (i < len && buf[i] == buf[0])
+		i++;
+	return i;
+}
+
+/* number of bytes before the first constant run of at least min_run bytes */
+static int tdi_literal_length(const uint8_t *buf, int len, int min_run)
+{
+	int run = 0;
+	for (int i = 0; i < len; i++) {
+		if ((buf[i] == 0x00 || buf[i] == 0xff) && i > 0 && buf[i] == buf[i - 1])
+			run++;
+		else
+			run = (buf[i] == 0x00 || buf[i] == 0xff) ? 1 : 0;
+		if (run == min_run)
+			return i - min_run + 1;
+	}
+	return len;
+}
+
 int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 {
 	/* 3 possible case :
@@ -234,10 +307,10 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 		nb_bit);
 
 	if ((nb_byte + _num + 3) > _buffer_size)
-		mpsse_write();
+		mpsse_submit();
 
 	if ((nb_byte * 8) + nb_bit != real_len) {
-		printf("pas cool\n");
+		printfInfo("pas cool\n");
 		throw std::exception();
 	}
 
@@ -249,8 +322,35 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 		nb_bit = 8;
 	}
 
+	/* constant TDI without read: DO keeps last bit value between
+	 * commands so clock only commands may be used (only
+	 * 2232H, 4232H & 232H)
+	 */
+	bool clk_only = tdi && !tdo && !_ch552WA && (_ftdi->type == TYPE_2232H ||
+			_ftdi->type == TYPE_4232H || _ftdi->type == TYPE_232H);
+
+	/* reads are queued (several outstanding): without deferred mode
+	 * all are received before return (not with CH552 workaround)
+	 */
+	bool queue_read = tdo && !_ch552WA;
+
 	while (nb_byte != 0) {
 		int xfer_len = (nb_byte > xfer) ? xfer : nb_byte;
+		if (clk_only) {
+			int run = tdi_run_length(tx_ptr, nb_byte);
+			if (run >= TDI_RUN_MIN) {
+				/* first byte set TDI level */
+				tx_buf[1] = tx_buf[2] = 0;
+				mpsse_store(tx_buf, 3);
+				mpsse_store(tx_ptr, 1);
+				toggleClk(0, 0, (run - 1) * 8);
+				tx_ptr += run;
+				nb_byte -= run;
+				continue;
+			}
+			/* send bytes until next constant run */
+			xfer_len = tdi_literal_length(tx_ptr, xfer_len, TDI_RUN_MIN);
+		}
 		tx_buf[1] = (((xfer_len - 1)     ) & 0xff);  // low
 		tx_buf[2] = (((xfer_len - 1) >> 8) & 0xff);  // high
 		mpsse_store(tx_buf, 3);
@@ -259,14 +359,18 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 			tx_ptr += xfer_len;
 		}
 		if (tdo) {
-			mpsse_read(rx_ptr, xfer_len);
+			if (queue_read)
+				mpsse_queue_read(rx_ptr, xfer_len);
+			else
+				mpsse_read(rx_ptr, xfer_len);
 			rx_ptr += xfer_len;
 		} else if (_ch552WA) {
 			mpsse_write();
 			ftdi_read_data(_ftdi, c, xfer_len);
-		} else if (!last) {
-			mpsse_write();
 		}
+		/* otherwise keep commands in buffer: flushed when full
+		 * (asynchronously) or at next read/sync point
+		 */
 		nb_byte -= xfer_len;
 	}
 
@@ -284,14 +388,18 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 			mpsse_store(last_bit);
 		}
 		if (tdo && !last) {
-			mpsse_read(rx_ptr, 1);
 			double_write = false;
 			/* realign we have read nb_bit
 			 * since LSB add bit by the left and shift
 			 * we need to complete shift
 			 */
-			*rx_ptr >>= (8 - nb_bit);
-			display("%s %x\n", __func__, *rx_ptr);
+			if (queue_read) {
+				mpsse_queue_read(rx_ptr, 1, 0xff, 8 - nb_bit);
+			} else {
+				mpsse_read(rx_ptr, 1);
+				*rx_ptr >>= (8 - nb_bit);
+				display("%s %x\n", __func__, *rx_ptr);
+			}
 		} else if (_ch552WA) {
 			if (tdo) {
 				mpsse_read(rx_ptr, 1);
@@ -301,19 +409,9 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 				mpsse_write();
 				ftdi_read_data(_ftdi, c, nb_bit);
 			}
-		} else if (!last) {
-			mpsse_write();
 		}
 	}
 
-	/* display : must be dropped */
-	if (_verbose && tdo) {
-		display("\n");
-		for (int i = (len / 8) - 1; i >= 0; i--)
-			display("%x ", (unsigned char)tdo[i]);
-		display("\n");
-	}
-
 	if (last == 1) {
 		last_bit = (tdi)? (*tx_ptr & (1 << nb_bit)) : 0;
 
@@ -325,7 +423,12 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 		tx_buf[2] = ((last_bit) ? 0x81 : 0x01);  // we know in TMS tdi is bit 7
 							// and to move to EXIT_XR TMS = 1
 		mpsse_store(tx_buf, 3);
-		if (tdo) {
+		if (queue_read) {
+			if (double_write)
+				mpsse_queue_read(rx_ptr, 1, 0xff, 8 - nb_bit);
+			/* in this case for 1 one it's always bit 7 */
+			mpsse_queue_read(rx_ptr, 1, 0x80, 7 - nb_bit, true);
+		} else if (tdo) {
 			unsigned char c[2];
 			int index = 0;
 			mpsse_read(c, 1 + ((double_write)?1:0));
@@ -343,221 +446,188 @@ int FtdiJtagMPSSE::writeTDI(uint8_t *tdi, uint8_t *tdo, uint32_t len, bool last)
 		}
 	}
 
+	/* without deferred mode, caller expects tdo content */
+	if (queue_read && !_defer_read) {
+		if (mpsse_flush_read() < 0)
+			return -1;
+	}
+
+	/* display : must be dropped */
+	if (_verbose && tdo) {
+		display("\n");
+		for (int i = (len / 8) - 1; i >= 0; i--)
+			display("%x ", (unsigned char)tdo[i]);
+		display("\n");
+	}
+
 	return 0;
 }
 
-int32_t FtdiJtagMPSSE::update_tms_buff(uint8_t *buffer, uint8_t bit,
-		uint32_t offset, uint8_t tdi, uint8_t *tdo, bool end)
+/* writeTMSTDI compiler
+ * TMS/TDI streams are split into segments, each one converted to the
+ * MPSSE command best suited:
+ * - SHIFT: TMS constant and equal to current TMS pin level: TDI/TDO byte
+ *          shifts followed by a bit shift for the residual bits
+ * - TMS:   TMS transition: up to TMSTDI_TMS_MAX bits with a TMS command,
+ *          TDI must be constant (bit 7)
+ * All commands are stored in one stream with reads queued, TDO is
+ * demultiplexed at the end.
+ */
+#define TMSTDI_SHIFT   0
+#define TMSTDI_TMS     1
+#define TMSTDI_TMS_MAX 6
+
+typedef struct {
+	uint8_t type;
+	uint32_t pos;  /* first bit in TMS/TDI/TDO streams */
+	uint32_t len;  /* number of bits */
+} tmstdi_seg_t;
+
+static void tmstdi_compile(const uint8_t *tms, const uint8_t *tdi,
+		uint32_t len, uint8_t curr_tms, vector<tmstdi_seg_t> &segs)
 {
-	int32_t ret;
-	if (_verbose)
-		printf("%s %d %02x %d\n", __func__, offset, buffer[0], end);
-	if (!end) {
-		uint8_t bit_shift = (1 << (offset));
-		if (bit)
-			buffer[0] |= bit_shift;
-		else
-			buffer[0] &= ~bit_shift;
-		offset++;
-	}
-	if (offset == 6 || end) {
-		if (tdi)
-			buffer[0] |= (0x01 << 7);
-		else
-			buffer[0] &= ~(0x01 << 7);
-		uint8_t mp[3] = {
-			static_cast<unsigned char>(MPSSE_WRITE_TMS | MPSSE_LSB |
-										MPSSE_BITMODE | _write_mode |
-										MPSSE_DO_READ | _read_mode
-										),
-			static_cast<uint8_t>(offset - 1),
-			buffer[0]
-		};
-		// force a write
-		if (_verbose)
-			printf("\t%02x %02d %02x\n", mp[0], mp[1], mp[2]);
-		if ((ret = mpsse_store(mp, 3)) < 0)
-			return ret;
-		uint8_t tdo_tmp;
-		if ((ret = mpsse_read(&tdo_tmp, 1)) < 0)
-			return ret;
-		update_tdo_buff(&tdo_tmp, tdo, offset);
-		offset = 0;
-		buffer[0] = 0;
+	uint32_t pos = 0;
+	while (pos < len) {
+		uint8_t tms_bit = bit_get(tms, pos);
+		/* TMS unchanged: longest run with the same TMS value */
+		if (tms_bit == curr_tms) {
+			uint32_t run = bit_run_length(tms, pos, len - pos, tms_bit);
+			segs.push_back({TMSTDI_SHIFT, pos, run});
+			pos += run;
+			continue;
+		}
+
+		/* TMS transition: extend while TDI is constant but stop before
+		 * a run long enough to use a byte shift
+		 */
+		uint8_t tdi_bit = bit_get(tdi, pos);
+		uint32_t nb = 1;
+		while (nb < TMSTDI_TMS_MAX && pos + nb < len) {
+			uint32_t i = pos + nb;
+			uint8_t bit = bit_get(tms, i);
+			if (bit_get(tdi, i) != tdi_bit)
+				break;
+			if (bit == bit_get(tms, i - 1) &&
+					bit_run_length(tms, i, min(len - i, 8u), bit) == 8)
+				break;
+			nb++;
+		}
+		segs.push_back({TMSTDI_TMS, pos, nb});
+		curr_tms = bit_get(tms, pos + nb - 1);
+		pos += nb;
 	}
-	return offset;
 }
 
-uint32_t FtdiJtagMPSSE::update_tdo_buff(uint8_t *buffer, uint8_t *tdo, uint32_t len)
+int FtdiJtagMPSSE::tmstdi_read(uint8_t *rx, int len)
 {
-	if (_verbose) {
-		printError("update tdo " + std::to_string(_tdo_pos) + " " + std::to_string(len) + " ", false);
-		uint32_t tt = (len + 7) / 8;
-		for (uint32_t i = 0; i < tt; i++)
-			printf("%02x ", buffer[i]);
-	}
-	for (uint32_t i = 0; i < len; i++, _tdo_pos++) {
-		uint8_t bit = (buffer[i >> 3] >> (i & 0x07)) & 0x01;
-		uint8_t mask = 1 << (_tdo_pos & 0x07);
-		if (bit)
-			tdo[_tdo_pos >> 3] |= mask;
-		else
-			tdo[_tdo_pos >> 3] &= ~mask;
-	}
-	if (_verbose)
-		printf("\n");
-	return _tdo_pos;
+	/* CH552 needs a read after each write */
+	if (_ch552WA)
+		return mpsse_read(rx, len);
+	return mpsse_queue_read(rx, len);
 }
 
 bool FtdiJtagMPSSE::writeTMSTDI(const uint8_t *tms, const uint8_t *tdi,
 		uint8_t *tdo, uint32_t len)
 {
-	int32_t ret;
-	uint32_t max_len = 1024;
-	uint8_t mode = 0;         // current state: 0 none, 1 TDI, 2 TMS
-	uint8_t tdi_buf[max_len]; // buffer to store TDI sequence
-	uint8_t tms_tmp = 0;      // buffer to store TMS sequence (limited to 6bits per cmd)
-	uint8_t tdo_tmp[max_len]; // local TDO sequence
-	uint32_t buff_len = 0;    // current bits stored
-	memset(tdi_buf, 0, max_len);
-	memset(tdo_tmp, 0, max_len);
-	_tdo_pos = 0; // current bits read
+	if (len == 0)
+		return true;
+
+	vector<tmstdi_seg_t> segs;
+	tmstdi_compile(tms, tdi, len, _curr_tms, segs);
+
+	/* TDO staging buffer: for each segment, bytes shifts followed by
+	 * one byte for residual bits (CH552: always read)
+	 */
+	bool do_read = tdo || _ch552WA;
+	uint32_t rx_len = 0;
+	for (const tmstdi_seg_t &seg : segs)
+		rx_len += (seg.len + 7) / 8;
+	vector<uint8_t> rx((do_read) ? rx_len : 0);
+	vector<uint8_t> tx;
+	uint8_t *rx_ptr = rx.data();
+	const uint8_t read_mode = (do_read) ? (MPSSE_DO_READ | _read_mode) : 0;
+	const uint32_t max_xfer = _buffer_size - 3;
 
 	if (_verbose)
-		printSuccess("begin: " + std::to_string(len));
-
-	for (uint32_t buf_pos = 0; buf_pos < len; buf_pos++) {
-		/* extract bit from TMS and TDI sequence */
-		uint8_t tms_bit = (tms[buf_pos >> 3] >> (buf_pos & 0x07) & 0x01);
-		uint8_t tdi_bit = (tdi[buf_pos >> 3] >> (buf_pos & 0x07) & 0x01);
-
-		if (_verbose) {
-			char mess[256];
-			snprintf(mess, 256, "tms %d -> %d tdi %d -> %d mode %d %d/%d (%d)",
-					_curr_tms, tms_bit, _curr_tdi, tdi_bit, mode, buf_pos, len, buff_len);
-			printInfo(mess);
+		printInfo("writeTMSTDI: " + to_string(len) + " bits, " +
+			to_string(segs.size()) + " segments");
+
+	for (const tmstdi_seg_t &seg : segs) {
+		if (seg.type == TMSTDI_TMS) {
+			uint8_t val = 0;
+			bit_copy(&val, 0, tms, seg.pos, seg.len);
+			if (bit_get(tdi, seg.pos))
+				val |= 0x80;
+			uint8_t cmd[3] = {
+				static_cast<uint8_t>(MPSSE_WRITE_TMS | MPSSE_LSB |
+					MPSSE_BITMODE | _write_mode | read_mode),
+				static_cast<uint8_t>(seg.len - 1), val};
+			if (mpsse_store(cmd, 3) < 0)
+				return false;
+			if (do_read && tmstdi_read(rx_ptr++, 1) < 0)
+				return false;
+			continue;
 		}
 
-		/* possible case:
-		 * tdi & tms not changed    -> write tdi
-		 * tdi change but tms not   -> write tdi
-		 * tdi idem but tms changed -> write tms
-		 * tdi & tms changed        -> serie of write tms
-		 * but finally:
-		 * if tms is not changed -> write tdi
-		 * otherwise             -> write tms
-		 */
-		/* tms unchanged -> try to use TDI/TDO transaction */
-		if (tms_bit == _curr_tms) {
-			/* a tms transaction exist but not flushed or full
-			 * if tdi is not changed -> update tms sequence
-			 */
-			if (mode == 2 && buff_len != 0 && tdi_bit == _curr_tdi) {
-				ret = update_tms_buff(&tms_tmp, tms_bit, buff_len,
-						tdi_bit, tdo);
-				if (ret < 0)
-					return false;
-				else
-					buff_len = ret;
-			} else {
-				/* tdi sequence
-				 * first flush tms sequence if required */
-				if (mode != 1 && buff_len != 0) {
-					ret = update_tms_buff(&tms_tmp, 0, buff_len, _curr_tdi,
-						tdo, true);
-					if (ret < 0)
-						return false;
-					else
-						buff_len = ret;
-				}
-				/* update tdi buffer with one more bit */
-				uint8_t mask = (1 << (buff_len & 0x07));
-				if (tdi_bit)
-					tdi_buf[buff_len >> 3] |= mask;
-				else
-					tdi_buf[buff_len >> 3] &= ~mask;
-				buff_len++;
-				mode = 1;
-			}
-		/* TMS is changed -> TMS transaction */
-		} else {
-			/* flush */
-			/* previous write TDI -> flush */
-			if (mode == 1 && buff_len > 0) {
-				bool is_end = false;
-				/* tms 0 -> 1: it's handled by writeTDI:
-				 * append bit to avoid another transaction */
-				if (_curr_tms == 0 && tms_bit == 1) {
-					uint8_t mask = (1 << (buff_len & 0x07));
-					if (tdi_bit)
-						tdi_buf[buff_len >> 3] |= mask;
-					else
-						tdi_buf[buff_len >> 3] &= ~mask;
-					buff_len++;
-					is_end = true;
-				}
-				writeTDI(tdi_buf, tdo_tmp, buff_len, is_end);
-				update_tdo_buff(tdo_tmp, tdo, buff_len);
-				memset(tdi_buf, 0, max_len);
-				buff_len = 0;
-				if (is_end) {
-					_curr_tdi = tdi_bit;
-					mode = 1;
-					continue;
-				}
-			/* same state -> simply flush */
-			} else if (tdi_bit != _curr_tdi && mode == 2 && buff_len > 0) {
-				ret = update_tms_buff(&tms_tmp, 0, buff_len, _curr_tdi, tdo, true);
-				if (ret < 0)
-					return false;
-				else
-					buff_len = ret;
-				tms_tmp = 0;
-			}
-			/* update */
-			ret = update_tms_buff(&tms_tmp, tms_bit, buff_len, tdi_bit, tdo);
-			if (ret < 0)
+		/* TDI realigned on byte boundary */
+		uint32_t nb_byte = seg.len >> 3;
+		uint32_t nb_bit = seg.len & 0x07;
+		tx.assign((seg.len + 7) / 8, 0);
+		bit_copy(tx.data(), 0, tdi, seg.pos, seg.len);
+		uint8_t *tx_ptr = tx.data();
+		uint8_t cmd[3] = {static_cast<uint8_t>(MPSSE_LSB | MPSSE_DO_WRITE |
+			_write_mode | read_mode), 0, 0};
+
+		while (nb_byte > 0) {
+			uint32_t xfer = min(nb_byte, max_xfer);
+			cmd[1] = static_cast<uint8_t>((xfer - 1) & 0xff);
+			cmd[2] = static_cast<uint8_t>(((xfer - 1) >> 8) & 0xff);
+			if (mpsse_store(cmd, 3) < 0 || mpsse_store(tx_ptr, xfer) < 0)
 				return false;
-			else
-				buff_len = ret;
-			mode = 2;
+			if (do_read && tmstdi_read(rx_ptr, xfer) < 0)
+				return false;
+			tx_ptr += xfer;
+			rx_ptr += xfer;
+			nb_byte -= xfer;
 		}
 
-		/* buffer full? */
-		if (buff_len == 8*max_len && mode == 1) {
-			writeTDI(tdi_buf, tdo_tmp, buff_len, false);
-			update_tdo_buff(tdo_tmp, tdo, buff_len);
-			memset(tdi_buf, 0, max_len);
-			buff_len = 0;
-		} else if (buff_len == 6 && mode == 2) {
-			ret = update_tms_buff(&tms_tmp, 0, buff_len, _curr_tdi, tdo, true);
-			if (ret < 0)
+		if (nb_bit != 0) {
+			cmd[0] |= MPSSE_BITMODE;
+			cmd[1] = static_cast<uint8_t>(nb_bit - 1);
+			cmd[2] = *tx_ptr;
+			if (mpsse_store(cmd, 3) < 0)
+				return false;
+			if (do_read && tmstdi_read(rx_ptr++, 1) < 0)
 				return false;
-			else
-				buff_len = ret;
-			tms_tmp = 0;
 		}
-		_curr_tdi = tdi_bit;
-		_curr_tms = tms_bit;
 	}
 
-	 /* end -> force flush buffers */
-	if (buff_len > 0) {
-		switch (mode) {
-		case 1:
-			writeTDI(tdi_buf, tdo_tmp, buff_len, false);
-			update_tdo_buff(tdo_tmp, tdo, buff_len);
-			break;
-		case 2:
-			if (update_tms_buff(&tms_tmp, 0, buff_len, _curr_tdi,
-						tdo, true) < 0)
-				return false;
-			break;
-		}
+	/* single sync point: all reads are received at once */
+	if (do_read && !_ch552WA) {
+		if (mpsse_flush_read() < 0)
+			return false;
+	} else if (!do_read) {
+		if (mpsse_write() < 0)
+			return false;
 	}
-	if (_verbose) {
-		printSuccess("end state: tdi " + std::to_string(_curr_tdi) +
-				" tms " + std::to_string(_curr_tms));
+
+	_curr_tms = bit_get(tms, len - 1);
+	_curr_tdi = bit_get(tdi, len - 1);
+
+	if (!tdo)
+		return true;
+
+	/* demultiplex: bit commands (and TMS commands) shift TDO from
+	 * MSB, residual byte must be realigned
+	 */
+	rx_ptr = rx.data();
+	for (const tmstdi_seg_t &seg : segs) {
+		uint32_t nb_byte = seg.len >> 3;
+		uint32_t nb_bit = seg.len & 0x07;
+		if (nb_bit != 0)
+			rx_ptr[nb_byte] >>= (8 - nb_bit);
+		bit_copy(tdo, seg.pos, rx_ptr, 0, seg.len);
+		rx_ptr += (seg.len + 7) / 8;
 	}
 
 	return true;
@@ -36,6 +36,8 @@ class FtdiJtagMPSSE : public JtagInterface, public FTDIpp_MPSSE {
 	int writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer) override;
 	/* clock */
 	int toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len) override;
+	/* wait: clock-only commands when available */
+	int delay(uint8_t tms, uint64_t ns, uint32_t min_clocks) override;
 	/* TDI */
 	int writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end) override;
 
@@ -59,21 +61,19 @@ class FtdiJtagMPSSE : public JtagInterface, public FTDIpp_MPSSE {
 
 	int flush() override;
 
+	bool setDeferredRead(bool enable) override;
+	int flushDeferred() override;
+
  private:
 	void init_internal(const mpsse_bit_config &cable);
 	/* writeTMSTDI specifics */
 	/*!
-	 * \brief try to append tms buffer, flush content if > 6
-	 * \param buffer: current tms buffer
-	 * \param bit: bit to append
-	 * \param offset: bits already stored
-	 * \param tdo: buffer used when reading after flush
-	 * \param len: length
-	 * \return < 0 if transaction fails, offset + 1 when append and 0 when flush
+	 * \brief register TDO read for the last stored command: queued
+	 *        (received at the end of the sequence) or read immediately
+	 *        with CH552 workaround
+	 * \return < 0 on error
 	 */
-	int32_t update_tms_buff(uint8_t *buffer, uint8_t bit,
-		uint32_t offset, uint8_t tdi, uint8_t *tdo, bool end=false);
-	uint32_t update_tdo_buff(uint8_t *buffer, uint8_t *tdo, uint32_t len);
+	int tmstdi_read(uint8_t *rx, int len);
 	/*!
 	 * \brief configure read and write edge (pos or neg), with freq < 15MHz
 	 *        neg is used for write and pos to sample. with freq >= 15MHz
@@ -84,8 +84,8 @@ class FtdiJtagMPSSE : public JtagInterface, public FTDIpp_MPSSE {
 	uint8_t _write_mode; /**< write edge configuration */
 	uint8_t _read_mode; /**< read edge configuration */
 	bool _invert_read_edge; /**< read edge selection (false: pos, true: neg) */
+	bool _defer_read; /**< TDO reads are queued until flushDeferred */
 	/* writeTMSTDI specifics */
-	uint32_t _tdo_pos;
 	uint8_t _curr_tdi;
 	uint8_t _curr_tms;
 };
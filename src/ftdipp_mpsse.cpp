@@ -9,6 +9,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -19,20 +20,31 @@
 
 #include "display.hpp"
 #include "ftdipp_mpsse.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
 //#define DEBUG 1
+/* invalid command: answered by 0xFA followed by the command */
+#define MPSSE_BAD_CMD 0xAA
+
+/* asynchronous writes: buffer content is coalesced into large
+ * transfers, several are queued to keep the bus busy
+ */
+#define MPSSE_TX_SLOTS     4
+#define MPSSE_TX_SLOT_SIZE (16 * 1024)
 #define display(...) \
-	do { if (_verbose) fprintf(stdout, __VA_ARGS__);}while(0)
+	do { if (_verbose) printfInfo(__VA_ARGS__);}while(0)
 
 FTDIpp_MPSSE::FTDIpp_MPSSE(const cable_t &cable, const string &dev,
 				const std::string &serial, uint32_t clkHZ, int8_t verbose):
-				_verbose(verbose > 2), _cable(cable.config), _vid(0),
+				_verbose(verbose > 2), _fast_attach(true), _async_write(true),
+				_cable(cable.config), _vid(0),
 				_pid(0), _index(0),
 				_bus(cable.bus_addr), _addr(cable.device_addr),
 				_bitmode(BITMODE_RESET),
 				_interface(cable.config.interface),
+				_rx_pending(0), _rx_limit(0), _tx_cur(0), _gpio_deferred(false),
 				_clkHZ(clkHZ), _buffer_size(2*32768), _num(0)
 {
 	libusb_error ret;
@@ -56,12 +68,35 @@ FTDIpp_MPSSE::FTDIpp_MPSSE(const cable_t &cable, const string &dev,
 	open_device(serial, 115200);
 	_buffer_size = _ftdi->max_packet_size;
 
+	/* pending reads must fit into the FTDI fifo: when full the
+	 * MPSSE engine stalls and no more commands are accepted
+	 */
+	switch (_ftdi->type) {
+	case TYPE_2232H:
+	case TYPE_4232H:
+		_rx_limit = 4096;
+		break;
+	case TYPE_232H:
+		_rx_limit = 1024;
+		break;
+	default:
+		_rx_limit = 128;
+	}
+	_rx_buf.resize(_rx_limit);
+
 	_buffer = (unsigned char *)malloc(sizeof(unsigned char) * _buffer_size);
 	if (!_buffer) {
 		printError("_buffer malloc failed");
 		throw std::runtime_error("_buffer malloc failed");
 	}
 
+#ifdef ENABLE_MPSSE_EMU
+	/* software device: no USB descriptor */
+	(void)ret;
+	(void)err;
+	snprintf(reinterpret_cast<char *>(_iproduct), sizeof(_iproduct),
+		"MPSSE emulator");
+#else
 	/* search for iProduct -> need to have
 	 * ftdi->usb_dev (libusb_device_handler) -> libusb_device ->
 	 * libusb_device_descriptor
@@ -91,6 +126,7 @@ FTDIpp_MPSSE::FTDIpp_MPSSE(const cable_t &cable, const string &dev,
 		printWarn(err);
 		memset(_iproduct,'\0', 200);
 	}
+#endif
 }
 
 FTDIpp_MPSSE::~FTDIpp_MPSSE()
@@ -104,6 +140,14 @@ FTDIpp_MPSSE::~FTDIpp_MPSSE()
 		}
 	}
 
+	/* queued transfers must be completed before mode change */
+	if (!_tx_slots.empty()) {
+		mpsse_write();
+		for (auto &slot : _tx_slots)
+			free(slot.buf);
+		_tx_slots.clear();
+	}
+
 	if ((ret = ftdi_set_bitmode(_ftdi, 0, BITMODE_RESET)) < 0) {
 		snprintf(err, sizeof(err), "unable to config pins : %d %s",
 			ret, ftdi_get_error_string(_ftdi));
@@ -166,13 +210,13 @@ void FTDIpp_MPSSE::open_device(const std::string &serial, unsigned int baudrate)
 			snprintf(description, sizeof(description), " (USB bus %d addr %d)",
 				 _bus, _addr);
 #endif
-		fprintf(stderr, "unable to open ftdi device: %d (%s)%s\n",
+		printfError("unable to open ftdi device: %d (%s)%s\n",
 			ret, ftdi_get_error_string(_ftdi), description);
 		ftdi_free(_ftdi);
 		throw std::runtime_error("unable to open ftdi device");
 	}
 	if (ftdi_set_baudrate(_ftdi, baudrate) < 0) {
-		fprintf(stderr, "baudrate error\n");
+		printfError("baudrate error\n");
 		close_device();
 		throw std::runtime_error("baudrate error");
 	}
@@ -206,7 +250,7 @@ int FTDIpp_MPSSE::close_device()
 	 if (_ftdi->usb_dev != NULL) {
 		int rtn = libusb_release_interface(_ftdi->usb_dev, _ftdi->interface);
 		if (rtn < 0) {
-			fprintf(stderr, "release interface failed %d\n", rtn);
+			printfError("release interface failed %d\n", rtn);
 			return EXIT_FAILURE;
 		}
 #ifdef ATTACH_KERNEL
@@ -214,7 +258,7 @@ int FTDIpp_MPSSE::close_device()
 		if (_ftdi->module_detach_mode == AUTO_DETACH_SIO_MODULE) {
 			rtn = libusb_attach_kernel_driver(_ftdi->usb_dev, _ftdi->interface);
 			if( rtn != 0 && rtn != LIBUSB_ERROR_NOT_FOUND)
-				fprintf(stderr, "detach error %d\n", rtn);
+				printfError("detach error %d\n", rtn);
 		}
 #endif
 	}
@@ -244,9 +288,14 @@ int FTDIpp_MPSSE::init(unsigned char latency, unsigned char bitmask_mode,
 				unsigned char mode)
 {
 	int ret;
-	unsigned char buf_cmd[6] = { SET_BITS_LOW, 0, 0,
-		SET_BITS_HIGH, 0, 0
-	};
+
+	if (mode == BITMODE_MPSSE && _fast_attach) {
+		if ((ret = fast_init(latency, bitmask_mode)) < 0)
+			return ret;
+		if (ret == 0)
+			return (set_chunksize(mode) < 0) ? -1 : tx_async_init();
+		display("fast attach: MPSSE not in sync, full init\n");
+	}
 
 	if ((ret = ftdi_usb_reset(_ftdi)) < 0) {
 		printError("FTDI reset error with code " +
@@ -296,27 +345,7 @@ int FTDIpp_MPSSE::init(unsigned char latency, unsigned char bitmask_mode,
 		if (setClkFreq(_clkHZ) < 0)
 			return -1;
 
-		if (_cable.status_pin != -1) {
-			if (_cable.status_pin <= 7) {
-				_cable.bit_low_dir |= 1 << _cable.status_pin;
-				_cable.bit_low_val &= ~(1 << _cable.status_pin);
-			} else {
-				_cable.bit_high_dir |= 1 << (_cable.status_pin - 8);
-				_cable.bit_high_val &= ~(1 << (_cable.status_pin - 8));
-			}
-		}
-
-		int to_wr = 3;
-
-		buf_cmd[1] = _cable.bit_low_val;  // 0xe8;
-		buf_cmd[2] = _cable.bit_low_dir;  // 0xeb;
-
-		if (_ftdi->type != TYPE_4232H) {
-			buf_cmd[4] = _cable.bit_high_val;  // 0x00;
-			buf_cmd[5] = _cable.bit_high_dir;  // 0x60;
-			to_wr = 6;
-		}
-		if ((ret = mpsse_store(buf_cmd, to_wr)) < 0) {
+		if ((ret = mpsse_store_gpio_init()) < 0) {
 			printError("fail to store buffer " +
 					string(ftdi_get_error_string(_ftdi)));
 			return -1;
@@ -328,6 +357,97 @@ int FTDIpp_MPSSE::init(unsigned char latency, unsigned char bitmask_mode,
 		}
 	}
 
+	if (set_chunksize(mode) < 0)
+		return -1;
+	return (mode == BITMODE_MPSSE) ? tx_async_init() : 0;
+}
+
+/* fast attach: no reset nor purge. Clock, gpios and a bad command are
+ * sent with one write: an engine in a known state answers with 0xFA and
+ * the bad command, anything else (stale data from a previous session,
+ * no answer) means the full init sequence is required.
+ * return 0 when attached, 1 when full init is required, < 0 on error
+ */
+int FTDIpp_MPSSE::fast_init(unsigned char latency, unsigned char bitmask_mode)
+{
+	int ret;
+
+	if ((ret = ftdi_set_latency_timer(_ftdi, latency)) < 0) {
+		printError("FTDI set latency timer error with code " +
+				std::to_string(ret) + " (" +
+				string(ftdi_get_error_string(_ftdi)) + ")");
+		return ret;
+	}
+	if ((ret = ftdi_set_bitmode(_ftdi, bitmask_mode, BITMODE_MPSSE)) < 0) {
+		printError("FTDI bitmode config error with code " +
+				std::to_string(ret) + " (" +
+				string(ftdi_get_error_string(_ftdi)) + ")");
+		return ret;
+	}
+
+	unsigned char sync[2] = {MPSSE_BAD_CMD, SEND_IMMEDIATE};
+	if ((ret = mpsse_store_clk(_clkHZ)) < 0)
+		return ret;
+	if ((ret = mpsse_store_gpio_init()) < 0)
+		return ret;
+	if ((ret = mpsse_store(sync, 2)) < 0)
+		return ret;
+	if ((ret = mpsse_write()) < 0)
+		return ret;
+
+	/* answer is expected after, at most, one latency timer period:
+	 * each empty read waits for it
+	 */
+	unsigned char rx[8];
+	int num_read = 0;
+	for (int i = 0; i < 4 && num_read < 2; i++) {
+		uint64_t t = stats_start();
+		ret = ftdi_read_data(_ftdi, rx + num_read, sizeof(rx) - num_read);
+		if (ret < 0) {
+			printError("fast attach: fail to read: " +
+					string(ftdi_get_error_string(_ftdi)));
+			return ret;
+		}
+		stats_xfer_in(ret, t);
+		num_read += ret;
+	}
+
+	if (num_read != 2 || rx[0] != 0xFA || rx[1] != MPSSE_BAD_CMD)
+		return 1;
+	return 0;
+}
+
+int FTDIpp_MPSSE::mpsse_store_gpio_init()
+{
+	unsigned char buf_cmd[6] = { SET_BITS_LOW, 0, 0,
+		SET_BITS_HIGH, 0, 0
+	};
+
+	if (_cable.status_pin != -1) {
+		if (_cable.status_pin <= 7) {
+			_cable.bit_low_dir |= 1 << _cable.status_pin;
+			_cable.bit_low_val &= ~(1 << _cable.status_pin);
+		} else {
+			_cable.bit_high_dir |= 1 << (_cable.status_pin - 8);
+			_cable.bit_high_val &= ~(1 << (_cable.status_pin - 8));
+		}
+	}
+
+	int to_wr = 3;
+
+	buf_cmd[1] = _cable.bit_low_val;  // 0xe8;
+	buf_cmd[2] = _cable.bit_low_dir;  // 0xeb;
+
+	if (_ftdi->type != TYPE_4232H) {
+		buf_cmd[4] = _cable.bit_high_val;  // 0x00;
+		buf_cmd[5] = _cable.bit_high_dir;  // 0x60;
+		to_wr = 6;
+	}
+	return mpsse_store(buf_cmd, to_wr);
+}
+
+int FTDIpp_MPSSE::set_chunksize(unsigned char mode)
+{
 	if (ftdi_read_data_set_chunksize(_ftdi, _buffer_size) < 0) {
 		printError("fail to set read chunk size: " +
 				string(ftdi_get_error_string(_ftdi)));
@@ -344,10 +464,44 @@ int FTDIpp_MPSSE::init(unsigned char latency, unsigned char bitmask_mode,
 }
 
 int FTDIpp_MPSSE::setClkFreq(uint32_t clkHZ)
+{
+	int ret, real_freq;
+	uint8_t buffer[4];
+
+	/* deferred reads must be received before buffers purge */
+	if ((ret = mpsse_flush_read()) < 0)
+		return ret;
+	if ((real_freq = mpsse_store_clk(clkHZ)) < 0)
+		return real_freq;
+	if ((ret = mpsse_write()) < 0) {
+		printfError("Error: write for frequency return %d\n", ret);
+		return ret;
+	}
+	if ((ret = ftdi_read_data(_ftdi, buffer, 4)) < 0) {
+		printError("selfClkFreq: fail to read: " +
+				string(ftdi_get_error_string(_ftdi)));
+		return ret;
+	}
+
+#if (FTDI_VERSION < 105)
+	ftdi_usb_purge_buffers(_ftdi);
+#else
+	if ((ret = ftdi_tcioflush(_ftdi)) < 0) {
+		printError("selfClkFreq: fail to flush buffers: " +
+				string(ftdi_get_error_string(_ftdi)));
+		return ret;
+	}
+
+#endif
+
+	return real_freq;
+}
+
+int FTDIpp_MPSSE::mpsse_store_clk(uint32_t clkHZ)
 {
 	int ret;
 	bool use_divide_by_5;
-	uint8_t buffer[4] = { TCK_DIVISOR, 0x00, 0x00};
+	uint8_t buffer[3] = { TCK_DIVISOR, 0x00, 0x00};
 	uint32_t base_freq;
 	float real_freq = 0;
 	uint16_t presc;
@@ -418,7 +572,7 @@ int FTDIpp_MPSSE::setClkFreq(uint32_t clkHZ)
 	display("presc : %d input freq : %u requested freq : %u real freq : %f\n",
 			presc, base_freq, _clkHZ, real_freq);
 
-	/*printf("base freq %d div by 5 %c presc %d\n", base_freq, (use_divide_by_5)?'1':'0',
+	/*printfInfo("base freq %d div by 5 %c presc %d\n", base_freq, (use_divide_by_5)?'1':'0',
 			presc); */
 
 
@@ -427,26 +581,6 @@ int FTDIpp_MPSSE::setClkFreq(uint32_t clkHZ)
 
 	if ((ret = mpsse_store(buffer, 3)) < 0)
 		return ret;
-	if ((ret = mpsse_write()) < 0) {
-		fprintf(stderr, "Error: write for frequency return %d\n", ret);
-		return ret;
-	}
-	if ((ret = ftdi_read_data(_ftdi, buffer, 4)) < 0) {
-		printError("selfClkFreq: fail to read: " +
-				string(ftdi_get_error_string(_ftdi)));
-		return ret;
-	}
-
-#if (FTDI_VERSION < 105)
-	ftdi_usb_purge_buffers(_ftdi);
-#else
-	if ((ret = ftdi_tcioflush(_ftdi)) < 0) {
-		printError("selfClkFreq: fail to flush buffers: " +
-				string(ftdi_get_error_string(_ftdi)));
-		return ret;
-	}
-
-#endif
 
 	_clkHZ = real_freq;
 
@@ -466,7 +600,7 @@ int FTDIpp_MPSSE::mpsse_store(unsigned char *buff, int len)
 	if (_num + len > _buffer_size) {
 		/* flush buffer if already full */
 		if (_num == _buffer_size) {
-			if ((ret = mpsse_write()) < 0) {
+			if ((ret = mpsse_submit()) < 0) {
 				printError("mpsse_store: fails to first flush " +
 						std::to_string(ret) + " " +
 						string(ftdi_get_error_string(_ftdi)));
@@ -481,7 +615,7 @@ int FTDIpp_MPSSE::mpsse_store(unsigned char *buff, int len)
 			store_size = _buffer_size - _num;
 			memcpy(_buffer + _num, ptr, store_size);
 			_num += store_size;
-			if ((ret = mpsse_write()) < 0) {
+			if ((ret = mpsse_submit()) < 0) {
 				printError("mpsse_store: fails to first flush " +
 						std::to_string(ret) + " " +
 						string(ftdi_get_error_string(_ftdi)));
@@ -504,6 +638,26 @@ int FTDIpp_MPSSE::mpsse_store(unsigned char *buff, int len)
 int FTDIpp_MPSSE::mpsse_write()
 {
 	int ret;
+
+	if (!_tx_slots.empty()) {
+		/* sync point: queue buffer content, send current slot and
+		 * wait for all transfers
+		 */
+		int num = _num;
+		if ((ret = mpsse_submit()) < 0)
+			return ret;
+		if (_tx_slots[_tx_cur].len > 0) {
+			stats_forced_flush();
+			if ((ret = tx_send_slot()) < 0)
+				return ret;
+		}
+		for (auto &slot : _tx_slots) {
+			if ((ret = tx_wait_slot(slot)) < 0)
+				return ret;
+		}
+		return num;
+	}
+
 	if (_num == 0)
 		return 0;
 
@@ -511,14 +665,114 @@ int FTDIpp_MPSSE::mpsse_write()
 	display("%s %d\n", __func__, _num);
 #endif
 
+	uint64_t t = stats_start();
 	if ((ret = ftdi_write_data(_ftdi, _buffer, _num)) != _num) {
 		printError("mpsse_write: fail to write with error " +
 				std::to_string(ret) + " (" +
 				string(ftdi_get_error_string(_ftdi)) + ")");
 		return ret;
 	}
+	stats_xfer_out(_num, t);
+	if (_num < _buffer_size)
+		stats_forced_flush();
+
+	_num = 0;
+	return ret;
+}
+
+int FTDIpp_MPSSE::mpsse_submit()
+{
+	int ret;
 
+	if (_tx_slots.empty())
+		return mpsse_write();
+	if (_num == 0)
+		return 0;
+
+	/* current slot can't store buffer content: send it */
+	if (_tx_slots[_tx_cur].len + _num > MPSSE_TX_SLOT_SIZE) {
+		if ((ret = tx_send_slot()) < 0)
+			return ret;
+	}
+	mpsse_tx_t &slot = _tx_slots[_tx_cur];
+	memcpy(slot.buf + slot.len, _buffer, _num);
+	slot.len += _num;
+	ret = _num;
 	_num = 0;
+
+	if (slot.len + _buffer_size > MPSSE_TX_SLOT_SIZE) {
+		int err;
+		if ((err = tx_send_slot()) < 0)
+			return err;
+	}
+	return ret;
+}
+
+int FTDIpp_MPSSE::tx_async_init()
+{
+	if (!_async_write || !_tx_slots.empty())
+		return 0;
+	if (_buffer_size > MPSSE_TX_SLOT_SIZE)
+		return 0;
+
+	/* one libusb transfer for each slot */
+	if (ftdi_write_data_set_chunksize(_ftdi, MPSSE_TX_SLOT_SIZE) < 0) {
+		printError("fail to set write chunk size: " +
+				string(ftdi_get_error_string(_ftdi)));
+		return -1;
+	}
+
+	for (int i = 0; i < MPSSE_TX_SLOTS; i++) {
+		unsigned char *buf = (unsigned char *)malloc(MPSSE_TX_SLOT_SIZE);
+		if (!buf) {
+			printError("tx slot malloc failed");
+			for (auto &slot : _tx_slots)
+				free(slot.buf);
+			_tx_slots.clear();
+			return -1;
+		}
+		_tx_slots.push_back({buf, 0, NULL});
+	}
+	_tx_cur = 0;
+	return 0;
+}
+
+int FTDIpp_MPSSE::tx_send_slot()
+{
+	mpsse_tx_t &slot = _tx_slots[_tx_cur];
+	if (slot.len == 0)
+		return 0;
+
+	slot.tc = ftdi_write_data_submit(_ftdi, slot.buf, slot.len);
+	if (!slot.tc) {
+		printError("mpsse_write: fail to submit transfer (" +
+				string(ftdi_get_error_string(_ftdi)) + ")");
+		slot.len = 0;
+		return -1;
+	}
+
+	/* next slot may be still in flight */
+	_tx_cur = (_tx_cur + 1) % _tx_slots.size();
+	return tx_wait_slot(_tx_slots[_tx_cur]);
+}
+
+int FTDIpp_MPSSE::tx_wait_slot(mpsse_tx_t &slot)
+{
+	if (!slot.tc)
+		return 0;
+
+	uint64_t t = stats_start();
+	int ret = ftdi_transfer_data_done(slot.tc);
+	stats_xfer_out((ret < 0) ? 0 : ret, t);
+	slot.tc = NULL;
+	int len = slot.len;
+	slot.len = 0;
+	if (ret != len) {
+		printError("mpsse_write: fail to write with error " +
+				std::to_string(ret) + " (" +
+				string(ftdi_get_error_string(_ftdi)) + ")");
+		return (ret < 0) ? ret : -1;
+	}
 	return ret;
 }
 
@@ -528,6 +782,10 @@ int FTDIpp_MPSSE::mpsse_read(unsigned char *rx_buff, int len)
 	int num_read = 0;
 	unsigned char *p = rx_buff;
 
+	/* previously queued reads must be received first */
+	if ((ret = mpsse_flush_read()) < 0)
+		return ret;
+
 	/* force buffer transmission before read */
 	if ((ret = mpsse_store(SEND_IMMEDIATE)) < 0) {
 		printError("mpsse_read: fail to store with error: " +
@@ -544,11 +802,13 @@ int FTDIpp_MPSSE::mpsse_read(unsigned char *rx_buff, int len)
 	}
 
 	do {
+		uint64_t t = stats_start();
 		n = ftdi_read_data(_ftdi, p, len);
 		if (n < 0) {
-			fprintf(stderr, "Error: ftdi_read_data in %s", __func__);
+			printfError("Error: ftdi_read_data in %s", __func__);
 			return -1;
 		}
+		stats_xfer_in(n, t);
 #ifdef DEBUG
 		if (_verbose) {
 			display("%s %d\n", __func__, n);
@@ -564,17 +824,102 @@ int FTDIpp_MPSSE::mpsse_read(unsigned char *rx_buff, int len)
 	return num_read;
 }
 
+int FTDIpp_MPSSE::mpsse_queue_read(unsigned char *rx_buff, int len,
+		uint8_t mask, uint8_t shift, bool merge)
+{
+	int ret;
+	/* avoid FTDI fifo overflow: only the oldest results needed to
+	 * make room are received, others stay in flight
+	 */
+	if (_rx_pending + len > _rx_limit) {
+		int needed = std::min(_rx_pending + len - _rx_limit, _rx_pending);
+		if (needed > 0 && (ret = mpsse_rx_poll(needed)) < 0)
+			return ret;
+	}
+	_rx_queue.push_back({rx_buff, len, 0, mask, shift, merge});
+	_rx_pending += len;
+	return 0;
+}
+
+int FTDIpp_MPSSE::mpsse_flush_read()
+{
+	int ret;
+	if (_rx_pending == 0)
+		return 0;
+	if ((ret = mpsse_rx_poll(_rx_pending)) < 0)
+		return ret;
+	return 0;
+}
+
+int FTDIpp_MPSSE::mpsse_rx_poll(int min_len)
+{
+	int ret;
+
+	/* all queued commands must be sent, with a send immediate to
+	 * receive results without waiting for latency timer
+	 */
+	if ((ret = mpsse_store(SEND_IMMEDIATE)) < 0 ||
+			(ret = mpsse_write()) < 0) {
+		rx_abort();
+		printError("mpsse_rx_poll: fail to send commands");
+		return ret;
+	}
+
+	int received = 0;
+	while (received < min_len) {
+		uint64_t t = stats_start();
+		int n = ftdi_read_data(_ftdi, _rx_buf.data(),
+			std::min(min_len - received, static_cast<int>(_rx_buf.size())));
+		if (n < 0) {
+			rx_abort();
+			printError("mpsse_rx_poll: fail to read queued data (" +
+					string(ftdi_get_error_string(_ftdi)) + ")");
+			return n;
+		}
+		stats_xfer_in(n, t);
+		rx_dispatch(_rx_buf.data(), n);
+		received += n;
+	}
+	return received;
+}
+
+void FTDIpp_MPSSE::rx_dispatch(const unsigned char *rx, int len)
+{
+	_rx_pending -= len;
+	while (len > 0 && !_rx_queue.empty()) {
+		mpsse_rx_t &r = _rx_queue.front();
+		int n = std::min(len, r.len - r.done);
+		for (int i = 0; i < n; i++) {
+			uint8_t v = (rx[i] & r.mask) >> r.shift;
+			if (r.merge)
+				r.buf[r.done + i] |= v;
+			else
+				r.buf[r.done + i] = v;
+		}
+		r.done += n;
+		rx += n;
+		len -= n;
+		if (r.done == r.len)
+			_rx_queue.pop_front();
+	}
+}
+
+void FTDIpp_MPSSE::rx_abort()
+{
+	_rx_queue.clear();
+	_rx_pending = 0;
+}
+
 /**
  * Read GPIO (xCBUSy + xDBUSy) bank
  * @return pins state
  */
 uint16_t FTDIpp_MPSSE::gpio_get()
 {
-	uint8_t tx[2] = {GET_BITS_LOW, GET_BITS_HIGH};
 	uint8_t rx[2];
-	if (mpsse_store(tx, 2) < 0)
+	if (!gpio_sample(&rx[0], true) || !gpio_sample(&rx[1], false))
 		return 0;
-	if (mpsse_read(rx, 2) < 0)
+	if (gpio_flush() < 0)
 		return 0;
 
 	return (rx[1] << 8) | rx[0];
@@ -589,14 +934,82 @@ uint8_t FTDIpp_MPSSE::gpio_get(bool low_pins)
 {
 	uint8_t rx;
 
-	/* select between high and low pins */
-	if (mpsse_store((low_pins) ? GET_BITS_LOW : GET_BITS_HIGH) < 0)
-		return 0;
-	if (mpsse_read(&rx, 1) < 0)
+	if (!gpio_sample(&rx, low_pins) || gpio_flush() < 0)
 		return 0;
 	return rx;
 }
 
+/**
+ * Queue a read of low (xCBUSy) or high (xDBUSy) pins: sent with
+ * pending commands, value is stored by gpio_flush() or next read.
+ * @param[out] val: pins state
+ * @param[in] low_pins: if true read low, read high otherwise
+ * @return false when error, true otherwise
+ */
+bool FTDIpp_MPSSE::gpio_sample(uint8_t *val, bool low_pins)
+{
+	/* select between high and low pins */
+	if (mpsse_store((low_pins) ? GET_BITS_LOW : GET_BITS_HIGH) < 0)
+		return false;
+	return (mpsse_queue_read(val, 1) >= 0);
+}
+
+/**
+ * Send stored commands, including deferred pins updates, and receive
+ * queued samples.
+ * @return < 0 on error
+ */
+int FTDIpp_MPSSE::gpio_flush()
+{
+	if (_rx_pending != 0)
+		return mpsse_flush_read();
+	return mpsse_write();
+}
+
+/**
+ * Wait until one of mask pins is high. A sample is sent, with a send
+ * immediate, before each sleep and received after it: the result is
+ * already available when polling ends the sleep.
+ * @param[in] mask: pins to check
+ * @param[in] low_pins: if true check low (xCBUSy), high (xDBUSy) otherwise
+ * @param[in] period_us: delay between samples
+ * @param[in] nb_period: max number of samples
+ * @return false on timeout or error, true otherwise
+ */
+bool FTDIpp_MPSSE::gpio_wait(uint8_t mask, bool low_pins, uint32_t period_us,
+		uint32_t nb_period)
+{
+	uint8_t val = 0;
+
+	for (uint32_t i = 0; i < nb_period; i++) {
+		if (!gpio_sample(&val, low_pins) ||
+				mpsse_store(SEND_IMMEDIATE) < 0 || mpsse_write() < 0) {
+			rx_abort();
+			return false;
+		}
+		usleep(period_us);
+		if (gpio_flush() < 0)
+			return false;
+		if (val & mask)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Enable/disable deferred pins updates: when enabled pins commands are
+ * only stored and sent in order with surrounding commands. Disabling
+ * doesn't send stored commands (see gpio_flush()).
+ * @param[in] enable: deferred mode
+ * @return previous mode
+ */
+bool FTDIpp_MPSSE::gpio_set_deferred(bool enable)
+{
+	bool prev = _gpio_deferred;
+	_gpio_deferred = enable;
+	return prev;
+}
+
 /**
  * Set one or more pins of the full bank (CBUS + DBUS).
  * @param[in] pins bitmask
@@ -614,7 +1027,7 @@ bool FTDIpp_MPSSE::gpio_set(uint16_t gpios)
 		if (!__gpio_write(false))
 			return false;
 	}
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -631,7 +1044,7 @@ bool FTDIpp_MPSSE::gpio_set(uint8_t gpios, bool low_pins)
 		_cable.bit_high_val |= gpios;
 	if (!__gpio_write(low_pins))
 		return false;
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -651,7 +1064,7 @@ bool FTDIpp_MPSSE::gpio_clear(uint16_t gpios)
 		if (!__gpio_write(false))
 			return false;
 	}
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -669,7 +1082,7 @@ bool FTDIpp_MPSSE::gpio_clear(uint8_t gpios, bool low_pins)
 
 	if (!__gpio_write(low_pins))
 		return false;
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -685,7 +1098,7 @@ bool FTDIpp_MPSSE::gpio_write(uint16_t gpio)
 		return false;
 	if (!__gpio_write(false))
 		return false;
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -701,9 +1114,9 @@ bool FTDIpp_MPSSE::gpio_write(uint8_t gpio, bool low_pins)
 	else
 		_cable.bit_high_val = gpio;
 
-	if (__gpio_write(low_pins))
+	if (!__gpio_write(low_pins))
 		return false;
-	return (mpsse_write() >= 0);
+	return gpio_commit();
 }
 
 /**
@@ -792,6 +1205,17 @@ bool FTDIpp_MPSSE::__gpio_write(bool low_pins)
 	return (mpsse_store(tx, 3) >= 0);
 }
 
+/**
+ * private method to send pins update, or keep it in buffer with
+ * deferred mode
+ */
+bool FTDIpp_MPSSE::gpio_commit()
+{
+	if (_gpio_deferred)
+		return true;
+	return (mpsse_write() >= 0);
+}
+
 #ifdef USE_UDEV
 unsigned int FTDIpp_MPSSE::udevstufftoint(const char *udevstring, int base)
 {
@@ -804,13 +1228,12 @@ unsigned int FTDIpp_MPSSE::udevstufftoint(const char *udevstring, int base)
 
 	ret = (unsigned int)strtol(udevstring, &endp, base);
 	if (errno) {
-		fprintf(stderr,
-			"udevstufftoint: Unable to parse number Error : %s (%d)\n",
+		printfError("udevstufftoint: Unable to parse number Error : %s (%d)\n",
 			strerror(errno), errno);
 		return (-2);
 	}
 	if (endp == optarg) {
-		fprintf(stderr, "udevstufftoint: No digits were found\n");
+		printfError("udevstufftoint: No digits were found\n");
 		return (-3);
 	}
 	return (ret);
@@ -824,7 +1247,7 @@ bool FTDIpp_MPSSE::search_with_dev(const string &device)
 
 	struct stat statinfo;
 	if (stat(device.c_str(), &statinfo) < 0) {
-		printf("unable to stat file\n");
+		printfInfo("unable to stat file\n");
 		return false;
 	}
 
@@ -837,21 +1260,21 @@ bool FTDIpp_MPSSE::search_with_dev(const string &device)
 		devtype = 'c';
 		break;
 	default:
-		printf("not char or block device\n");
+		printfInfo("not char or block device\n");
 		return false;
 	}
 
 	/* Create the udev object */
 	udev = udev_new();
 	if (!udev) {
-		printf("Can't create udev\n");
+		printfInfo("Can't create udev\n");
 		return false;
 	}
 
 	dev = udev_device_new_from_devnum(udev, devtype, statinfo.st_rdev);
 
 	if (dev == NULL) {
-		printf("no dev\n");
+		printfInfo("no dev\n");
 		udev_device_unref(dev);
 		udev_unref(udev);
 		return false;
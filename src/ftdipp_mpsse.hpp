@@ -6,7 +6,9 @@
 #ifndef _FTDIPP_MPSSE_H
 #define _FTDIPP_MPSSE_H
 #include <ftdi.h>
+#include <deque>
 #include <string>
+#include <vector>
 
 #include "cable.hpp"
 
@@ -49,19 +51,96 @@ class FTDIpp_MPSSE {
 		void gpio_set_output(uint8_t gpio, bool low_pins);
 		/* configure as output pins */
 		void gpio_set_output(uint16_t gpio);
+		/*!
+		 * \brief when enabled, gpio_set/clear/write only store the
+		 *        MPSSE command: pins are updated in order with the
+		 *        surrounding commands at next flush (gpio_flush(), a
+		 *        read or a full buffer)
+		 * \return previous state
+		 */
+		bool gpio_set_deferred(bool enable);
+		/*!
+		 * \brief queue a read of low or high pins state: val is valid
+		 *        after gpio_flush() (or any read)
+		 * \return false when error, true otherwise
+		 */
+		bool gpio_sample(uint8_t *val, bool low_pins);
+		/*!
+		 * \brief send stored commands (deferred gpios) and receive
+		 *        queued samples
+		 * \return < 0 on error
+		 */
+		int gpio_flush();
+		/*!
+		 * \brief wait until one of mask pins is high: each sample is
+		 *        sent before sleeping period_us and received after,
+		 *        USB round trip is hidden by the sleep
+		 * \param[in] mask: pins to check
+		 * \param[in] low_pins: if true check low, high otherwise
+		 * \param[in] period_us: delay between samples
+		 * \param[in] nb_period: max number of samples
+		 * \return false on timeout or error, true otherwise
+		 */
+		bool gpio_wait(uint8_t mask, bool low_pins, uint32_t period_us,
+			uint32_t nb_period);
 
 	protected:
 		void open_device(const std::string &serial, unsigned int baudrate);
 		void ftdi_usb_close_internal();
 		int close_device();
+		/*!
+		 * \brief send buffer content and, with asynchronous writes,
+		 *        wait for all queued transfers: when it returns all
+		 *        stored commands have been received by the FTDI
+		 * \return < 0 on error
+		 */
 		int mpsse_write();
+		/*!
+		 * \brief queue buffer content without waiting: content is
+		 *        coalesced into large transfers sent asynchronously
+		 *        (same as mpsse_write() when disabled)
+		 * \return < 0 on error
+		 */
+		int mpsse_submit();
 		int mpsse_read(unsigned char *rx_buff, int len);
+		/*!
+		 * \brief register a read for a command already stored: data are
+		 *        copied to rx_buff as they are received (when the FTDI
+		 *        fifo is full, or by mpsse_flush_read), reads stay
+		 *        outstanding until then.
+		 *        Each byte is stored as (byte & mask) >> shift, or'ed with
+		 *        rx_buff content when merge is true
+		 * \return 0 on success, < 0 otherwise
+		 */
+		int mpsse_queue_read(unsigned char *rx_buff, int len,
+			uint8_t mask = 0xff, uint8_t shift = 0, bool merge = false);
+		/*!
+		 * \brief send buffer and receive all queued reads
+		 * \return 0 on success, < 0 otherwise
+		 */
+		int mpsse_flush_read();
 		int mpsse_store(unsigned char c);
 		int mpsse_store(unsigned char *c, int len);
 		int mpsse_get_buffer_size() {return _buffer_size;}
 		unsigned int udevstufftoint(const char *udevstring, int base);
 		bool search_with_dev(const std::string &device);
 		bool _verbose;
+		/*!
+		 * \brief when true (default) init() first tries to attach to the
+		 *        MPSSE engine without reset nor purge (clock, gpios and
+		 *        a sync check sent in a single write), full sequence is
+		 *        used when the engine doesn't answer as expected. Must be
+		 *        cleared before init() for MPSSE clones not supporting
+		 *        bad command echo
+		 */
+		bool _fast_attach;
+		/*!
+		 * \brief when true (default), after init() in MPSSE mode, full
+		 *        buffers are queued as asynchronous transfers (several
+		 *        in flight) instead of blocking writes. Must be cleared
+		 *        before init()
+		 */
+		bool _async_write;
 		mpsse_bit_config _cable;
 		int _vid;
 		int _pid;
@@ -72,8 +151,49 @@ class FTDIpp_MPSSE {
 		uint8_t _bitmode;
 		char _product[64];
 		unsigned char _interface;
+		/* init */
+		int fast_init(unsigned char latency, unsigned char bitmask_mode);
+		int mpsse_store_clk(uint32_t clkHZ);
+		int mpsse_store_gpio_init();
+		int set_chunksize(unsigned char mode);
+		/* asynchronous writes */
+		typedef struct {
+			unsigned char *buf;
+			int len;
+			struct ftdi_transfer_control *tc; /*!< NULL when not in flight */
+		} mpsse_tx_t;
+		int tx_async_init();
+		int tx_send_slot();
+		int tx_wait_slot(mpsse_tx_t &slot);
 		/* gpio */
 		bool __gpio_write(bool low_pins);
+		bool gpio_commit();
+		/* deferred reads */
+		typedef struct {
+			unsigned char *buf;
+			int len;
+			int done;  /*!< bytes already received */
+			uint8_t mask;
+			uint8_t shift;
+			bool merge;
+		} mpsse_rx_t;
+		/*!
+		 * \brief send buffer and receive at least min_len bytes of
+		 *        queued reads (oldest first)
+		 * \return number of bytes received, < 0 on error
+		 */
+		int mpsse_rx_poll(int min_len);
+		/* copy received bytes to queued reads buffers */
+		void rx_dispatch(const unsigned char *rx, int len);
+		/* drop queued reads after an error */
+		void rx_abort();
+		std::deque<mpsse_rx_t> _rx_queue; /*!< queued reads */
+		std::vector<unsigned char> _rx_buf; /*!< receive buffer */
+		int _rx_pending; /*!< number of bytes expected by queued reads */
+		int _rx_limit;   /*!< max pending bytes (FTDI TX fifo size) */
+		std::vector<mpsse_tx_t> _tx_slots; /*!< empty when synchronous */
+		size_t _tx_cur;  /*!< slot being filled */
+		bool _gpio_deferred; /*!< gpios updates sent with next commands */
 	protected:
 		uint32_t _clkHZ;
 		struct ftdi_context *_ftdi;
@@ -9,8 +9,10 @@
 #include <unistd.h>
 #include <string.h>
 #include "board.hpp"
+#include "display.hpp"
 #include "ftdipp_mpsse.hpp"
 #include "ftdispi.hpp"
+#include "transportStats.hpp"
 
 /*
  * SCLK -> ADBUS0
@@ -125,7 +127,7 @@ bool FtdiSpi::confCs(char stat)
 		ret |= gpio_set(_cs_bits);
 	}
 	if (!ret)
-		printf("Error: CS update\n");
+		printfInfo("Error: CS update\n");
 	return ret;
 }
 
@@ -149,11 +151,11 @@ int FtdiSpi::ft2232_spi_wr_then_rd(
 	clearCs();
 	uint32_t ret = ft2232_spi_wr_and_rd(tx_len, tx_data, NULL);
 	if (ret != 0) {
-		printf("%s : write error %d %d\n", __func__, ret, tx_len);
+		printfInfo("%s : write error %d %d\n", __func__, ret, tx_len);
 	} else {
 		ret = ft2232_spi_wr_and_rd(rx_len, NULL, rx_data);
 		if (ret != 0) {
-			printf("%s : read error\n", __func__);
+			printfInfo("%s : read error\n", __func__);
 		}
 	}
 	setCs();
@@ -176,10 +178,12 @@ int FtdiSpi::ft2232_spi_wr_and_rd(//struct ftdi_spi *spi,
 	uint32_t len = writecnt;
 	uint32_t xfer;
 
+	/* CS updates are stored in the same stream as data */
+	bool gpio_deferred = gpio_set_deferred(true);
 	if (_cs_mode == SPI_CS_AUTO) {
 		clearCs();
 	}
-	mpsse_write();
+	stats_bits((uint64_t)writecnt * 8);
 
 	/*
 	 * Minimize USB transfers by packing as many commands as possible
@@ -202,19 +206,21 @@ int FtdiSpi::ft2232_spi_wr_and_rd(//struct ftdi_spi *spi,
 
 		ret = mpsse_store(buf, i);
 		if (ret)
-			printf("send_buf failed before read: %i %s\n", ret, ftdi_get_error_string(_ftdi));
+			printfInfo("send_buf failed before read: %i %s\n", ret, ftdi_get_error_string(_ftdi));
 		i = 0;
 		if (readarr) {
-			//if (ret == 0) {
-			ret = mpsse_read(rx_ptr, xfer);
-			if ((uint32_t)ret != xfer)
-				printf("get_buf failed: %i\n", ret);
-			//}
+			/* several reads outstanding: data are received
+			 * while next commands are sent
+			 */
+			ret = mpsse_queue_read(rx_ptr, xfer);
+			if (ret < 0)
+				printfInfo("get_buf failed: %i\n", ret);
 			rx_ptr += xfer;
 		} else {
-			ret = mpsse_write();
-			if ((uint32_t)ret != xfer+3)
-				printf("error %d %d\n", ret, i);
+			/* queued: sent with next chunk or when CS is released */
+			ret = mpsse_submit();
+			if (ret < 0)
+				printfInfo("error %d %d\n", ret, i);
 		}
 		len -= xfer;
 
@@ -222,7 +228,19 @@ int FtdiSpi::ft2232_spi_wr_and_rd(//struct ftdi_spi *spi,
 
 	if (_cs_mode == SPI_CS_AUTO) {
 		if (!setCs())
-			printf("send_buf failed at write %d\n", ret);
+			printfInfo("send_buf failed at write %d\n", ret);
+	}
+	gpio_set_deferred(gpio_deferred);
+
+	/* read: CS release is sent with last command, before receiving
+	 * write: CS must be released before return
+	 */
+	if (readarr) {
+		if (mpsse_flush_read() < 0)
+			printfInfo("get_buf failed\n");
+	} else if (_cs_mode == SPI_CS_AUTO) {
+		if (mpsse_write() < 0)
+			printfInfo("send_buf failed at write %d\n", ret);
 	}
 
 	return 0;
@@ -272,19 +290,19 @@ int FtdiSpi::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		ft2232_spi_wr_and_rd(1, NULL, &rx);
 		count ++;
 		if (count == timeout) {
-			printf("timeout: %2x %d\n", rx, count);
+			printfInfo("timeout: %2x %d\n", rx, count);
 			break;
 		}
 
 		if (verbose) {
-			printf("%02x %02x %02x %02x\n", rx, mask, cond, count);
+			printfInfo("%02x %02x %02x %02x\n", rx, mask, cond, count);
 		}
 	} while((rx & mask) != cond);
 	setCs();
 	setCSmode(SPI_CS_AUTO);
 
 	if (count == timeout) {
-		printf("%x\n", rx);
+		printfInfo("%x\n", rx);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	} else
@@ -14,6 +14,7 @@
 #include "display.hpp"
 #include "fx2_ll.hpp"
 #include "ihexParser.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -109,7 +110,7 @@ bool FX2_ll::close()
 int FX2_ll::write(uint8_t endpoint, uint8_t *buff, uint16_t len)
 {
 	int ret, actual_length;
-	ret = libusb_bulk_transfer(dev_handle, LIBUSB_ENDPOINT_OUT | endpoint,
+	ret = stats_libusb_bulk_transfer(dev_handle, LIBUSB_ENDPOINT_OUT | endpoint,
 			buff, len, &actual_length, 1000);
 	if (ret != LIBUSB_SUCCESS) {
 		printError("FX2 write error: " + std::string(libusb_error_name(ret)));
@@ -123,7 +124,7 @@ int FX2_ll::write(uint8_t endpoint, uint8_t *buff, uint16_t len)
 int FX2_ll::read(uint8_t endpoint, uint8_t *buff, uint16_t len)
 {
 	int ret, actual_length;
-	ret = libusb_bulk_transfer(dev_handle, LIBUSB_ENDPOINT_IN | endpoint,
+	ret = stats_libusb_bulk_transfer(dev_handle, LIBUSB_ENDPOINT_IN | endpoint,
 			buff, len, &actual_length, 1000);
 	if (ret != LIBUSB_SUCCESS) {
 		printError("FX2 read error: " + std::string(libusb_error_name(ret)));
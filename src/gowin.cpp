@@ -12,6 +12,7 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include "jtag.hpp"
 #include "gowin.hpp"
@@ -453,8 +454,8 @@ bool Gowin::wr_rd(uint8_t cmd,
 	if (rx) {
 		if (verbose) {
 			for (i=xfer_len-1; i >= 0; i--)
-				printf("%02x ", xfer_rx[i]);
-			printf("\n");
+				printfInfo("%02x ", xfer_rx[i]);
+			printfInfo("\n");
 		}
 	    for (i = 0; i < rx_len; i++)
 			rx[i] = (xfer_rx[i]);
@@ -464,39 +465,39 @@ bool Gowin::wr_rd(uint8_t cmd,
 
 void Gowin::displayReadReg(uint32_t dev)
 {
-	printf("displayReadReg %08x\n", dev);
+	printfInfo("displayReadReg %08x\n", dev);
 	if (dev & STATUS_CRC_ERROR)
-		printf("\tCRC Error\n");
+		printfInfo("\tCRC Error\n");
 	if (dev & STATUS_BAD_COMMAND)
-		printf("\tBad Command\n");
+		printfInfo("\tBad Command\n");
 	if (dev & STATUS_ID_VERIFY_FAILED)
-		printf("\tID Verify Failed\n");
+		printfInfo("\tID Verify Failed\n");
 	if (dev & STATUS_TIMEOUT)
-		printf("\tTimeout\n");
+		printfInfo("\tTimeout\n");
 	if (dev & STATUS_MEMORY_ERASE)
-		printf("\tMemory Erase\n");
+		printfInfo("\tMemory Erase\n");
 	if (dev & STATUS_PREAMBLE)
-		printf("\tPreamble\n");
+		printfInfo("\tPreamble\n");
 	if (dev & STATUS_SYSTEM_EDIT_MODE)
-		printf("\tSystem Edit Mode\n");
+		printfInfo("\tSystem Edit Mode\n");
 	if (dev & STATUS_PRG_SPIFLASH_DIRECT)
-		printf("\tProgram spi flash directly\n");
+		printfInfo("\tProgram spi flash directly\n");
 	if (dev & STATUS_NON_JTAG_CNF_ACTIVE)
-		printf("\tNon-jtag is active\n");
+		printfInfo("\tNon-jtag is active\n");
 	if (dev & STATUS_BYPASS)
-		printf("\tBypass\n");
+		printfInfo("\tBypass\n");
 	if (dev & STATUS_GOWIN_VLD)
-		printf("\tGowin VLD\n");
+		printfInfo("\tGowin VLD\n");
 	if (dev & STATUS_DONE_FINAL)
-		printf("\tDone Final\n");
+		printfInfo("\tDone Final\n");
 	if (dev & STATUS_SECURITY_FINAL)
-		printf("\tSecurity Final\n");
+		printfInfo("\tSecurity Final\n");
 	if (dev & STATUS_READY)
-		printf("\tReady\n");
+		printfInfo("\tReady\n");
 	if (dev & STATUS_POR)
-		printf("\tPOR\n");
+		printfInfo("\tPOR\n");
 	if (dev & STATUS_FLASH_LOCK)
-		printf("\tFlash Lock\n");
+		printfInfo("\tFlash Lock\n");
 }
 
 bool Gowin::pollFlag(uint32_t mask, uint32_t value)
@@ -506,7 +507,7 @@ bool Gowin::pollFlag(uint32_t mask, uint32_t value)
 	do {
 		status = readStatusReg();
 		if (_verbose)
-			printf("pollFlag: %x\n", status);
+			printfInfo("pollFlag: %x\n", status);
 		if (timeout == 100000000){
 			printError("timeout");
 			return false;
@@ -699,9 +700,7 @@ bool Gowin::eraseFLASH()
 	 * there are no bit in status register to specify
 	 * when this operation is done so we need to wait
 	 */
-	//usleep(2*120000);
-	//uint8_t tt[37500];
-	_jtag->toggleClk(37500*8);
+	_jtag->delay(160000000, 37500*8);
 	printSuccess("Done");
 	return true;
 }
@@ -748,6 +747,11 @@ bool Gowin::eraseSRAM()
 	_jtag->shiftDR(_wr, _rd, _len); \
 	_jtag->toggleClk(6); } while (0)
 
+/* same as spi_gowin_write but _rd is only filled after execute() */
+#define spi_gowin_queue(_wr, _rd, _len) do { \
+	_jtag->queue_shiftDR(_wr, _rd, _len); \
+	_jtag->toggleClk(6); } while (0)
+
 int Gowin::spi_put(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint32_t len)
 {
 	uint8_t jrx[len+1], jtx[len+1];
@@ -791,19 +795,24 @@ int Gowin::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 		spi_gowin_write(&t, NULL, 8);
 		_jtag->flush();
 
-		/* send bit/bit full tx content (or set di to 0 when NULL) */
+		/* send bit/bit full tx content (or set di to 0 when NULL)
+		 * reads are queued and received once all bits are sent
+		 */
+		std::vector<uint8_t> r((rx) ? len * 8 : 0);
 		for (uint32_t i = 0; i < len * 8; i++) {
-			uint8_t r;
 			t = _spi_msk | _spi_do;
 			if (tx != NULL && tx[i>>3] & (1 << (7-(i&0x07))))
 				t |= _spi_di;
 			spi_gowin_write(&t, NULL, 8);
 			t |= _spi_sck;
-			spi_gowin_write(&t, (rx) ? &r : NULL, 8);
-			_jtag->flush();
-			/* if read reconstruct bytes */
-			if (rx) {
-				if (r & _spi_do)
+			spi_gowin_queue(&t, (rx) ? &r[i] : NULL, 8);
+		}
+		if (_jtag->execute() < 0)
+			return -1;
+		/* if read reconstruct bytes */
+		if (rx) {
+			for (uint32_t i = 0; i < len * 8; i++) {
+				if (r[i] & _spi_do)
 					rx[i >> 3] |= 1 << (7-(i & 0x07));
 				else
 					rx[i >> 3] &= ~(1 << (7-(i & 0x07)));
@@ -839,11 +848,11 @@ int Gowin::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 			tmp = (FsParser::reverseByte(rx[1]>>1)) | (0x01 & rx[2]);
 			count ++;
 			if (count == timeout) {
-				printf("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
+				printfInfo("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
 				break;
 			}
 			if (verbose) {
-				printf("%x %x %x %u\n", tmp, mask, cond, count);
+				printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 			}
 		} while ((tmp & mask) != cond);
 	} else {
@@ -868,24 +877,27 @@ int Gowin::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		do {
 			tmp = 0;
 			/* read status register bit/bit with di == 0 */
+			uint8_t r[8];
 			for (int i = 0; i < 8; i++) {
-				uint8_t r;
 				t &= ~_spi_sck;
 				spi_gowin_write(&t, NULL, 8);
 				t |= _spi_sck;
-				spi_gowin_write(&t, &r, 8);
-				_jtag->flush();
-				if ((r & _spi_do) != 0)
+				spi_gowin_queue(&t, &r[i], 8);
+			}
+			if (_jtag->execute() < 0)
+				return -1;
+			for (int i = 0; i < 8; i++) {
+				if ((r[i] & _spi_do) != 0)
 					tmp |= 1 << (7-i);
 			}
 
 			count++;
 			if (count == timeout) {
-				printf("timeout: %x\n", tmp);
+				printfInfo("timeout: %x\n", tmp);
 				break;
 			}
 			if (verbose)
-				printf("%x %x %x %u\n", tmp, mask, cond, count);
+				printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		} while ((tmp & mask) != cond);
 
 		/* set CS & unset SCK (next xfer) */
@@ -896,7 +908,7 @@ int Gowin::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 	}
 
 	if (count == timeout) {
-		printf("%02x\n", tmp);
+		printfInfo("%02x\n", tmp);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	}
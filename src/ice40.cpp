@@ -41,17 +41,12 @@ Ice40::~Ice40()
 
 void Ice40::reset()
 {
-	uint32_t timeout = 1000;
 	_spi->gpio_clear(_rst_pin);
 	usleep(1000);
 	_spi->gpio_set(_rst_pin);
 	printInfo("Reset ", false);
 	usleep(12000);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -62,7 +57,6 @@ void Ice40::reset()
  */
 bool Ice40::program_cram(uint8_t *data, uint32_t length)
 {
-	uint32_t timeout = 1000;
 
 	/* configure SPI */
 	_spi->setMode(3); // IDLE high, write on falling
@@ -96,11 +90,7 @@ bool Ice40::program_cram(uint8_t *data, uint32_t length)
 	usleep(12000);
 
 	printInfo("Wait for CDONE ", false);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -112,7 +102,6 @@ bool Ice40::program_cram(uint8_t *data, uint32_t length)
 
 void Ice40::program(unsigned int offset, bool unprotect_flash)
 {
-	uint32_t timeout = 1000;
 
 	if (_file_extension.empty())
 		return;
@@ -140,7 +129,7 @@ void Ice40::program(unsigned int offset, bool unprotect_flash)
 	SPIFlash flash(reinterpret_cast<SPIInterface *>(_spi), unprotect_flash,
 			_quiet);
 
-	printf("%02x\n", flash.read_status_reg());
+	printfInfo("%02x\n", flash.read_status_reg());
 	flash.read_id();
 	flash.erase_and_prog(offset, data, length);
 
@@ -151,11 +140,7 @@ void Ice40::program(unsigned int offset, bool unprotect_flash)
 	usleep(12000);
 
 	printInfo("Wait for CDONE ", false);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -163,7 +148,6 @@ void Ice40::program(unsigned int offset, bool unprotect_flash)
 
 bool Ice40::dumpFlash(uint32_t base_addr, uint32_t len)
 {
-	uint32_t timeout = 1000;
 	_spi->gpio_clear(_rst_pin);
 
 	/* prepare SPI access */
@@ -185,11 +169,7 @@ bool Ice40::dumpFlash(uint32_t base_addr, uint32_t len)
 	usleep(12000);
 
 	printInfo("Wait for CDONE ", false);
-	do {
-		timeout--;
-		usleep(12000);
-	} while (((_spi->gpio_get(true) & _done_pin) == 0) && timeout > 0);
-	if (timeout == 0)
+	if (!_spi->gpio_wait(_done_pin, true, 12000, 1000))
 		printError("FAIL");
 	else
 		printSuccess("DONE");
@@ -127,53 +127,53 @@ void JedParser::displayHeader()
 {
 	/* only lattice jed */
 	if (_has_feabits) {
-		printf("feabits :\n");
-		printf("%04x <-> %d\n", _feabits, _feabits);
+		printfInfo("feabits :\n");
+		printfInfo("%04x <-> %d\n", _feabits, _feabits);
 		/* 15-14: always 0 */
-		printf("\tBoot Mode       : ");
+		printfInfo("\tBoot Mode       : ");
 		switch ((_feabits>>11)&0x07) {
 		case 0:
-			printf("Single Boot from Configuration Flash\n");
+			printfInfo("Single Boot from Configuration Flash\n");
 			break;
 		case 1:
-			printf("Dual Boot from Configuration Flash then External if there is a failure\n");
+			printfInfo("Dual Boot from Configuration Flash then External if there is a failure\n");
 			break;
 		case 3:
-			printf("Single Boot from External Flash\n");
+			printfInfo("Single Boot from External Flash\n");
 			break;
 		default:
-			printf("Error\n");
+			printfInfo("Error\n");
 		}
 
-		printf("\tMaster Mode SPI : %s\n",
+		printfInfo("\tMaster Mode SPI : %s\n",
 			(((_feabits>>11)&0x01)?"enable":"disable"));
-		printf("\tI2c port        : %s\n",
+		printfInfo("\tI2c port        : %s\n",
 			(((_feabits>>10)&0x01)?"disable":"enable"));
-		printf("\tSlave SPI port  : %s\n",
+		printfInfo("\tSlave SPI port  : %s\n",
 			(((_feabits>>9)&0x01)?"disable":"enable"));
-		printf("\tJTAG port       : %s\n",
+		printfInfo("\tJTAG port       : %s\n",
 			(((_feabits>>8)&0x01)?"disable":"enable"));
-		printf("\tDONE            : %s\n",
+		printfInfo("\tDONE            : %s\n",
 			(((_feabits>>7)&0x01)?"enable":"disable"));
-		printf("\tINITN           : %s\n",
+		printfInfo("\tINITN           : %s\n",
 			(((_feabits>>6)&0x01)?"enable":"disable"));
-		printf("\tPROGRAMN        : %s\n",
+		printfInfo("\tPROGRAMN        : %s\n",
 			(((_feabits>>5)&0x01)?"disable":"enable"));
-		printf("\tMy_ASSP         : %s\n",
+		printfInfo("\tMy_ASSP         : %s\n",
 			(((_feabits>>4)&0x01)?"enable":"disable"));
 		/* 3-0: always 0 */
 	}
 
-	printf("Pin Count  : %d\n", _pin_count);
-	printf("Fuse Count : %d\n", _fuse_count);
+	printfInfo("Pin Count  : %d\n", _pin_count);
+	printfInfo("Fuse Count : %d\n", _fuse_count);
 
 	for (size_t i = 0; i < _data_list.size(); i++) {
-		printf("area[%zu] %4d %4d ", i, _data_list[i].offset, _data_list[i].len);
-		printf("%zu ", _data_list[i].data.size());
+		printfInfo("area[%zu] %4d %4d ", i, _data_list[i].offset, _data_list[i].len);
+		printfInfo("%zu ", _data_list[i].data.size());
 		for (size_t ii = 0; ii < _data_list[i].data.size(); ii++)
 			for (size_t iii = 0; iii < _data_list[i].data[ii].size(); iii++)
-				printf("%02x", (uint8_t)_data_list[i].data[ii][iii]);
-		printf(" %s\n", _data_list[i].associatedPrevNote.c_str());
+				printfInfo("%02x", (uint8_t)_data_list[i].data[ii][iii]);
+		printfInfo(" %s\n", _data_list[i].associatedPrevNote.c_str());
 		if (_data_list[i].offset == 2656)
 			break;
 	}
@@ -343,7 +343,7 @@ int JedParser::parse()
 			sscanf(lines[0].c_str() + 1, "%d", &_default_test_condition);
 			break;
 		default:
-			printf("inconnu\n");
+			printfInfo("inconnu\n");
 			cout << lines[0]<< endl;
 			return EXIT_FAILURE;
 		}
@@ -368,14 +368,14 @@ int JedParser::parse()
 				nullptr, 2));
 
 	if (_verbose)
-		printf("theorical checksum %x -> %x\n", _checksum, _compute_checksum);
+		printfInfo("theorical checksum %x -> %x\n", _checksum, _compute_checksum);
 	if (_checksum != _compute_checksum) {
 		printError("Error: wrong checksum");
 		return EXIT_FAILURE;
 	}
 
 	if (_verbose)
-		printf("array size %zd\n", _data_list[0].data.size());
+		printfInfo("array size %zd\n", _data_list[0].data.size());
 
 	if (_fuse_count != size) {
 		printError("Not all fuses are programmed");
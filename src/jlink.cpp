@@ -12,12 +12,15 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "bitOps.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 #define VID 0x1366
 #define PID 0x0105
@@ -52,7 +55,7 @@ Jlink::Jlink(uint32_t clkHz, int8_t verbose, int vid = VID, int pid = PID):_base
 	// search for all compatible devices
 	if (!jlink_scan_usb(vid,pid)) {
 		if (_verbose)
-			printf("vid:pid %04x:%04x\n", vid, pid);
+			printfInfo("vid:pid %04x:%04x\n", vid, pid);
 		throw std::runtime_error("can't find compatible device");
 	}
 
@@ -96,7 +99,7 @@ int Jlink::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 	if (len == 0)
 		return ((flush_buffer) ? flush() : 0);
 
-	for (uint32_t pos = 0; pos < len; pos++) {
+	for (uint32_t pos = 0; pos < len;) {
 		// buffer full -> write
 		if (_num_bits == BUF_SIZE * 8) {
 			// write
@@ -104,17 +107,13 @@ int Jlink::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 			_num_bits = 0;
 		}
 
-		_last_tms = (tms[pos >> 3] & (1 << (pos & 0x07))) ? 1 : 0;
-
-		if (_last_tms)
-			_tms[(_num_bits >> 3)] |= (1 << (_num_bits & 0x07));
-		else
-			_tms[(_num_bits >> 3)] &= ~(1 << (_num_bits & 0x07));
-		if (_last_tdi)
-			_tdi[(_num_bits >> 3)] |= (1 << (_num_bits & 0x07));
-		else
-			_tdi[(_num_bits >> 3)] &= ~(1 << (_num_bits & 0x07));
-		_num_bits++;
+		// copy as much bits as possible: TMS from sequence, TDI unchanged
+		uint32_t xfer = std::min(len - pos, BUF_SIZE * 8 - _num_bits);
+		bit_copy(_tms, _num_bits, tms, pos, xfer);
+		bit_fill(_tdi, _num_bits, xfer, _last_tdi);
+		pos += xfer;
+		_num_bits += xfer;
+		_last_tms = bit_get(tms, pos - 1);
 	}
 
 	// flush where it's asked or if the buffer is full
@@ -254,30 +253,30 @@ bool Jlink::ll_write(uint8_t *tdo)
 	memcpy(_xfer_buf + 4 + numbytes, _tdi, numbytes);
 
 	if (_debug) {
-		printf("Out       : %u\n", numbytes);
-		printf("cmd       : %02x\n", _xfer_buf[0]);
-		printf("dummy     : %02x\n", _xfer_buf[1]);
-		printf("bitlength : %02x %02x (%u)\n", _xfer_buf[2], _xfer_buf[3], _num_bits);
-		printf("tms       : ");
+		printfInfo("Out       : %u\n", numbytes);
+		printfInfo("cmd       : %02x\n", _xfer_buf[0]);
+		printfInfo("dummy     : %02x\n", _xfer_buf[1]);
+		printfInfo("bitlength : %02x %02x (%u)\n", _xfer_buf[2], _xfer_buf[3], _num_bits);
+		printfInfo("tms       : ");
 		if (numbytes > 16) {
-			printf("snip");
+			printfInfo("snip");
 		} else {
 			for (uint32_t i = 0; i < numbytes; i++)
-				printf("%02x ", _xfer_buf[i+4]);
+				printfInfo("%02x ", _xfer_buf[i+4]);
 		}
-		printf("\n");
-		printf("tdi       : ");
+		printfInfo("\n");
+		printfInfo("tdi       : ");
 		if (numbytes > 16) {
-			printf("snip");
+			printfInfo("snip");
 		} else {
 			for (uint32_t i = 0; i < numbytes; i++)
-				printf("%02x ", _xfer_buf[i+4+numbytes]);
+				printfInfo("%02x ", _xfer_buf[i+4+numbytes]);
 		}
-		printf("\n");
-		printf("buffer    : ");
+		printfInfo("\n");
+		printfInfo("buffer    : ");
 		for (uint32_t i = 0; i < 4 + (2 * numbytes); i++)
-			printf("%02x ", _xfer_buf[i]);
-		printf("\n");
+			printfInfo("%02x ", _xfer_buf[i]);
+		printfInfo("\n");
 	}
 
 	if (!write_device(_xfer_buf, 4 + (2 * numbytes))) {
@@ -307,16 +306,16 @@ bool Jlink::ll_write(uint8_t *tdo)
 		memcpy(tdo, rx_buf, numbytes);
 
 		if (_debug) {
-			printf("tdo       : ");
+			printfInfo("tdo       : ");
 			for (uint32_t i = 0; i < numbytes; i+=16) {
 				for (int ii = 0; ii < 16 && ((ii + i) < numbytes); ii++)
-					printf("%02x ", tdo[i+ii]);
-				printf("\n");
+					printfInfo("%02x ", tdo[i+ii]);
+				printfInfo("\n");
 			}
 		}
 	}
 	if (_debug)
-		printf("\n");
+		printfInfo("\n");
 
 	_num_bits = 0;  // clear counter
 
@@ -326,10 +325,10 @@ bool Jlink::ll_write(uint8_t *tdo)
 bool Jlink::cmd_read(uint8_t cmd, uint8_t *val, int size)
 {
 	int actual_length;
-	int ret = libusb_bulk_transfer(jlink_handle, jlink_write_ep,
+	int ret = stats_libusb_bulk_transfer(jlink_handle, jlink_write_ep,
 				&cmd, 1, &actual_length, 5000);
 	if (ret < 0) {
-		printf("Error write cmd_read %d %s %s\n", ret,
+		printfInfo("Error write cmd_read %d %s %s\n", ret,
 				libusb_error_name(ret),
 				libusb_strerror(static_cast<libusb_error>(ret)));
 		return false;
@@ -365,11 +364,11 @@ bool Jlink::cmd_write(uint8_t cmd, uint16_t param)
 						static_cast<uint8_t>((param >> 8) & 0xff)};
 
 	int actual_length;
-	int ret = libusb_bulk_transfer(jlink_handle, jlink_write_ep,
+	int ret = stats_libusb_bulk_transfer(jlink_handle, jlink_write_ep,
 				tx_buf, 3, &actual_length, 5000);
 	if (ret < 0) {
-		printf("Error write cmd_write %d\n", ret);
-		printf("%s %s\n", libusb_error_name(ret),
+		printfInfo("Error write cmd_write %d\n", ret);
+		printfInfo("%s %s\n", libusb_error_name(ret),
 				libusb_strerror(static_cast<libusb_error>(ret)));
 		return ret;
 	}
@@ -382,11 +381,11 @@ bool Jlink::cmd_write(uint8_t cmd, uint8_t param)
 	uint8_t tx_buf[2] = {cmd, param};
 
 	int actual_length;
-	int ret = libusb_bulk_transfer(jlink_handle, jlink_write_ep,
+	int ret = stats_libusb_bulk_transfer(jlink_handle, jlink_write_ep,
 				tx_buf, 2, &actual_length, 5000);
 	if (ret < 0) {
-		printf("Error write cmd_write %d\n", ret);
-		printf("%s %s\n", libusb_error_name(ret),
+		printfInfo("Error write cmd_write %d\n", ret);
+		printfInfo("%s %s\n", libusb_error_name(ret),
 				libusb_strerror(static_cast<libusb_error>(ret)));
 		return false;
 	}
@@ -401,7 +400,7 @@ int Jlink::read_device(uint8_t *buf, uint32_t size)
 	uint8_t *rx_ptr = buf;
 
 	do {
-		int ret = libusb_bulk_transfer(jlink_handle, jlink_read_ep,
+		int ret = stats_libusb_bulk_transfer(jlink_handle, jlink_read_ep,
 				rx_ptr, rest, &actual_length, 1000);
 		if (ret == 0) {
 			rx_ptr += actual_length;
@@ -431,7 +430,7 @@ bool Jlink::write_device(const uint8_t *buf, uint32_t size)
 	uint8_t *buf_ptr = (uint8_t*)buf;
 
 	do {
-		int ret = libusb_bulk_transfer(jlink_handle, jlink_write_ep,
+		int ret = stats_libusb_bulk_transfer(jlink_handle, jlink_write_ep,
 					(uint8_t *)buf_ptr, rest_size, &actual_length,
 					1000);
 		if (ret == 0) {
@@ -441,15 +440,15 @@ bool Jlink::write_device(const uint8_t *buf, uint32_t size)
 		} else if (ret == LIBUSB_ERROR_TIMEOUT) {
 			tries--;
 		} else {
-			printf("Error write %d\n", ret);
-			printf("%s %s\n", libusb_error_name(ret),
+			printfInfo("Error write %d\n", ret);
+			printfInfo("%s %s\n", libusb_error_name(ret),
 					libusb_strerror(static_cast<libusb_error>(ret)));
 			return false;
 		}
 	} while (tries > 0 && rest_size > 0);
 
 	if (tries == 0 && rest_size != 0) {
-		printf("error\n");
+		printfInfo("error\n");
 		return false;
 	}
 
@@ -468,8 +467,8 @@ string Jlink::get_version()
 int Jlink::get_hw_version()
 {
 	if (!(_caps & EMU_CAP_GET_HW_VERSION)) {
-		printf("get hw version is not supported\n");
-		printf("%u\n", _caps & EMU_CAP_GET_HW_VERSION);
+		printfInfo("get hw version is not supported\n");
+		printfInfo("%u\n", _caps & EMU_CAP_GET_HW_VERSION);
 		return 0;
 	}
 	uint32_t version;
@@ -482,7 +481,7 @@ int Jlink::get_hw_version()
     _revision = version % 100;
 
 	if (_debug)
-		printf("%08x ", version);
+		printfInfo("%08x ", version);
 	if (!_quiet) {
 		printInfo("device type: " + jlink_hw_type[_hw_type] + 
 				  " major: " + std::to_string(_major) +
@@ -501,11 +500,11 @@ void Jlink::get_speeds()
 
 	if (_debug) {
 		for (int i = 0; i < 6; i++)
-			printf("%02x ", _xfer_buf[i]);
-		printf("\n");
+			printfInfo("%02x ", _xfer_buf[i]);
+		printfInfo("\n");
 
-		printf("%02x %04x\n", _base_freq, _min_div);
-		printf("%u %u\n", _base_freq, _min_div);
+		printfInfo("%02x %04x\n", _base_freq, _min_div);
+		printfInfo("%u %u\n", _base_freq, _min_div);
 	}
 }
 
@@ -534,7 +533,7 @@ bool Jlink::set_speed(uint16_t freqHz)
 	uint16_t max_speed = _base_freq / _min_div;
 
 	if (freqKHz > max_speed) {
-		printf("max freq limited to %d\n", max_speed * 1000);
+		printfInfo("max freq limited to %d\n", max_speed * 1000);
 		freqKHz = max_speed;
 	}
 
@@ -547,10 +546,10 @@ bool Jlink::get_caps()
 		return false;
 
 	if (_verbose) {
-		printf("%04x\n", _caps);
+		printfInfo("%04x\n", _caps);
 		for (int i = 0; i < 32; i++) {
 			if ((_caps >> i) & 0x01)
-				printf("%2d %s\n", i, jlink_caps_flags[i].c_str());
+				printfInfo("%2d %s\n", i, jlink_caps_flags[i].c_str());
 		}
 	}
 
@@ -594,10 +593,10 @@ bool Jlink::set_interface(uint8_t interface)
 	write_device(buf, 2);
 	read_device(res, 4);
 	if (_debug) {
-		printf("set interface: ");
+		printfInfo("set interface: ");
 		for (int i = 0; i < 4; i++)
-			printf("%02x ", res[i]);
-		printf("\n");
+			printfInfo("%02x ", res[i]);
+		printfInfo("\n");
 	}
 	return true;
 }
@@ -608,17 +607,17 @@ void Jlink::read_config()
 	cmd_read(EMU_CMD_READ_CONFIG, reinterpret_cast<uint8_t*>(&cfg), 256);
 
 	if (_verbose) {
-		printf("usb_adr   : %02x\n", cfg.usb_adr);
-		printf("kickstart : %08x\n", cfg.kickstart);
-		printf("ip_address: %08x\n", cfg.ip_address);
-		printf("subnetmask: %08x\n", cfg.subnetmask);
-		printf("mac addr  : ");
+		printfInfo("usb_adr   : %02x\n", cfg.usb_adr);
+		printfInfo("kickstart : %08x\n", cfg.kickstart);
+		printfInfo("ip_address: %08x\n", cfg.ip_address);
+		printfInfo("subnetmask: %08x\n", cfg.subnetmask);
+		printfInfo("mac addr  : ");
 		for (int i = 0; i < 6; i++) {
-			printf("%02x", (uint8_t)cfg.mackaddr[i]);
+			printfInfo("%02x", (uint8_t)cfg.mackaddr[i]);
 			if (i < 5)
-				printf(":");
+				printfInfo(":");
 		}
-		printf("\n");
+		printfInfo("\n");
 	}
 }
 
@@ -634,7 +633,7 @@ bool Jlink::jlink_search_interface(libusb_device *dev,
 		struct libusb_config_descriptor *cfg;
 		int ret = libusb_get_config_descriptor(dev, cfg_idx, &cfg);
 		if (ret != 0) {
-			printf("Fail to retrieve config_descriptor \n");
+			printfInfo("Fail to retrieve config_descriptor \n");
 			return false;
 		}
 
@@ -645,7 +644,7 @@ bool Jlink::jlink_search_interface(libusb_device *dev,
 				uint8_t intfClass = intf->bInterfaceClass;
 				uint8_t intfSubClass = intf->bInterfaceSubClass;
 				if (_debug)
-					printf("intfClass: %x intfSubClass: %x\n", intfClass, intfSubClass);
+					printfInfo("intfClass: %x intfSubClass: %x\n", intfClass, intfSubClass);
 				if (intfClass == 0xff && intfSubClass == 0xff) {
 					if (found) {
 						printError("too many compatible interface");
@@ -658,7 +657,7 @@ bool Jlink::jlink_search_interface(libusb_device *dev,
 				}
 			}
 			if (_debug)
-				printf("%d\n", if_idx);
+				printfInfo("%d\n", if_idx);
 		}
 		libusb_free_config_descriptor(cfg);
 	}
@@ -692,7 +691,7 @@ bool Jlink::jlink_scan_usb(int vid, int pid)
 		}
 
 		if (_verbose)
-			printf("%04x:%04x (bus %d, device %2d)\n",
+			printfInfo("%04x:%04x (bus %d, device %2d)\n",
 				desc.idVendor, desc.idProduct,
 				libusb_get_bus_number(usb_dev),
 				libusb_get_device_address(usb_dev));
@@ -722,7 +721,7 @@ bool Jlink::jlink_scan_usb(int vid, int pid)
 
 	if (_debug) {
 		for (size_t d = 0; d < device_available.size(); d++)
-			printf("%x %x\n", device_available[d].if_idx,
+			printfInfo("%x %x\n", device_available[d].if_idx,
 					device_available[d].cfg_idx);
 	}
 
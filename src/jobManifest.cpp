@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "jobManifest.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "display.hpp"
+
+typedef struct {
+	std::string key;
+	std::string value;
+	bool is_bool;  /*!< value is "true" or "false" */
+} manifest_opt_t;
+
+typedef std::vector<manifest_opt_t> manifest_op_t;
+
+static std::string trim(const std::string &str)
+{
+	size_t start = str.find_first_not_of(" \t\r");
+	if (start == std::string::npos)
+		return "";
+	size_t end = str.find_last_not_of(" \t\r");
+	return str.substr(start, end - start + 1);
+}
+
+/* ---------------------------- */
+/*             JSON             */
+/* ---------------------------- */
+
+static void json_skip_ws(const std::string &s, size_t &pos)
+{
+	while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' ||
+			s[pos] == '\r' || s[pos] == '\n'))
+		pos++;
+}
+
+static bool json_string(const std::string &s, size_t &pos, std::string &out)
+{
+	if (pos >= s.size() || s[pos] != '"')
+		return false;
+	out.clear();
+	for (pos++; pos < s.size(); pos++) {
+		char c = s[pos];
+		if (c == '"') {
+			pos++;
+			return true;
+		}
+		if (c == '\\') {
+			if (++pos >= s.size())
+				return false;
+			switch (s[pos]) {
+			case 'n': c = '\n'; break;
+			case 't': c = '\t'; break;
+			case '"': case '\\': case '/': c = s[pos]; break;
+			default:
+				return false;
+			}
+		}
+		out += c;
+	}
+	return false;
+}
+
+/* string, number, true or false */
+static bool json_scalar(const std::string &s, size_t &pos, manifest_opt_t &opt)
+{
+	opt.is_bool = false;
+	if (pos < s.size() && s[pos] == '"')
+		return json_string(s, pos, opt.value);
+
+	size_t start = pos;
+	while (pos < s.size() &&
+			std::string(",}] \t\r\n").find(s[pos]) == std::string::npos)
+		pos++;
+	opt.value = s.substr(start, pos - start);
+	if (opt.value == "true" || opt.value == "false") {
+		opt.is_bool = true;
+		return true;
+	}
+	if (opt.value.empty())
+		return false;
+	/* numbers: decimal, hexadecimal, or with exponent */
+	return opt.value.find_first_not_of("0123456789abcdefABCDEFxX+-.") ==
+		std::string::npos;
+}
+
+/* expect c (after optional spaces) */
+static bool json_expect(const std::string &s, size_t &pos, char c)
+{
+	json_skip_ws(s, pos);
+	if (pos >= s.size() || s[pos] != c)
+		return false;
+	pos++;
+	return true;
+}
+
+/* c (after optional spaces) is consumed when present */
+static bool json_accept(const std::string &s, size_t &pos, char c)
+{
+	json_skip_ws(s, pos);
+	if (pos < s.size() && s[pos] == c) {
+		pos++;
+		return true;
+	}
+	return false;
+}
+
+/* flat object: {"key": scalar, ...} */
+static bool json_object(const std::string &s, size_t &pos, manifest_op_t &op)
+{
+	if (!json_expect(s, pos, '{'))
+		return false;
+	if (json_accept(s, pos, '}'))
+		return true;
+	do {
+		manifest_opt_t opt;
+		json_skip_ws(s, pos);
+		if (!json_string(s, pos, opt.key) || !json_expect(s, pos, ':'))
+			return false;
+		json_skip_ws(s, pos);
+		if (!json_scalar(s, pos, opt))
+			return false;
+		op.push_back(opt);
+	} while (json_accept(s, pos, ','));
+	return json_expect(s, pos, '}');
+}
+
+/* array of objects */
+static bool json_array(const std::string &s, size_t &pos,
+	std::vector<manifest_op_t> &ops)
+{
+	if (!json_expect(s, pos, '['))
+		return false;
+	if (json_accept(s, pos, ']'))
+		return true;
+	do {
+		manifest_op_t op;
+		if (!json_object(s, pos, op))
+			return false;
+		ops.push_back(op);
+	} while (json_accept(s, pos, ','));
+	return json_expect(s, pos, ']');
+}
+
+static bool json_parse(const std::string &s, std::vector<manifest_op_t> &ops)
+{
+	size_t pos = 0;
+	if (json_array(s, pos, ops)) {
+		json_skip_ws(s, pos);
+		if (pos == s.size())
+			return true;
+	}
+	printError("manifest: JSON syntax error at offset " + std::to_string(pos));
+	return false;
+}
+
+/* ---------------------------- */
+/*         YAML subset          */
+/* ---------------------------- */
+
+/* remove comment: '#' at line start or after a space, outside quotes */
+static std::string yaml_strip_comment(const std::string &line)
+{
+	char quote = 0;
+	for (size_t i = 0; i < line.size(); i++) {
+		char c = line[i];
+		if (quote) {
+			if (c == quote)
+				quote = 0;
+		} else if (c == '"' || c == '\'') {
+			quote = c;
+		} else if (c == '#' && (i == 0 || line[i - 1] == ' ' ||
+				line[i - 1] == '\t')) {
+			return line.substr(0, i);
+		}
+	}
+	return line;
+}
+
+static bool yaml_key_value(const std::string &str, manifest_opt_t &opt)
+{
+	size_t sep = str.find(':');
+	if (sep == std::string::npos)
+		return false;
+	opt.key = trim(str.substr(0, sep));
+	opt.value = trim(str.substr(sep + 1));
+	opt.is_bool = false;
+	if (opt.key.empty() || opt.value.empty())
+		return false;
+
+	char first = opt.value[0];
+	if (first == '"' || first == '\'') {
+		if (opt.value.size() < 2 || opt.value.back() != first)
+			return false;
+		opt.value = opt.value.substr(1, opt.value.size() - 2);
+	} else if (opt.value == "true" || opt.value == "false") {
+		opt.is_bool = true;
+	}
+	return true;
+}
+
+static bool yaml_parse(const std::string &s, std::vector<manifest_op_t> &ops)
+{
+	std::istringstream iss(s);
+	std::string line;
+	int lineno = 0;
+
+	while (std::getline(iss, line)) {
+		lineno++;
+		line = trim(yaml_strip_comment(line));
+		if (line.empty() || line == "---")
+			continue;
+
+		if (line[0] == '-' && (line.size() == 1 || line[1] == ' ')) {
+			/* new operation */
+			ops.push_back(manifest_op_t());
+			line = trim(line.substr(1));
+			if (line.empty())
+				continue;
+		} else if (ops.empty()) {
+			printError("manifest: line " + std::to_string(lineno) +
+				": operations must start with '- '");
+			return false;
+		}
+
+		manifest_opt_t opt;
+		if (!yaml_key_value(line, opt)) {
+			printError("manifest: line " + std::to_string(lineno) +
+				": expected 'key: value'");
+			return false;
+		}
+		ops.back().push_back(opt);
+	}
+	return true;
+}
+
+bool manifest_load(const std::string &filename,
+	std::vector<std::vector<std::string>> &ops)
+{
+	std::ifstream fd(filename);
+	if (!fd.is_open()) {
+		printError("manifest: can't open " + filename);
+		return false;
+	}
+	std::stringstream content;
+	content << fd.rdbuf();
+	std::string s = content.str();
+
+	std::vector<manifest_op_t> raw_ops;
+	size_t first = s.find_first_not_of(" \t\r\n");
+	bool ret;
+	if (first != std::string::npos && s[first] == '[')
+		ret = json_parse(s, raw_ops);
+	else
+		ret = yaml_parse(s, raw_ops);
+	if (!ret)
+		return false;
+
+	ops.clear();
+	for (const manifest_op_t &raw : raw_ops) {
+		std::vector<std::string> tokens;
+		for (const manifest_opt_t &opt : raw) {
+			if (opt.key == "bitstream") {
+				if (opt.is_bool) {
+					printError("manifest: bitstream must be a file name");
+					return false;
+				}
+				tokens.push_back(opt.value);
+				continue;
+			}
+			std::string name = ((opt.key.size() == 1) ? "-" : "--") + opt.key;
+			if (opt.is_bool) {
+				if (opt.value == "true")
+					tokens.push_back(name);
+			} else {
+				tokens.push_back(name);
+				tokens.push_back(opt.value);
+			}
+		}
+		ops.push_back(tokens);
+	}
+	return true;
+}
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_JOBMANIFEST_HPP_
+#define SRC_JOBMANIFEST_HPP_
+
+#include <string>
+#include <vector>
+
+/*!
+ * \file jobManifest.hpp
+ * \brief read a job manifest: an ordered list of operations, each one
+ *        being a set of long options (without leading "--").
+ *        Two syntaxes are accepted:
+ *        - JSON: array of flat objects
+ *          [{"index-chain": 1, "bitstream": "a.bit"}, ...]
+ *        - YAML subset: block sequence of flat mappings
+ *          - index-chain: 1
+ *            bitstream: a.bit
+ *        Values are strings, numbers or booleans. "bitstream" is the
+ *        positional argument, true adds the option alone, false drops it.
+ */
+
+/*!
+ * \brief read manifest and convert each operation to command line tokens
+ * \param[in] filename: manifest file
+ * \param[out] ops: one tokens list per operation (without argv[0])
+ * \return false when file can't be read or is invalid
+ */
+bool manifest_load(const std::string &filename,
+	std::vector<std::vector<std::string>> &ops);
+
+#endif  // SRC_JOBMANIFEST_HPP_
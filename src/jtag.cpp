@@ -3,7 +3,9 @@
  * Copyright (C) 2020 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
  */
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -13,6 +15,7 @@
 #include <string>
 
 #include "anlogicCable.hpp"
+#include "bitOps.hpp"
 #include "ch552_jtag.hpp"
 #include "display.hpp"
 #include "jtag.hpp"
@@ -30,11 +33,17 @@
 #endif
 #include "dirtyJtag.hpp"
 #include "ch347jtag.hpp"
+#include "jtagRecorder.hpp"
 #include "part.hpp"
 #ifdef ENABLE_REMOTEBITBANG
 #include "remoteBitbang_client.hpp"
 #endif
+#include "traceEvent.hpp"
+#include "transportStats.hpp"
 #include "usbBlaster.hpp"
+#ifdef ENABLE_VIRTUAL_JTAG
+#include "virtualJtag.hpp"
+#endif
 #ifdef ENABLE_XVC
 #include "xvc_client.hpp"
 #endif
@@ -43,9 +52,12 @@ using namespace std;
 
 #define DEBUG 0
 
+/* auto_freq: lowest frequency tried when searching downward */
+#define AUTO_FREQ_MIN 10000
+
 #if DEBUG
 #define display(...) \
-	do { if (_verbose) fprintf(stdout, __VA_ARGS__);}while(0)
+	do { if (_verbose) printfInfo(__VA_ARGS__);}while(0)
 #else
 #define display(...) do {}while(0)
 #endif
@@ -76,11 +88,13 @@ Jtag::Jtag(const cable_t &cable, const jtag_pins_conf_t *pin_conf,
 			const string &dev,
 			const string &serial, uint32_t clkHZ, int8_t verbose,
 			const string &ip_adr, int port,
-			const bool invert_read_edge, const string &firmware_path):
+			const bool invert_read_edge, const string &firmware_path,
+			const string &chain_cache):
 			_verbose(verbose > 1),
 			_state(RUN_TEST_IDLE),
 			_tms_buffer_size(128), _num_tms(0),
-			_board_name("nope"), device_index(0)
+			_board_name("nope"), device_index(0), _chain_cache(chain_cache),
+			_cached_freq(0), _recorder(NULL), _queue_scan(false)
 {
 	switch (cable.type) {
 	case MODE_ANLOGICCABLE:
@@ -140,6 +154,11 @@ Jtag::Jtag(const cable_t &cable, const jtag_pins_conf_t *pin_conf,
 	case MODE_REMOTEBITBANG:
 		_jtag = new RemoteBitbang_client(ip_adr, port, verbose);
 		break;
+#endif
+#ifdef ENABLE_VIRTUAL_JTAG
+	case MODE_VIRTUAL:
+		_jtag = new VirtualJtag(clkHZ, verbose);
+		break;
 #endif
 	default:
 		std::cerr << "Jtag: unknown cable type" << std::endl;
@@ -149,7 +168,18 @@ Jtag::Jtag(const cable_t &cable, const jtag_pins_conf_t *pin_conf,
 	_tms_buffer = (unsigned char *)malloc(sizeof(unsigned char) * _tms_buffer_size);
 	memset(_tms_buffer, 0, _tms_buffer_size);
 
-	detectChain(5);
+	/* chain cache is specific to a probe */
+	_cache_key = serial;
+	if (_cache_key.empty()) {
+		char key[16];
+		snprintf(key, sizeof(key), "%04x:%04x", cable.vid, cable.pid);
+		_cache_key = key;
+	}
+	if (chain_cache.empty() || !load_chain_cache(chain_cache, _cache_key)) {
+		detectChain(16);
+		if (!chain_cache.empty())
+			save_chain_cache(chain_cache, _cache_key);
+	}
 }
 
 Jtag::~Jtag()
@@ -157,91 +187,427 @@ Jtag::~Jtag()
 	free(_tms_buffer);
 	delete _jtag;
 }
+
+JtagInterface *Jtag::get_ll_class()
+{
+	return (_recorder) ? _recorder->get_ll_class() : _jtag;
+}
+
+bool Jtag::start_recording(const std::string &filename)
+{
+	if (_recorder)
+		return false;
+	flushTMS(true);
+	try {
+		_recorder = new JtagRecorder(_jtag, filename, _verbose);
+	} catch (std::exception &e) {
+		printError(e.what());
+		return false;
+	}
+	_jtag = _recorder;
+	return true;
+}
+
+bool Jtag::replay(const std::string &filename)
+{
+	flushTMS(true);
+	bool ret = JtagRecorder::replay(filename, _jtag, _verbose);
+	/* TAP state at the end of the session is unknown */
+	go_test_logic_reset();
+	return ret;
+}
 int Jtag::detectChain(int max_dev)
 {
+	TraceSpan span("detectChain", "phase");
 	char message[256];
-	unsigned char rx_buff[4];
-	/* WA for CH552/tangNano: write is always mandatory */
-	unsigned char tx_buff[4] = {0xff, 0xff, 0xff, 0xff};
-	unsigned int tmp;
+	std::vector<uint32_t> idcodes;
 
 	/* cleanup */
 	_devices_list.clear();
 	_irlength_list.clear();
+	_ir_cache.clear();
 
-	go_test_logic_reset();
-	set_state(SHIFT_DR);
+	if (scan_idcodes(max_dev, idcodes) < 0)
+		throw std::runtime_error("device without IDCODE in JTAG chain");
 
-	if (_verbose)
+	if (_verbose) {
 		printInfo("Raw IDCODE:");
-
-	for (int i = 0; i < max_dev; i++) {
-		read_write(tx_buff, rx_buff, 32, (i == max_dev-1)?1:0);
-		tmp = 0;
-		for (int ii=0; ii < 4; ii++)
-			tmp |= (rx_buff[ii] << (8*ii));
-
-		if (_verbose) {
-			snprintf(message, sizeof(message), "- %d -> 0x%08x", i, tmp);
+		for (size_t i = 0; i < idcodes.size(); i++) {
+			snprintf(message, sizeof(message), "- %zu -> 0x%08x", i,
+				idcodes[i]);
 			printInfo(message);
 		}
+	}
 
-		/* search IDCODE in fpga_list and misc_dev_list
-		 * since most device have idcode with high nibble masked
-		 * we start to search sub IDCODE
-		 * if IDCODE has no match: try the same with version unmasked
+	/* search IDCODE in fpga_list and misc_dev_list
+	 * since most device have idcode with high nibble masked
+	 * we start to search sub IDCODE
+	 * if IDCODE has no match: try the same with version unmasked
+	 */
+	std::vector<uint32_t> ids(idcodes.size());
+	std::vector<int> irlens(idcodes.size(), -1);
+	int nb_unknown = 0, known_irlen = 0, unknown = -1;
+	for (size_t i = 0; i < idcodes.size(); i++) {
+		uint32_t tmp = idcodes[i];
+		/* ckeck highest nibble to prevent confusion between Cologne Chip
+		 * GateMate and Efinix Trion T4/T8 devices
 		 */
-		if (tmp != 0 && tmp != 0xffffffff) {
-			bool found = false;
-			/* ckeck highest nibble to prevent confusion between Cologne Chip
-			 * GateMate and Efinix Trion T4/T8 devices
-			 */
-			if (tmp != 0x20000001)
-				found = search_and_insert_device_with_idcode(tmp & 0x0fffffff);
-			if (!found) /* if masked not found -> search for full */
-				found = search_and_insert_device_with_idcode(tmp);
-
-			if (!found) {
-				uint16_t mfg = IDCODE2MANUFACTURERID(tmp);
-				uint8_t part = IDCODE2PART(tmp);
-				uint8_t vers = IDCODE2VERS(tmp);
-
-				char error[1024];
-				snprintf(error, sizeof(error),
-						"Unknown device with IDCODE: 0x%08x"
-						" (manufacturer: 0x%03x (%s),"
-						" part: 0x%02x vers: 0x%x", tmp,
-						mfg, list_manufacturer[mfg].c_str(), part, vers);
-				throw std::runtime_error(error);
-			}
+		if (tmp != 0x20000001) {
+			ids[i] = tmp & 0x0fffffff;
+			irlens[i] = search_irlength(ids[i]);
+		}
+		if (irlens[i] == -1) { /* if masked not found -> search for full */
+			ids[i] = tmp;
+			irlens[i] = search_irlength(tmp);
+		}
+		if (irlens[i] == -1) {
+			nb_unknown++;
+			unknown = i;
+		} else {
+			known_irlen += irlens[i];
 		}
 	}
+
+	/* total IR length: used to check tables content and
+	 * to deduce irlength for one unknown device
+	 */
+	int total_irlen = (idcodes.size() != 0) ?
+		scan_irlength(32 * idcodes.size()) : 0;
+	if (nb_unknown == 1 && total_irlen > known_irlen) {
+		irlens[unknown] = total_irlen - known_irlen;
+		snprintf(message, sizeof(message),
+			"Unknown device with IDCODE: 0x%08x: irlength %d measured",
+			idcodes[unknown], irlens[unknown]);
+		printWarn(message);
+	} else if (nb_unknown != 0) {
+		uint32_t tmp = idcodes[unknown];
+		uint16_t mfg = IDCODE2MANUFACTURERID(tmp);
+		uint8_t part = IDCODE2PART(tmp);
+		uint8_t vers = IDCODE2VERS(tmp);
+
+		char error[1024];
+		snprintf(error, sizeof(error),
+				"Unknown device with IDCODE: 0x%08x"
+				" (manufacturer: 0x%03x (%s),"
+				" part: 0x%02x vers: 0x%x", tmp,
+				mfg, list_manufacturer[mfg].c_str(), part, vers);
+		throw std::runtime_error(error);
+	} else if (total_irlen > 0 && total_irlen != known_irlen) {
+		snprintf(message, sizeof(message),
+			"JTAG chain: measured IR length %d differs from expected %d",
+			total_irlen, known_irlen);
+		printWarn(message);
+	}
+
+	/* first IDCODE read is the device nearest TDO */
+	for (size_t i = 0; i < ids.size(); i++)
+		insert_first(ids[i], irlens[i]);
+
 	go_test_logic_reset();
 	flushTMS(true);
 	return _devices_list.size();
 }
 
-bool Jtag::search_and_insert_device_with_idcode(uint32_t idcode)
+int Jtag::scan_idcodes(int max_dev, std::vector<uint32_t> &idcodes)
 {
-	int irlength = -1;
-	auto dev = fpga_list.find(idcode);
-	if (dev != fpga_list.end())
-		irlength = dev->second.irlength;
-	if (irlength == -1) {
-		auto misc = misc_dev_list.find(idcode);
-		if (misc != misc_dev_list.end())
-			irlength = misc->second.irlength;
-	}
-	if (irlength == -1)
+	/* after TLR each device has IDCODE (32bits) in DR: read the full
+	 * chain, plus one IDCODE length, in one scan. TDI is forced to 1
+	 * (WA for CH552/tangNano: write is always mandatory): the end of
+	 * chain is reached when 0xffffffff is read
+	 */
+	int len = 32 * (max_dev + 1);
+	std::vector<uint8_t> tx(len / 8, 0xff), rx(len / 8, 0);
+
+	idcodes.clear();
+
+	go_test_logic_reset();
+	set_state(SHIFT_DR);
+	read_write(tx.data(), rx.data(), len, 1);
+	go_test_logic_reset();
+
+	for (int pos = 0; pos + 32 <= len && (int)idcodes.size() < max_dev;
+			pos += 32) {
+		uint32_t tmp = 0;
+		for (int ii = 0; ii < 4; ii++)
+			tmp |= ((uint32_t)rx[(pos >> 3) + ii] << (8 * ii));
+		if (tmp == 0xffffffff || tmp == 0)
+			break;
+		/* IDCODE LSB is always 1: 0 means 1bit BYPASS register */
+		if (!(tmp & 0x01))
+			return -1;
+		idcodes.push_back(tmp);
+	}
+	return idcodes.size();
+}
+
+int Jtag::scan_irlength(int max_len)
+{
+	/* fill IR chain with 0 then flood with 1: number of bits between
+	 * the end of 0 and the first 1 read is the IR chain length. IR
+	 * is left with all ones (BYPASS) for all devices
+	 */
+	int len = 2 * max_len;
+	std::vector<uint8_t> tx((len + 7) / 8, 0), rx((len + 7) / 8, 0);
+	for (int i = max_len; i < len; i++)
+		tx[i >> 3] |= 1 << (i & 0x07);
+
+	go_test_logic_reset();
+	set_state(SHIFT_IR);
+	read_write(tx.data(), rx.data(), len, 1);
+	go_test_logic_reset();
+
+	for (int i = max_len; i < len; i++) {
+		if (rx[i >> 3] & (1 << (i & 0x07)))
+			return i - max_len;
+	}
+	return -1;
+}
+
+bool Jtag::load_chain_cache(const string &filename, const string &key)
+{
+	ifstream fd(filename);
+	if (!fd.is_open())
+		return false;
+
+	/* first line: probe, next lines: idcode irlength (index 0 first) */
+	string line, cable;
+	if (!getline(fd, line))
+		return false;
+	istringstream hdr(line);
+	if (!(hdr >> line >> cable) || line != "cable" || cable != key)
 		return false;
 
-	return insert_first(idcode, irlength);
+	std::vector<uint32_t> ids;
+	std::vector<int16_t> irlens;
+	uint32_t freq = 0;
+	while (getline(fd, line)) {
+		istringstream ss(line);
+		string id;
+		int irlen;
+		if (!(ss >> id >> irlen))
+			continue;
+		/* frequency found by auto_freq */
+		if (id == "freq") {
+			freq = irlen;
+			continue;
+		}
+		try {
+			ids.push_back(stoul(id, nullptr, 16));
+		} catch (std::exception &e) {
+			return false;
+		}
+		irlens.push_back(irlen);
+	}
+	if (ids.empty())
+		return false;
+
+	/* confirm with one IDCODE scan: one more device is read to detect
+	 * a longer chain
+	 */
+	std::vector<uint32_t> idcodes;
+	if (scan_idcodes(ids.size() + 1, idcodes) != (int)ids.size())
+		return false;
+	for (size_t i = 0; i < ids.size(); i++) {
+		/* first IDCODE read is the device nearest TDO */
+		uint32_t tmp = idcodes[ids.size() - 1 - i];
+		if ((tmp & 0x0fffffff) != (ids[i] & 0x0fffffff))
+			return false;
+	}
+
+	_devices_list.clear();
+	_irlength_list.clear();
+	_ir_cache.clear();
+	for (size_t i = 0; i < ids.size(); i++) {
+		_devices_list.push_back(ids[i]);
+		_irlength_list.push_back(irlens[i]);
+		_ir_cache.push_back({false, {}});
+	}
+	_cached_freq = freq;
+	if (_verbose)
+		printInfo("JTAG chain loaded from " + filename);
+	flushTMS(true);
+	return true;
+}
+
+bool Jtag::save_chain_cache(const string &filename, const string &key)
+{
+	ofstream fd(filename);
+	if (!fd.is_open()) {
+		printWarn("Unable to write JTAG chain cache " + filename);
+		return false;
+	}
+	fd << "cable " << key << endl;
+	for (size_t i = 0; i < _devices_list.size(); i++) {
+		fd << "0x" << hex << setfill('0') << setw(8) <<
+			(uint32_t)_devices_list[i] << dec << " " <<
+			_irlength_list[i] << endl;
+	}
+	if (_cached_freq != 0)
+		fd << "freq " << _cached_freq << endl;
+	return true;
+}
+
+bool Jtag::check_loopback(int nb_iter)
+{
+	/* after TLR DR chain is the IDCODE of each device: a pattern
+	 * sent on TDI is read back after 32 * nb devices bits
+	 */
+	int nb_dev = _devices_list.size();
+	int chain_len = 32 * nb_dev;
+	int pattern_len = 256;
+	int len = chain_len + pattern_len;
+	std::vector<uint8_t> tx(len / 8), rx(len / 8);
+	uint32_t lfsr = 0x1234567 ^ static_cast<uint32_t>(nb_iter);
+
+	for (int iter = 0; iter < nb_iter; iter++) {
+		/* xorshift pseudo random pattern, then ones */
+		for (int i = 0; i < pattern_len / 8; i++) {
+			lfsr ^= lfsr << 13;
+			lfsr ^= lfsr >> 17;
+			lfsr ^= lfsr << 5;
+			tx[i] = static_cast<uint8_t>(lfsr);
+		}
+		memset(tx.data() + pattern_len / 8, 0xff, chain_len / 8);
+
+		go_test_logic_reset();
+		set_state(SHIFT_DR);
+		read_write(tx.data(), rx.data(), len, 1);
+		go_test_logic_reset();
+
+		/* first IDCODE read is the device nearest TDO */
+		for (int dev = 0; dev < nb_dev; dev++) {
+			uint32_t tmp = 0;
+			for (int ii = 0; ii < 4; ii++)
+				tmp |= ((uint32_t)rx[4 * dev + ii] << (8 * ii));
+			uint32_t idcode = _devices_list[nb_dev - 1 - dev];
+			if ((tmp & 0x0fffffff) != (idcode & 0x0fffffff))
+				return false;
+		}
+		if (memcmp(rx.data() + chain_len / 8, tx.data(), pattern_len / 8))
+			return false;
+	}
+	return true;
+}
+
+uint32_t Jtag::auto_freq(uint32_t max_freq)
+{
+	uint32_t start = getClkFreq();
+	char mess[256];
+
+	if (_devices_list.empty()) {
+		printError("auto freq: no device in JTAG chain");
+		return 0;
+	}
+
+	/* previous result for this probe and chain */
+	if (_cached_freq != 0) {
+		setClkFreq(_cached_freq);
+		if (check_loopback(16))
+			return getClkFreq();
+	}
+
+	/* converters clamp or round requested frequency: search bounds
+	 * are applied frequencies and an applied frequency already decided
+	 * by a bound is not tested again
+	 */
+	uint32_t best = 0;           /* highest applied frequency passing */
+	uint32_t fail = UINT32_MAX;  /* lowest applied frequency failing */
+	auto try_freq = [&](uint32_t freq) {
+		setClkFreq(freq);
+		uint32_t real = getClkFreq();
+		bool pass;
+		if (best != 0 && real <= best)
+			pass = true;
+		else if (real >= fail)
+			pass = false;
+		else
+			pass = check_loopback(8);
+		if (_verbose) {
+			snprintf(mess, sizeof(mess), "auto freq: %uHz (%uHz) %s",
+				freq, real, (pass) ? "OK" : "FAIL");
+			printInfo(mess);
+		}
+		if (pass)
+			best = std::max(best, real);
+		else
+			fail = std::min(fail, real);
+		return real;
+	};
+
+	/* highest achievable frequency first */
+	try_freq(max_freq);
+
+	/* then current frequency, halved while unstable */
+	for (uint32_t freq = start; best == 0 && freq >= AUTO_FREQ_MIN;)
+		freq = std::min(freq, try_freq(freq)) / 2;
+	if (best == 0) {
+		setClkFreq(start);
+		printError("auto freq: chain is not stable down to " +
+			std::to_string(AUTO_FREQ_MIN) + "Hz");
+		return 0;
+	}
+
+	/* binary search (5% resolution) between stable and failing applied
+	 * frequencies
+	 */
+	uint32_t lo = best, hi = fail;
+	while (fail != UINT32_MAX && fail > best + best / 20 && hi > lo + lo / 20) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (try_freq(mid) <= best)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	/* one step down the achievable frequencies: at least 5% below freq */
+	auto step_down = [&](uint32_t freq) {
+		uint32_t req = freq - freq / 20;
+		setClkFreq(req);
+		while (getClkFreq() >= freq && req > AUTO_FREQ_MIN) {
+			req -= req / 20;
+			setClkFreq(req);
+		}
+		if (getClkFreq() > freq)
+			setClkFreq(freq);
+		return getClkFreq();
+	};
+
+	/* safety margin: one step below highest stable frequency */
+	uint32_t freq = step_down(best);
+	while (!check_loopback(16)) {
+		uint32_t lower = step_down(freq);
+		if (lower >= freq) {
+			setClkFreq(start);
+			printError("auto freq: chain is not stable at " +
+				std::to_string(freq) + "Hz");
+			return 0;
+		}
+		freq = lower;
+	}
+
+	_cached_freq = freq;
+	if (!_chain_cache.empty())
+		save_chain_cache(_chain_cache, _cache_key);
+
+	return _cached_freq;
+}
+
+int Jtag::search_irlength(uint32_t idcode)
+{
+	auto dev = fpga_list.find(idcode);
+	if (dev != fpga_list.end() && dev->second.irlength != -1)
+		return dev->second.irlength;
+	auto misc = misc_dev_list.find(idcode);
+	if (misc != misc_dev_list.end())
+		return misc->second.irlength;
+	return -1;
 }
 
 bool Jtag::insert_first(uint32_t device_id, uint16_t irlength)
 {
 	_devices_list.insert(_devices_list.begin(), device_id);
 	_irlength_list.insert(_irlength_list.begin(), irlength);
+	_ir_cache.insert(_ir_cache.begin(), {false, {}});
 
 	return true;
 }
@@ -296,12 +662,18 @@ void Jtag::go_test_logic_reset()
 		setTMS(0x01);
 	flushTMS(false);
 	_state = TEST_LOGIC_RESET;
+	/* IR are reset to IDCODE/BYPASS */
+	invalidate_ir_cache();
 }
 
 int Jtag::read_write(unsigned char *tdi, unsigned char *tdo, int len, char last)
 {
+	/* IR content is no more known */
+	if (_state == SHIFT_IR)
+		invalidate_ir_cache();
 	flushTMS(false);
 	_jtag->writeTDI(tdi, tdo, len, last);
+	stats_bits(len);
 	if (last == 1)
 		_state = (_state == SHIFT_DR) ? EXIT1_DR : EXIT1_IR;
 	return 0;
@@ -317,12 +689,64 @@ void Jtag::toggleClk(int nb)
 	return;
 }
 
+void Jtag::delay(uint64_t ns, uint32_t min_clocks)
+{
+	unsigned char c = (TEST_LOGIC_RESET == _state) ? 1 : 0;
+	flushTMS(false);
+	if (_jtag->delay(c, ns, min_clocks) < 0)
+		throw std::exception();
+}
+
+int Jtag::shift_with_bypass(unsigned char *tdi, unsigned char *tdo, int len,
+		int bits_before, int bits_after, bool last)
+{
+	/* alone (or first and last) in the chain: no copy */
+	if (bits_before == 0 && bits_after == 0)
+		return read_write(tdi, tdo, len, last);
+
+	/* build one stream with bypass bits ('1') before and after payload
+	 * to have a single transaction for the full chain length
+	 */
+	int total = bits_before + len + bits_after;
+	int n = (total + 7) / 8;
+	_scan_tx.assign(n, 0xff);
+	if (tdi)
+		bit_copy(_scan_tx.data(), bits_before, tdi, 0, len);
+	else
+		bit_fill(_scan_tx.data(), bits_before, len, false);
+
+	uint8_t *rx = NULL;
+	if (tdo) {
+		/* queued scans: rx is read back at execute() */
+		if (_queue_scan) {
+			_queued_rx.push_back({std::vector<uint8_t>(n), tdo,
+				bits_before, len});
+			rx = _queued_rx.back().rx.data();
+		} else {
+			_scan_rx.resize(n);
+			rx = _scan_rx.data();
+		}
+	}
+
+	read_write(_scan_tx.data(), rx, total, last);
+
+	if (tdo && !_queue_scan)
+		extract_bits(rx, bits_before, tdo, len);
+	return 0;
+}
+
+void Jtag::extract_bits(const uint8_t *src, int offset, uint8_t *dst, int len)
+{
+	memset(dst, 0, (len + 7) / 8);
+	bit_copy(dst, 0, src, offset, len);
+}
+
 int Jtag::shiftDR(unsigned char *tdi, unsigned char *tdo, int drlen, int end_state)
 {
-	/* get number of devices in the JTAG chain
-	 * after the selected one
+	/* get number of devices, in the JTAG chain,
+	 * before the selected one (only sent when entering SHIFT_DR)
 	 */
-	int bits_after = device_index;
+	int bits_before = 0;
 
 	/* if current state not shift DR
 	 * move to this state
@@ -330,46 +754,65 @@ int Jtag::shiftDR(unsigned char *tdi, unsigned char *tdo, int drlen, int end_sta
 	if (_state != SHIFT_DR) {
 		set_state(SHIFT_DR);
 		flushTMS(false);  // force transmit tms state
-
-		/* get number of devices, in the JTAG chain,
-		 * before the selected one
-		 */
-		int bits_before = _devices_list.size() - device_index - 1;
-
-		/* if not 0 send enough bits
-		 */
-		if (bits_before > 0) {
-			int n = (bits_before + 7) / 8;
-			uint8_t tx[n];
-			memset(tx, 0xff, n);
-			read_write(tx, NULL, bits_before, 0);
-		}
+		bits_before = _devices_list.size() - device_index - 1;
+		if (bits_before < 0)
+			bits_before = 0;
 	}
 
-	/* write tdi (and read tdo) to the selected device
-	 * end (ie TMS high) is used only when current device
-	 * is the last of the chain and a state change must
-	 * be done
+	/* get number of devices in the JTAG chain
+	 * after the selected one (only sent when leaving SHIFT_DR)
 	 */
-	read_write(tdi, tdo, drlen, bits_after == 0 && end_state != SHIFT_DR);
+	int bits_after = (end_state != SHIFT_DR) ? device_index : 0;
 
-	/* if it's asked to move in FSM */
-	if (end_state != SHIFT_DR) {
-		/* if current device is not the last */
-		if (bits_after > 0) {
-			int n = (bits_after + 7) / 8;
-			uint8_t tx[n];
-			memset(tx, 0xff, n);
-			read_write(tx, NULL, bits_after, 1);  // its the last force
-			                                      // tms high with last bit
-		}
+	/* write tdi (and read tdo) to the selected device with bypass
+	 * bits. end (ie TMS high) is used with the last bit only when
+	 * a state change must be done
+	 */
+	shift_with_bypass(tdi, tdo, drlen, bits_before, bits_after,
+		end_state != SHIFT_DR);
 
-		/* move to end_state */
+	/* if it's asked to move in FSM */
+	if (end_state != SHIFT_DR)
 		set_state(end_state);
-	}
 	return 0;
 }
 
+int Jtag::queue_shiftDR(unsigned char *tdi, unsigned char *tdo, int drlen,
+		int end_state)
+{
+	/* converters without deferred mode read synchronously */
+	bool deferred = (tdo != NULL) && _jtag->setDeferredRead(true);
+	_queue_scan = true;
+	int ret = shiftDR(tdi, tdo, drlen, end_state);
+	_queue_scan = false;
+	if (deferred)
+		_jtag->setDeferredRead(false);
+	return ret;
+}
+
+int Jtag::queue_shiftIR(unsigned char *tdi, unsigned char *tdo, int irlen,
+		int end_state)
+{
+	bool deferred = (tdo != NULL) && _jtag->setDeferredRead(true);
+	_queue_scan = true;
+	int ret = shiftIR(tdi, tdo, irlen, end_state);
+	_queue_scan = false;
+	if (deferred)
+		_jtag->setDeferredRead(false);
+	return ret;
+}
+
+int Jtag::execute()
+{
+	flushTMS(false);
+	int ret = _jtag->flushDeferred();
+	/* scans with bypass bits: extract payload */
+	for (auto &q : _queued_rx)
+		extract_bits(q.rx.data(), q.offset, q.tdo, q.len);
+	_queued_rx.clear();
+	return ret;
+}
+
 int Jtag::shiftIR(unsigned char tdi, int irlen, int end_state)
 {
 	if (irlen > 8) {
@@ -379,9 +822,77 @@ int Jtag::shiftIR(unsigned char tdi, int irlen, int end_state)
 	return shiftIR(&tdi, NULL, irlen, end_state);
 }
 
+/* true when a scan ending in end_state goes through UPDATE_IR
+ * without entering again in IR column
+ */
+static bool ir_is_updated(int end_state)
+{
+	return end_state == Jtag::RUN_TEST_IDLE || end_state == Jtag::UPDATE_IR ||
+		(end_state >= Jtag::SELECT_DR_SCAN && end_state <= Jtag::UPDATE_DR);
+}
+
+int Jtag::shiftIR_cached(unsigned char *tdi, int irlen, int end_state)
+{
+	/* a partial scan can't be skipped */
+	if (_state == SHIFT_IR || !ir_is_updated(end_state) || tdi == NULL ||
+			device_index >= (int)_ir_cache.size())
+		return shiftIR(tdi, NULL, irlen, end_state);
+
+	const ir_cache_t &ir = _ir_cache[device_index];
+	int n = (irlen + 7) / 8;
+	bool hit = ir.valid && (int)ir.value.size() == n;
+	for (int i = 0; hit && i < n; i++) {
+		uint8_t mask = (i == n - 1 && (irlen & 0x07)) ?
+			(1 << (irlen & 0x07)) - 1 : 0xff;
+		hit = ir.value[i] == (tdi[i] & mask);
+	}
+	if (!hit)
+		return shiftIR(tdi, NULL, irlen, end_state);
+
+	/* instruction already loaded: only move to the requested state.
+	 * IR column can't be used (CAPTURE_IR/UPDATE_IR reload IR) but
+	 * RUN_TEST_IDLE and UPDATE_xR are equivalent before a DR scan
+	 */
+	if (end_state != UPDATE_IR)
+		set_state(end_state);
+	else if (_state != RUN_TEST_IDLE && _state != UPDATE_DR &&
+			_state != UPDATE_IR)
+		set_state(UPDATE_DR);
+	return 0;
+}
+
+void Jtag::invalidate_ir_cache()
+{
+	for (auto &ir : _ir_cache)
+		ir.valid = false;
+}
+
+void Jtag::update_ir_cache(const unsigned char *tdi, int irlen)
+{
+	for (size_t dev = 0; dev < _ir_cache.size(); dev++) {
+		ir_cache_t &ir = _ir_cache[dev];
+		int len = ((int)dev == device_index) ? irlen : _irlength_list[dev];
+		int n = (len + 7) / 8;
+		ir.value.assign(n, 0xff);  // bypass: all ones
+		if ((int)dev == device_index) {
+			if (tdi == NULL) {
+				ir.valid = false;
+				continue;
+			}
+			for (int i = 0; i < n; i++)
+				ir.value[i] = tdi[i];
+		}
+		if (len & 0x07)
+			ir.value[n - 1] &= (1 << (len & 0x07)) - 1;
+		ir.valid = true;
+	}
+}
+
 int Jtag::shiftIR(unsigned char *tdi, unsigned char *tdo, int irlen, int end_state)
 {
 	display("%s: avant shiftIR\n", __func__);
+	/* only a full and updated scan gives a known IR content */
+	bool full_scan = (_state != SHIFT_IR) && ir_is_updated(end_state);
 	int bypass_after = 0;
 	if (end_state != SHIFT_IR) {
 		/* when the device is not alone and not
@@ -393,244 +904,318 @@ int Jtag::shiftIR(unsigned char *tdi, unsigned char *tdo, int irlen, int end_sta
 	}
 
 	/* if not in SHIFT IR move to this state */
+	int bypass_before = 0;
 	if (_state != SHIFT_IR) {
 		set_state(SHIFT_IR);
 		/* force flush */
 		flushTMS(false);
 
-		/* send serie of bypass instructions
+		/* serie of bypass instructions
 		 * final size depends on number of device
 		 * before targeted and irlength of each one
 		 */
-		int bypass_before = 0;
 		for (unsigned int i = device_index + 1; i < _devices_list.size(); i++)
 			bypass_before += _irlength_list[i];
-
-		/* if > 0 send bits */
-		if (bypass_before > 0) {
-			int n = (bypass_before + 7) / 8;
-			uint8_t tx[n];
-			memset(tx, 0xff, n);
-			read_write(tx, NULL, bypass_before, 0);
-		}
 	}
 
 	display("%s: envoi ircode\n", __func__);
 
-	/* write tdi (and read tdo) to the selected device
-	 * end (ie TMS high) is used only when current device
-	 * is the last of the chain and a state change must
-	 * be done
+	/* write tdi (and read tdo) to the selected device with bypass
+	 * instructions. end (ie TMS high) is used with the last bit only
+	 * when a state change must be done
 	 */
-	read_write(tdi, tdo, irlen, bypass_after == 0 && end_state != SHIFT_IR);
+	shift_with_bypass(tdi, tdo, irlen, bypass_before, bypass_after,
+		end_state != SHIFT_IR);
 
 	/* it's asked to move out of SHIFT IR state */
-	if (end_state != SHIFT_IR) {
-		/* again if devices after fill '1' */
-		if (bypass_after > 0) {
-			int n = (bypass_after + 7) / 8;
-			uint8_t tx[n];
-			memset(tx, 0xff, n);
-			read_write(tx, NULL, bypass_after, 1);
-		}
-		/* move to the requested state */
+	if (end_state != SHIFT_IR)
 		set_state(end_state);
+
+	if (full_scan)
+		update_ir_cache(tdi, irlen);
+	else
+		invalidate_ir_cache();
+
+	return 0;
+}
+
+int Jtag::shiftIR_broadcast(const std::vector<int> &devices,
+		unsigned char *tdi, int irlen, int end_state)
+{
+	int nb_dev = _devices_list.size();
+	std::vector<bool> selected(nb_dev, false);
+	for (int dev : devices) {
+		if (dev < 0 || dev >= nb_dev || _irlength_list[dev] != irlen) {
+			printError("shiftIR_broadcast: wrong device index or irlength");
+			return -1;
+		}
+		selected[dev] = true;
+	}
+	if (end_state == SHIFT_IR) {
+		printError("shiftIR_broadcast: SHIFT_IR end state not supported");
+		return -1;
+	}
+
+	/* full IR chain: last device (nearest TDO) first, BYPASS (all ones)
+	 * for unselected devices
+	 */
+	int total = 0;
+	for (int i = 0; i < nb_dev; i++)
+		total += _irlength_list[i];
+	_scan_tx.assign((total + 7) / 8, 0xff);
+	int pos = 0;
+	for (int dev = nb_dev - 1; dev >= 0; dev--) {
+		int len = _irlength_list[dev];
+		if (selected[dev])
+			bit_copy(_scan_tx.data(), pos, tdi, 0, len);
+		pos += len;
 	}
 
+	if (_state != SHIFT_IR) {
+		set_state(SHIFT_IR);
+		flushTMS(false);
+	}
+	read_write(_scan_tx.data(), NULL, total, 1);
+	set_state(end_state);
+
+	/* selected device may be one of the list: unknown content */
+	invalidate_ir_cache();
+
 	return 0;
 }
 
-void Jtag::set_state(int newState)
+int Jtag::shiftDR_broadcast(const std::vector<int> &devices, int dev_drlen,
+		unsigned char *tdi, int drlen, int end_state)
 {
-	unsigned char tms = 0;
-	while (newState != _state) {
-		display("_state : %16s(%02d) -> %s(%02d) ",
-			getStateName((tapState_t)_state),
-			_state,
-			getStateName((tapState_t)newState), newState);
-		switch (_state) {
-		case TEST_LOGIC_RESET:
-			if (newState == TEST_LOGIC_RESET) {
-				tms = 1;
-			} else {
-				tms = 0;
-				_state = RUN_TEST_IDLE;
-			}
-			break;
-		case RUN_TEST_IDLE:
-			if (newState == RUN_TEST_IDLE) {
-				tms = 0;
-			} else {
-				tms = 1;
-				_state = SELECT_DR_SCAN;
-			}
-			break;
-		case SELECT_DR_SCAN:
-			switch (newState) {
-			case CAPTURE_DR:
-			case SHIFT_DR:
-			case EXIT1_DR:
-			case PAUSE_DR:
-			case EXIT2_DR:
-			case UPDATE_DR:
-				tms = 0;
-				_state = CAPTURE_DR;
-				break;
-			default:
-				tms = 1;
-				_state = SELECT_IR_SCAN;
-			}
-			break;
-		case SELECT_IR_SCAN:
-			switch (newState) {
-			case CAPTURE_IR:
-			case SHIFT_IR:
-			case EXIT1_IR:
-			case PAUSE_IR:
-			case EXIT2_IR:
-			case UPDATE_IR:
-				tms = 0;
-				_state = CAPTURE_IR;
-				break;
-			default:
-				tms = 1;
-				_state = TEST_LOGIC_RESET;
-			}
-			break;
-			/* DR column */
-		case CAPTURE_DR:
-			if (newState == SHIFT_DR) {
-				tms = 0;
-				_state = SHIFT_DR;
-			} else {
-				tms = 1;
-				_state = EXIT1_DR;
-			}
-			break;
-		case SHIFT_DR:
-			if (newState == SHIFT_DR) {
-				tms = 0;
-			} else {
-				tms = 1;
-				_state = EXIT1_DR;
-			}
-			break;
-		case EXIT1_DR:
-			switch (newState) {
-			case PAUSE_DR:
-			case EXIT2_DR:
-			case SHIFT_DR:
-			case EXIT1_DR:
-				tms = 0;
-				_state = PAUSE_DR;
-				break;
-			default:
-				tms = 1;
-				_state = UPDATE_DR;
-			}
-			break;
-		case PAUSE_DR:
-			if (newState == PAUSE_DR) {
-				tms = 0;
-			} else {
-				tms = 1;
-				_state = EXIT2_DR;
-			}
-			break;
-		case EXIT2_DR:
-			switch (newState) {
-			case SHIFT_DR:
-			case EXIT1_DR:
-			case PAUSE_DR:
-				tms = 0;
-				_state = SHIFT_DR;
-				break;
-			default:
-				tms = 1;
-				_state = UPDATE_DR;
-			}
-			break;
-		case UPDATE_DR:
-			if (newState == RUN_TEST_IDLE) {
-				tms = 0;
-				_state = RUN_TEST_IDLE;
-			} else {
-				tms = 1;
-				_state = SELECT_DR_SCAN;
-			}
-			break;
-			/* IR column */
-		case CAPTURE_IR:
-			if (newState == SHIFT_IR) {
-				tms = 0;
-				_state = SHIFT_IR;
-			} else {
-				tms = 1;
-				_state = EXIT1_IR;
-			}
-			break;
-		case SHIFT_IR:
-			if (newState == SHIFT_IR) {
-				tms = 0;
-			} else {
-				tms = 1;
-				_state = EXIT1_IR;
-			}
-			break;
-		case EXIT1_IR:
-			switch (newState) {
-			case PAUSE_IR:
-			case EXIT2_IR:
-			case SHIFT_IR:
-			case EXIT1_IR:
-				tms = 0;
-				_state = PAUSE_IR;
-				break;
-			default:
-				tms = 1;
-				_state = UPDATE_IR;
-			}
-			break;
-		case PAUSE_IR:
-			if (newState == PAUSE_IR) {
-				tms = 0;
-			} else {
-				tms = 1;
-				_state = EXIT2_IR;
-			}
-			break;
-		case EXIT2_IR:
-			switch (newState) {
-			case SHIFT_IR:
-			case EXIT1_IR:
-			case PAUSE_IR:
-				tms = 0;
-				_state = SHIFT_IR;
-				break;
-			default:
-				tms = 1;
-				_state = UPDATE_IR;
-			}
-			break;
-		case UPDATE_IR:
-			if (newState == RUN_TEST_IDLE) {
-				tms = 0;
-				_state = RUN_TEST_IDLE;
-			} else {
-				tms = 1;
-				_state = SELECT_DR_SCAN;
+	int nb_dev = _devices_list.size();
+	std::vector<bool> selected(nb_dev, false);
+	int last_dev = -1;  // selected device nearest TDO
+	for (int dev : devices) {
+		if (dev < 0 || dev >= nb_dev) {
+			printError("shiftDR_broadcast: wrong device index");
+			return -1;
+		}
+		selected[dev] = true;
+		if (dev > last_dev)
+			last_dev = dev;
+	}
+	if (last_dev == -1)
+		return -1;
+
+	/* devices after the farthest selected one are in BYPASS:
+	 * only sent when entering SHIFT_DR (same as shiftDR)
+	 */
+	int bits_before = 0;
+	if (_state != SHIFT_DR) {
+		set_state(SHIFT_DR);
+		flushTMS(false);
+		bits_before = nb_dev - last_dev - 1;
+	}
+
+	/* when leaving SHIFT_DR stream must be pushed until the farthest
+	 * device: one bit by bypassed device, dev_drlen bits by selected
+	 * device between TDI and the farthest
+	 */
+	int bits_after = 0;
+	if (end_state != SHIFT_DR) {
+		for (int i = 0; i < last_dev; i++)
+			bits_after += (selected[i]) ? dev_drlen : 1;
+	}
+
+	shift_with_bypass(tdi, NULL, drlen, bits_before, bits_after,
+		end_state != SHIFT_DR);
+
+	if (end_state != SHIFT_DR)
+		set_state(end_state);
+	return 0;
+}
+
+/* TAP state machine (IEEE 1149.1): state reached from a given state
+ * with TMS low (index 0) or TMS high (index 1)
+ */
+static const uint8_t tap_next_state[16][2] = {
+	{Jtag::RUN_TEST_IDLE, Jtag::TEST_LOGIC_RESET}, /* TEST_LOGIC_RESET */
+	{Jtag::RUN_TEST_IDLE, Jtag::SELECT_DR_SCAN  }, /* RUN_TEST_IDLE */
+	{Jtag::CAPTURE_DR,    Jtag::SELECT_IR_SCAN  }, /* SELECT_DR_SCAN */
+	{Jtag::SHIFT_DR,      Jtag::EXIT1_DR        }, /* CAPTURE_DR */
+	{Jtag::SHIFT_DR,      Jtag::EXIT1_DR        }, /* SHIFT_DR */
+	{Jtag::PAUSE_DR,      Jtag::UPDATE_DR       }, /* EXIT1_DR */
+	{Jtag::PAUSE_DR,      Jtag::EXIT2_DR        }, /* PAUSE_DR */
+	{Jtag::SHIFT_DR,      Jtag::UPDATE_DR       }, /* EXIT2_DR */
+	{Jtag::RUN_TEST_IDLE, Jtag::SELECT_DR_SCAN  }, /* UPDATE_DR */
+	{Jtag::CAPTURE_IR,    Jtag::TEST_LOGIC_RESET}, /* SELECT_IR_SCAN */
+	{Jtag::SHIFT_IR,      Jtag::EXIT1_IR        }, /* CAPTURE_IR */
+	{Jtag::SHIFT_IR,      Jtag::EXIT1_IR        }, /* SHIFT_IR */
+	{Jtag::PAUSE_IR,      Jtag::UPDATE_IR       }, /* EXIT1_IR */
+	{Jtag::PAUSE_IR,      Jtag::EXIT2_IR        }, /* PAUSE_IR */
+	{Jtag::SHIFT_IR,      Jtag::UPDATE_IR       }, /* EXIT2_IR */
+	{Jtag::RUN_TEST_IDLE, Jtag::SELECT_DR_SCAN  }, /* UPDATE_IR */
+};
+
+/* shortest TMS sequence (LSB first) and length to move from
+ * one state (first index) to another (second index)
+ */
+typedef struct {
+	uint8_t tms;
+	uint8_t len;
+} tap_path_t;
+
+static constexpr tap_path_t tap_path[16][16] = {
+	/* TEST_LOGIC_RESET */
+	{{0x00, 0}, {0x00, 1}, {0x02, 2}, {0x02, 3},
+	 {0x02, 4}, {0x0a, 4}, {0x0a, 5}, {0x2a, 6},
+	 {0x1a, 5}, {0x06, 3}, {0x06, 4}, {0x06, 5},
+	 {0x16, 5}, {0x16, 6}, {0x56, 7}, {0x36, 6}},
+	/* RUN_TEST_IDLE */
+	{{0x07, 3}, {0x00, 0}, {0x01, 1}, {0x01, 2},
+	 {0x01, 3}, {0x05, 3}, {0x05, 4}, {0x15, 5},
+	 {0x0d, 4}, {0x03, 2}, {0x03, 3}, {0x03, 4},
+	 {0x0b, 4}, {0x0b, 5}, {0x2b, 6}, {0x1b, 5}},
+	/* SELECT_DR_SCAN */
+	{{0x03, 2}, {0x03, 3}, {0x00, 0}, {0x00, 1},
+	 {0x00, 2}, {0x02, 2}, {0x02, 3}, {0x0a, 4},
+	 {0x06, 3}, {0x01, 1}, {0x01, 2}, {0x01, 3},
+	 {0x05, 3}, {0x05, 4}, {0x15, 5}, {0x0d, 4}},
+	/* CAPTURE_DR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x00, 0},
+	 {0x00, 1}, {0x01, 1}, {0x01, 2}, {0x05, 3},
+	 {0x03, 2}, {0x0f, 4}, {0x0f, 5}, {0x0f, 6},
+	 {0x2f, 6}, {0x2f, 7}, {0xaf, 8}, {0x6f, 7}},
+	/* SHIFT_DR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x07, 4},
+	 {0x00, 0}, {0x01, 1}, {0x01, 2}, {0x05, 3},
+	 {0x03, 2}, {0x0f, 4}, {0x0f, 5}, {0x0f, 6},
+	 {0x2f, 6}, {0x2f, 7}, {0xaf, 8}, {0x6f, 7}},
+	/* EXIT1_DR */
+	{{0x0f, 4}, {0x01, 2}, {0x03, 2}, {0x03, 3},
+	 {0x02, 3}, {0x00, 0}, {0x00, 1}, {0x02, 2},
+	 {0x01, 1}, {0x07, 3}, {0x07, 4}, {0x07, 5},
+	 {0x17, 5}, {0x17, 6}, {0x57, 7}, {0x37, 6}},
+	/* PAUSE_DR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x07, 4},
+	 {0x01, 2}, {0x05, 3}, {0x00, 0}, {0x01, 1},
+	 {0x03, 2}, {0x0f, 4}, {0x0f, 5}, {0x0f, 6},
+	 {0x2f, 6}, {0x2f, 7}, {0xaf, 8}, {0x6f, 7}},
+	/* EXIT2_DR */
+	{{0x0f, 4}, {0x01, 2}, {0x03, 2}, {0x03, 3},
+	 {0x00, 1}, {0x02, 2}, {0x02, 3}, {0x00, 0},
+	 {0x01, 1}, {0x07, 3}, {0x07, 4}, {0x07, 5},
+	 {0x17, 5}, {0x17, 6}, {0x57, 7}, {0x37, 6}},
+	/* UPDATE_DR */
+	{{0x07, 3}, {0x00, 1}, {0x01, 1}, {0x01, 2},
+	 {0x01, 3}, {0x05, 3}, {0x05, 4}, {0x15, 5},
+	 {0x00, 0}, {0x03, 2}, {0x03, 3}, {0x03, 4},
+	 {0x0b, 4}, {0x0b, 5}, {0x2b, 6}, {0x1b, 5}},
+	/* SELECT_IR_SCAN */
+	{{0x01, 1}, {0x01, 2}, {0x05, 3}, {0x05, 4},
+	 {0x05, 5}, {0x15, 5}, {0x15, 6}, {0x55, 7},
+	 {0x35, 6}, {0x00, 0}, {0x00, 1}, {0x00, 2},
+	 {0x02, 2}, {0x02, 3}, {0x0a, 4}, {0x06, 3}},
+	/* CAPTURE_IR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x07, 4},
+	 {0x07, 5}, {0x17, 5}, {0x17, 6}, {0x57, 7},
+	 {0x37, 6}, {0x0f, 4}, {0x00, 0}, {0x00, 1},
+	 {0x01, 1}, {0x01, 2}, {0x05, 3}, {0x03, 2}},
+	/* SHIFT_IR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x07, 4},
+	 {0x07, 5}, {0x17, 5}, {0x17, 6}, {0x57, 7},
+	 {0x37, 6}, {0x0f, 4}, {0x0f, 5}, {0x00, 0},
+	 {0x01, 1}, {0x01, 2}, {0x05, 3}, {0x03, 2}},
+	/* EXIT1_IR */
+	{{0x0f, 4}, {0x01, 2}, {0x03, 2}, {0x03, 3},
+	 {0x03, 4}, {0x0b, 4}, {0x0b, 5}, {0x2b, 6},
+	 {0x1b, 5}, {0x07, 3}, {0x07, 4}, {0x02, 3},
+	 {0x00, 0}, {0x00, 1}, {0x02, 2}, {0x01, 1}},
+	/* PAUSE_IR */
+	{{0x1f, 5}, {0x03, 3}, {0x07, 3}, {0x07, 4},
+	 {0x07, 5}, {0x17, 5}, {0x17, 6}, {0x57, 7},
+	 {0x37, 6}, {0x0f, 4}, {0x0f, 5}, {0x01, 2},
+	 {0x05, 3}, {0x00, 0}, {0x01, 1}, {0x03, 2}},
+	/* EXIT2_IR */
+	{{0x0f, 4}, {0x01, 2}, {0x03, 2}, {0x03, 3},
+	 {0x03, 4}, {0x0b, 4}, {0x0b, 5}, {0x2b, 6},
+	 {0x1b, 5}, {0x07, 3}, {0x07, 4}, {0x00, 1},
+	 {0x02, 2}, {0x02, 3}, {0x00, 0}, {0x01, 1}},
+	/* UPDATE_IR */
+	{{0x07, 3}, {0x00, 1}, {0x01, 1}, {0x01, 2},
+	 {0x01, 3}, {0x05, 3}, {0x05, 4}, {0x15, 5},
+	 {0x0d, 4}, {0x03, 2}, {0x03, 3}, {0x03, 4},
+	 {0x0b, 4}, {0x0b, 5}, {0x2b, 6}, {0x00, 0}},
+};
+
+/* state reached from a given state after 8 TMS bits (LSB first):
+ * built once from tap_next_state to advance the state a byte at a time
+ */
+struct tap_byte_table_t {
+	uint8_t next[16][256];
+	tap_byte_table_t() {
+		for (int state = 0; state < 16; state++) {
+			for (int tms = 0; tms < 256; tms++) {
+				uint8_t s = state;
+				for (int i = 0; i < 8; i++)
+					s = tap_next_state[s][(tms >> i) & 0x01];
+				next[state][tms] = s;
 			}
-			break;
 		}
+	}
+};
+static const tap_byte_table_t tap_byte_table;
+
+void Jtag::set_state(int newState)
+{
+	if (newState < TEST_LOGIC_RESET || newState > UPDATE_IR ||
+			_state < TEST_LOGIC_RESET || _state > UPDATE_IR) {
+		cerr << "Error: unknown JTAG state" << endl;
+		return;
+	}
+
+	const tap_path_t &path = tap_path[_state][newState];
+	display("_state : %16s(%02d) -> %s(%02d) tms %02x (%d bits)\n",
+		getStateName((tapState_t)_state), _state,
+		getStateName((tapState_t)newState), newState,
+		path.tms, path.len);
 
-		setTMS(tms);
-		display("%d %d %d %x\n", tms, _num_tms-1, _state,
-			_tms_buffer[(_num_tms-1) / 8]);
+	/* whole path is appended to the buffer and sent with
+	 * a single writeTMS
+	 */
+	if (_num_tms + path.len >= _tms_buffer_size * 8)
+		flushTMS(false);
+	for (int i = 0; i < path.len; i++, _num_tms++) {
+		if ((path.tms >> i) & 0x01)
+			_tms_buffer[_num_tms >> 3] |= (0x1) << (_num_tms & 0x7);
 	}
+	_state = newState;
+	/* IR is reset or reloaded with capture value */
+	if (_state == TEST_LOGIC_RESET ||
+			(_state >= CAPTURE_IR && _state <= UPDATE_IR))
+		invalidate_ir_cache();
+
 	/* force write buffer */
 	flushTMS(false);
 }
 
+uint8_t Jtag::get_tms_path(tapState_t from, tapState_t to, uint8_t *len)
+{
+	const tap_path_t &path = tap_path[from][to];
+	if (len)
+		*len = path.len;
+	return path.tms;
+}
+
+Jtag::tapState_t Jtag::walk_tms(tapState_t state, const uint8_t *tms,
+		uint32_t len)
+{
+	uint8_t s = state;
+	uint32_t i = 0;
+	/* full bytes: one lookup per 8 TMS bits */
+	for (; i + 8 <= len; i += 8)
+		s = tap_byte_table.next[s][tms[i >> 3]];
+	/* residual bits */
+	for (; i < len; i++)
+		s = tap_next_state[s][(tms[i >> 3] >> (i & 0x07)) & 0x01];
+	return (tapState_t)s;
+}
+
 const char *Jtag::getStateName(tapState_t s)
 {
 	switch (s) {
@@ -14,6 +14,8 @@
 #include "cable.hpp"
 #include "jtagInterface.hpp"
 
+class JtagRecorder;
+
 class Jtag {
  public:
 	Jtag(const cable_t &cable, const jtag_pins_conf_t *pin_conf,
@@ -21,17 +23,31 @@ class Jtag {
 		const std::string &serial, uint32_t clkHZ, int8_t verbose,
 		const std::string &ip_adr, int port,
 		const bool invert_read_edge = false,
-		const std::string &firmware_path = "");
+		const std::string &firmware_path = "",
+		const std::string &chain_cache = "");
 	~Jtag();
 
 	/* maybe to update */
 	int setClkFreq(uint32_t clkHZ) { return _jtag->setClkFreq(clkHZ);}
 	uint32_t getClkFreq() { return _jtag->getClkFreq();}
+	/*!
+	 * \brief search highest stable TCK frequency: IDCODE and pseudo
+	 *        random pattern loopback scans at max_freq, then current
+	 *        frequency (halved while unstable) and a binary search on
+	 *        applied frequencies. Selected frequency is one achievable
+	 *        step below the highest stable one. Result is stored in
+	 *        chain cache
+	 * \param[in] max_freq: highest frequency to try
+	 * \return selected frequency, 0 if no stable frequency is found
+	 */
+	uint32_t auto_freq(uint32_t max_freq);
 
 	/*!
-	 * \brief scan JTAG chain to obtain IDCODE. Fill
+	 * \brief scan JTAG chain to obtain IDCODE (single scan). Fill
 	 *        a vector with all idcode and another
-	 *        vector with irlength
+	 *        vector with irlength. IR chain length is measured
+	 *        to check irlength (or to deduce it for an unknown device)
+	 * \param[in] max_dev: max number of devices in the chain
 	 * \return number of devices found
 	 */
 	int detectChain(int max_dev);
@@ -63,20 +79,106 @@ class Jtag {
 	bool insert_first(uint32_t device_id, uint16_t irlength);
 
 	/*!
-	 * \brief return a pointer to the transport subclass
+	 * \brief return a pointer to the transport subclass (converter
+	 *        itself when transactions are recorded)
 	 * \return a pointer instance of JtagInterface
 	 */
-	JtagInterface *get_ll_class() {return _jtag;}
+	JtagInterface *get_ll_class();
+
+	/*!
+	 * \brief record all following transactions (with TDO read back)
+	 *        in a file
+	 * \param[in] filename: record file
+	 * \return false if file can't be created
+	 */
+	bool start_recording(const std::string &filename);
+	/*!
+	 * \brief replay a session recorded by start_recording: TAP must be
+	 *        in the same state as when recording was started
+	 * \param[in] filename: record file
+	 * \return false if file is invalid or TDO doesn't match
+	 */
+	bool replay(const std::string &filename);
 
 	int shiftIR(unsigned char *tdi, unsigned char *tdo, int irlen,
 		int end_state = RUN_TEST_IDLE);
 	int shiftIR(unsigned char tdi, int irlen,
 		int end_state = RUN_TEST_IDLE);
+	/*!
+	 * \brief same as shiftIR but the scan is skipped when tdi is already
+	 *        loaded in the selected device IR. Only for instructions
+	 *        without side effect on UPDATE_IR (USERx, CFG_IN, ...)
+	 * \param[in] tdi: instruction
+	 * \param[in] irlen: instruction length
+	 * \param[in] end_state: state after scan
+	 * \return 0 when success
+	 */
+	int shiftIR_cached(unsigned char *tdi, int irlen,
+		int end_state = RUN_TEST_IDLE);
+	/*!
+	 * \brief forget IR content of all devices: next shiftIR_cached
+	 *        is always performed. Must be used when IR is modified
+	 *        without shiftIR
+	 */
+	void invalidate_ir_cache();
 	int shiftDR(unsigned char *tdi, unsigned char *tdo, int drlen,
 		int end_state = RUN_TEST_IDLE);
 	int read_write(unsigned char *tdi, unsigned char *tdo, int len, char last);
 
+	/*!
+	 * \brief load the same instruction in several devices with a single
+	 *        IR scan, others devices are in BYPASS
+	 * \param[in] devices: list of devices index in the chain
+	 * \param[in] tdi: instruction
+	 * \param[in] irlen: instruction length (same for all devices)
+	 * \param[in] end_state: state after scan (not SHIFT_IR)
+	 * \return 0 when success, -1 otherwise
+	 */
+	int shiftIR_broadcast(const std::vector<int> &devices, unsigned char *tdi,
+		int irlen, int end_state = RUN_TEST_IDLE);
+	/*!
+	 * \brief same as shiftDR but the stream is sent to all devices
+	 *        in the list: bits are padded to reach the farthest one
+	 *        when leaving SHIFT_DR
+	 * \param[in] devices: list of devices index in the chain
+	 * \param[in] dev_drlen: DR length of one selected device
+	 * \param[in] tdi: data
+	 * \param[in] drlen: data length
+	 * \param[in] end_state: state after scan
+	 * \return 0 when success, -1 otherwise
+	 */
+	int shiftDR_broadcast(const std::vector<int> &devices, int dev_drlen,
+		unsigned char *tdi, int drlen, int end_state = RUN_TEST_IDLE);
+
+	/*!
+	 * \brief same as shiftIR but TDO may be filled later: tdo content is
+	 *        only valid after execute() and tdo must remain
+	 *        valid until this call
+	 */
+	int queue_shiftIR(unsigned char *tdi, unsigned char *tdo, int irlen,
+		int end_state = RUN_TEST_IDLE);
+	/*!
+	 * \brief same as shiftDR but TDO may be filled later: tdo content is
+	 *        only valid after execute() and tdo must remain
+	 *        valid until this call
+	 */
+	int queue_shiftDR(unsigned char *tdi, unsigned char *tdo, int drlen,
+		int end_state = RUN_TEST_IDLE);
+	/*!
+	 * \brief send all queued scans and fill their tdo buffers
+	 * \return >= 0 when success, < 0 otherwise
+	 */
+	int execute();
+
 	void toggleClk(int nb);
+	/*!
+	 * \brief stay in current state at least ns nanoseconds and
+	 *        min_clocks clock cycles (converter chooses the best
+	 *        method: clock only commands or host sleep)
+	 * \param[in] ns: minimal duration (nanoseconds)
+	 * \param[in] min_clocks: minimal number of clock cycles
+	 */
+	void delay(uint64_t ns, uint32_t min_clocks = 0);
 	void go_test_logic_reset();
 	void set_state(int newState);
 	int flushTMS(bool flush_buffer = false);
@@ -104,6 +206,24 @@ class Jtag {
 	};
 	const char *getStateName(tapState_t s);
 
+	/*!
+	 * \brief return shortest TMS sequence to move from a state to another
+	 * \param[in] from: current state
+	 * \param[in] to: requested state
+	 * \param[out] len: number of TMS bits (max 8). May be NULL
+	 * \return TMS sequence (LSB first)
+	 */
+	static uint8_t get_tms_path(tapState_t from, tapState_t to, uint8_t *len);
+	/*!
+	 * \brief follow a TMS sequence from a state (8 bits per lookup)
+	 * \param[in] state: initial state
+	 * \param[in] tms: TMS sequence (LSB first)
+	 * \param[in] len: number of TMS bits
+	 * \return state after applying sequence
+	 */
+	static tapState_t walk_tms(tapState_t state, const uint8_t *tms,
+		uint32_t len);
+
 	/* utilities */
 	void setVerbose(int8_t verbose){_verbose = verbose;}
 
@@ -112,12 +232,69 @@ class Jtag {
  private:
 	/*!
 	 * \brief search in fpga_list and misc_dev_list for a device with idcode
-	 *        if found insert idcode and irlength in _devices_list and
-	 *        _irlength_list
 	 * \param[in] idcode: device idcode
-	 * \return false if not found, true otherwise
+	 * \return irlength, -1 if not found
+	 */
+	int search_irlength(uint32_t idcode);
+	/*!
+	 * \brief read all IDCODE in the chain with a single DR scan
+	 * \param[in] max_dev: max number of devices
+	 * \param[out] idcodes: IDCODE list (first is the nearest TDO)
+	 * \return number of IDCODE read, -1 when a device has no IDCODE
+	 */
+	int scan_idcodes(int max_dev, std::vector<uint32_t> &idcodes);
+	/*!
+	 * \brief measure IR chain length
+	 * \param[in] max_len: max IR chain length
+	 * \return IR chain length, -1 if not found
+	 */
+	int scan_irlength(int max_len);
+	/*!
+	 * \brief fill devices list with a chain cache file content when
+	 *        the chain is confirmed by an IDCODE scan
+	 * \param[in] filename: cache file
+	 * \param[in] key: probe identifier (serial or vid:pid)
+	 * \return false if cache is missing or doesn't match
+	 */
+	bool load_chain_cache(const std::string &filename, const std::string &key);
+	/*!
+	 * \brief write devices list in a chain cache file
+	 * \param[in] filename: cache file
+	 * \param[in] key: probe identifier (serial or vid:pid)
+	 * \return false if file can't be written
+	 */
+	bool save_chain_cache(const std::string &filename, const std::string &key);
+	/*!
+	 * \brief shift pseudo random patterns through the chain (IDCODE
+	 *        after TLR) and check IDCODEs and patterns read back
+	 * \param[in] nb_iter: number of scans
+	 * \return true if all scans are correct
+	 */
+	bool check_loopback(int nb_iter);
+	/*!
+	 * \brief store instruction loaded in selected device,
+	 *        others devices are in BYPASS
+	 * \param[in] tdi: instruction (NULL when unknown)
+	 * \param[in] irlen: instruction length
 	 */
-	bool search_and_insert_device_with_idcode(uint32_t idcode);
+	void update_ir_cache(const unsigned char *tdi, int irlen);
+	/*!
+	 * \brief shift len bits with bypass bits before and after
+	 *        in a single transaction
+	 * \param[in] tdi: payload (may be NULL)
+	 * \param[out] tdo: payload read back (may be NULL)
+	 * \param[in] len: payload length
+	 * \param[in] bits_before: bypass bits sent before payload
+	 * \param[in] bits_after: bypass bits sent after payload
+	 * \param[in] last: set TMS high with last bit
+	 */
+	int shift_with_bypass(unsigned char *tdi, unsigned char *tdo, int len,
+		int bits_before, int bits_after, bool last);
+	/*!
+	 * \brief copy len bits from src, starting at offset, to dst
+	 */
+	static void extract_bits(const uint8_t *src, int offset, uint8_t *dst,
+		int len);
 	bool _verbose;
 	int _state;
 	int _tms_buffer_size;
@@ -128,5 +305,27 @@ class Jtag {
 	int device_index; /*!< index for targeted FPGA */
 	std::vector<int32_t> _devices_list; /*!< ordered list of devices idcode */
 	std::vector<int16_t> _irlength_list; /*!< ordered list of irlength */
+	std::string _chain_cache;  /*!< chain cache file (may be empty) */
+	std::string _cache_key;    /*!< probe identifier in chain cache */
+	uint32_t _cached_freq;     /*!< stable frequency found by auto_freq */
+	JtagRecorder *_recorder;   /*!< transactions recorder (may be NULL) */
+
+	typedef struct {
+		bool valid;                 /*!< false after TAP reset or unknown scan */
+		std::vector<uint8_t> value; /*!< last instruction loaded */
+	} ir_cache_t;
+	std::vector<ir_cache_t> _ir_cache; /*!< IR content for each device */
+
+	/* full chain scan buffers */
+	std::vector<uint8_t> _scan_tx; /*!< bypass + payload stream */
+	std::vector<uint8_t> _scan_rx; /*!< bypass + payload read back */
+	bool _queue_scan; /*!< true when current scan is queued */
+	typedef struct {
+		std::vector<uint8_t> rx; /*!< full chain read back */
+		uint8_t *tdo;            /*!< payload destination */
+		int offset;              /*!< payload offset in rx */
+		int len;                 /*!< payload length */
+	} queued_rx_t;
+	std::vector<queued_rx_t> _queued_rx; /*!< queued scans with bypass */
 };
 #endif
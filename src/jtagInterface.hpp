@@ -6,6 +6,8 @@
 #ifndef _JTAGINTERFACE_H_
 #define _JTAGINTERFACE_H_
 
+#include <unistd.h>
+
 #include <cstdint>
 #include <iostream>
 #include <vector>
@@ -62,6 +64,31 @@ class JtagInterface {
 	 */
 	virtual int toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len) = 0;
 
+	/*!
+	 * \brief wait at least ns nanoseconds and min_clocks clock cycles
+	 *        without touch of TDI/TMS. Default implementation sends
+	 *        min_clocks cycles, flush and sleeps on host side the part
+	 *        of ns not covered by these cycles
+	 * \param tms: state of tms signal
+	 * \param ns: minimal duration (nanoseconds)
+	 * \param min_clocks: minimal number of clock cycle
+	 * \return >= 0 if success, -1 is something wrong
+	 */
+	virtual int delay(uint8_t tms, uint64_t ns, uint32_t min_clocks)
+	{
+		if (min_clocks > 0 && toggleClk(tms, 0, min_clocks) < 0)
+			return -1;
+		uint32_t freq = getClkFreq();
+		uint64_t clk_ns = (freq == 0) ? 0 :
+			static_cast<uint64_t>(min_clocks) * 1000000000ULL / freq;
+		if (ns <= clk_ns)
+			return 0;
+		if (flush() < 0)
+			return -1;
+		usleep((ns - clk_ns + 999) / 1000);
+		return 0;
+	}
+
 	/*!
 	 * \brief return internal buffer size (in byte)
 	 * \return internal buffer size
@@ -79,6 +106,20 @@ class JtagInterface {
 	 * \return 1 if success, 0 if nothing to write, -1 is something wrong
 	 */
 	virtual int flush() = 0;
+
+	/*!
+	 * \brief enable/disable deferred TDO read: when enabled writeTDI
+	 *        only queues reads and tdo buffers are filled at
+	 *        flushDeferred (or before any synchronous read)
+	 * \param enable: deferred mode state
+	 * \return true when converter supports deferred mode
+	 */
+	virtual bool setDeferredRead(bool enable) { (void)enable; return false;}
+	/*!
+	 * \brief send all pending commands and fill queued tdo buffers
+	 * \return >= 0 if success, -1 is something wrong
+	 */
+	virtual int flushDeferred() { return flush();}
  protected:
 	uint32_t _clkHZ; /*!< current clk frequency */
 };
@@ -0,0 +1,423 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "jtagRecorder.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "display.hpp"
+
+#define REC_MAGIC   "OFLR"
+#define REC_VERSION 1
+
+enum {
+	REC_TMS    = 0x01,
+	REC_TDI    = 0x02,
+	REC_TMSTDI = 0x03,
+	REC_CLK    = 0x04,
+	REC_FREQ   = 0x05,
+	REC_FLUSH  = 0x06,
+	REC_DELAY  = 0x07,
+};
+
+/* TDI/TMSTDI flags */
+#define REC_FLAG_END (1 << 0)
+#define REC_FLAG_TX  (1 << 1)
+#define REC_FLAG_RX  (1 << 2)
+
+/* records are written when buffer reaches this size */
+#define REC_BUF_SIZE (1 << 20)
+/* replay: max TDO bytes pending before comparison */
+#define REPLAY_RX_SIZE (1 << 20)
+
+static void put_u8(std::vector<uint8_t> &buf, uint8_t val)
+{
+	buf.push_back(val);
+}
+
+static void put_u32(std::vector<uint8_t> &buf, uint32_t val)
+{
+	for (int i = 0; i < 4; i++)
+		buf.push_back((val >> (8 * i)) & 0xff);
+}
+
+static void put_u64(std::vector<uint8_t> &buf, uint64_t val)
+{
+	for (int i = 0; i < 8; i++)
+		buf.push_back((val >> (8 * i)) & 0xff);
+}
+
+static void put_bytes(std::vector<uint8_t> &buf, const uint8_t *data,
+		uint32_t len)
+{
+	buf.insert(buf.end(), data, data + len);
+}
+
+static bool get_u8(FILE *fd, uint8_t *val)
+{
+	return fread(val, 1, 1, fd) == 1;
+}
+
+static bool get_u32(FILE *fd, uint32_t *val)
+{
+	uint8_t b[4];
+	if (fread(b, 1, 4, fd) != 4)
+		return false;
+	*val = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+	return true;
+}
+
+static bool get_u64(FILE *fd, uint64_t *val)
+{
+	uint32_t lo, hi;
+	if (!get_u32(fd, &lo) || !get_u32(fd, &hi))
+		return false;
+	*val = ((uint64_t)hi << 32) | lo;
+	return true;
+}
+
+static bool get_bytes(FILE *fd, std::vector<uint8_t> &buf, uint32_t len)
+{
+	buf.resize(len);
+	return len == 0 || fread(buf.data(), 1, len, fd) == len;
+}
+
+JtagRecorder::JtagRecorder(JtagInterface *jtag, const std::string &filename,
+		int8_t verbose):
+	_jtag(jtag), _fd(NULL), _verbose(verbose), _deferred(false)
+{
+	_fd = fopen(filename.c_str(), "wb");
+	if (!_fd)
+		throw std::runtime_error("can't open " + filename);
+	_clkHZ = _jtag->getClkFreq();
+
+	_buf.insert(_buf.end(), REC_MAGIC, REC_MAGIC + 4);
+	put_u32(_buf, REC_VERSION);
+}
+
+JtagRecorder::~JtagRecorder()
+{
+	if (!_pending.empty()) {
+		_jtag->flushDeferred();
+		resolve();
+	}
+	store(true);
+	if (_verbose > 0)
+		printInfo("record: " + std::to_string(ftell(_fd)) + " Bytes written");
+	fclose(_fd);
+	delete _jtag;
+}
+
+void JtagRecorder::resolve()
+{
+	for (auto &p : _pending)
+		memcpy(_buf.data() + p.offset, p.rx, p.len);
+	_pending.clear();
+}
+
+void JtagRecorder::store(bool force)
+{
+	/* records with pending TDO can't be written */
+	if (!_pending.empty())
+		return;
+	if (!force && _buf.size() < REC_BUF_SIZE)
+		return;
+	if (fwrite(_buf.data(), 1, _buf.size(), _fd) != _buf.size())
+		printError("record: write failure");
+	_buf.clear();
+}
+
+int JtagRecorder::setClkFreq(uint32_t clkHZ)
+{
+	int ret = _jtag->setClkFreq(clkHZ);
+	put_u8(_buf, REC_FREQ);
+	put_u32(_buf, clkHZ);
+	_clkHZ = _jtag->getClkFreq();
+	return ret;
+}
+
+int JtagRecorder::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
+{
+	int ret = _jtag->writeTMS(tms, len, flush_buffer);
+	put_u8(_buf, REC_TMS);
+	put_u32(_buf, len);
+	put_u8(_buf, flush_buffer);
+	put_bytes(_buf, tms, (len + 7) / 8);
+	store(false);
+	return ret;
+}
+
+int JtagRecorder::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
+{
+	int ret = _jtag->writeTDI(tx, rx, len, end);
+	uint32_t byte_len = (len + 7) / 8;
+	uint8_t flags = (end ? REC_FLAG_END : 0) | (tx ? REC_FLAG_TX : 0) |
+		(rx ? REC_FLAG_RX : 0);
+	put_u8(_buf, REC_TDI);
+	put_u32(_buf, len);
+	put_u8(_buf, flags);
+	if (tx)
+		put_bytes(_buf, tx, byte_len);
+	if (rx) {
+		/* deferred: tdo is copied when converter has filled it */
+		_pending.push_back({_buf.size(), rx, byte_len});
+		_buf.resize(_buf.size() + byte_len);
+		/* synchronous read: previous reads are also completed */
+		if (!_deferred)
+			resolve();
+	}
+	store(false);
+	return ret;
+}
+
+bool JtagRecorder::writeTMSTDI(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, uint32_t len)
+{
+	if (!_jtag->writeTMSTDI(tms, tdi, tdo, len))
+		return false;
+	uint32_t byte_len = (len + 7) / 8;
+	put_u8(_buf, REC_TMSTDI);
+	put_u32(_buf, len);
+	put_u8(_buf, (tdo) ? REC_FLAG_RX : 0);
+	put_bytes(_buf, tms, byte_len);
+	put_bytes(_buf, tdi, byte_len);
+	if (tdo) {
+		_pending.push_back({_buf.size(), tdo, byte_len});
+		_buf.resize(_buf.size() + byte_len);
+		if (!_deferred)
+			resolve();
+	}
+	store(false);
+	return true;
+}
+
+int JtagRecorder::toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len)
+{
+	int ret = _jtag->toggleClk(tms, tdi, clk_len);
+	put_u8(_buf, REC_CLK);
+	put_u8(_buf, tms);
+	put_u8(_buf, tdi);
+	put_u32(_buf, clk_len);
+	store(false);
+	return ret;
+}
+
+int JtagRecorder::delay(uint8_t tms, uint64_t ns, uint32_t min_clocks)
+{
+	int ret = _jtag->delay(tms, ns, min_clocks);
+	put_u8(_buf, REC_DELAY);
+	put_u8(_buf, tms);
+	put_u64(_buf, ns);
+	put_u32(_buf, min_clocks);
+	store(false);
+	return ret;
+}
+
+int JtagRecorder::flush()
+{
+	int ret = _jtag->flush();
+	put_u8(_buf, REC_FLUSH);
+	return ret;
+}
+
+bool JtagRecorder::setDeferredRead(bool enable)
+{
+	_deferred = _jtag->setDeferredRead(enable);
+	return _deferred;
+}
+
+int JtagRecorder::flushDeferred()
+{
+	int ret = _jtag->flushDeferred();
+	resolve();
+	put_u8(_buf, REC_FLUSH);
+	store(false);
+	return ret;
+}
+
+/* replay */
+
+typedef struct {
+	std::vector<uint8_t> expected; /*!< recorded tdo */
+	std::vector<uint8_t> rx;       /*!< tdo read back */
+	uint32_t len;                  /*!< length in bit */
+	uint32_t record;               /*!< record index */
+} replay_rx_t;
+
+/* compare pending reads with recorded TDO */
+static uint32_t replay_check(JtagInterface *jtag,
+		std::vector<replay_rx_t> &pending, int8_t verbose)
+{
+	uint32_t nb_err = 0;
+	jtag->flushDeferred();
+	for (auto &p : pending) {
+		for (uint32_t i = 0; i < p.len / 8 + 1; i++) {
+			uint8_t mask = 0xff;
+			if (i == p.len / 8) {
+				if ((p.len & 0x07) == 0)
+					break;
+				mask = (1 << (p.len & 0x07)) - 1;
+			}
+			if ((p.rx[i] ^ p.expected[i]) & mask) {
+				if (nb_err == 0 || verbose > 0) {
+					char mess[128];
+					snprintf(mess, 128, "replay: record %u byte %u: "
+						"read 0x%02x expected 0x%02x", p.record, i,
+						p.rx[i] & mask, p.expected[i] & mask);
+					printError(mess);
+				}
+				nb_err++;
+				break;
+			}
+		}
+	}
+	pending.clear();
+	return nb_err;
+}
+
+bool JtagRecorder::replay(const std::string &filename, JtagInterface *jtag,
+		int8_t verbose)
+{
+	FILE *fd = fopen(filename.c_str(), "rb");
+	if (!fd) {
+		printError("replay: can't open " + filename);
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version;
+	if (fread(magic, 1, 4, fd) != 4 || memcmp(magic, REC_MAGIC, 4) ||
+			!get_u32(fd, &version) || version != REC_VERSION) {
+		printError("replay: " + filename + " is not a valid record file");
+		fclose(fd);
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	bool deferred = jtag->setDeferredRead(true);
+	std::vector<replay_rx_t> pending;
+	uint32_t pending_size = 0;
+	std::vector<uint8_t> tms, tdi;
+	uint32_t nb_rec = 0, nb_err = 0;
+	uint64_t nb_bits = 0;
+	bool ok = true;
+
+	uint8_t op;
+	while (ok && get_u8(fd, &op)) {
+		uint8_t flags, tms_val, tdi_val;
+		uint32_t len, byte_len, val;
+		uint64_t ns;
+		switch (op) {
+		case REC_TMS:
+			ok = get_u32(fd, &len) && get_u8(fd, &flags) &&
+				get_bytes(fd, tms, (len + 7) / 8);
+			if (ok)
+				jtag->writeTMS(tms.data(), len, flags != 0);
+			break;
+		case REC_TDI: {
+			ok = get_u32(fd, &len) && get_u8(fd, &flags);
+			byte_len = (len + 7) / 8;
+			if (ok && (flags & REC_FLAG_TX))
+				ok = get_bytes(fd, tdi, byte_len);
+			if (!ok)
+				break;
+			uint8_t *rx = NULL;
+			if (flags & REC_FLAG_RX) {
+				pending.push_back({{}, std::vector<uint8_t>(byte_len), len,
+					nb_rec});
+				ok = get_bytes(fd, pending.back().expected, byte_len);
+				rx = pending.back().rx.data();
+				pending_size += byte_len;
+			}
+			if (ok)
+				jtag->writeTDI((flags & REC_FLAG_TX) ? tdi.data() : NULL, rx,
+					len, flags & REC_FLAG_END);
+			nb_bits += len;
+			break;
+		}
+		case REC_TMSTDI: {
+			ok = get_u32(fd, &len) && get_u8(fd, &flags);
+			byte_len = (len + 7) / 8;
+			ok = ok && get_bytes(fd, tms, byte_len) &&
+				get_bytes(fd, tdi, byte_len);
+			if (!ok)
+				break;
+			uint8_t *rx = NULL;
+			if (flags & REC_FLAG_RX) {
+				pending.push_back({{}, std::vector<uint8_t>(byte_len), len,
+					nb_rec});
+				ok = get_bytes(fd, pending.back().expected, byte_len);
+				rx = pending.back().rx.data();
+				pending_size += byte_len;
+			}
+			if (ok && !jtag->writeTMSTDI(tms.data(), tdi.data(), rx, len)) {
+				printError("replay: writeTMSTDI not supported by this cable");
+				ok = false;
+			}
+			nb_bits += len;
+			break;
+		}
+		case REC_CLK:
+			ok = get_u8(fd, &tms_val) && get_u8(fd, &tdi_val) &&
+				get_u32(fd, &len);
+			if (ok)
+				jtag->toggleClk(tms_val, tdi_val, len);
+			break;
+		case REC_FREQ:
+			ok = get_u32(fd, &val);
+			if (ok)
+				jtag->setClkFreq(val);
+			break;
+		case REC_FLUSH:
+			jtag->flush();
+			break;
+		case REC_DELAY:
+			ok = get_u8(fd, &tms_val) && get_u64(fd, &ns) && get_u32(fd, &val);
+			if (ok)
+				jtag->delay(tms_val, ns, val);
+			break;
+		default:
+			printError("replay: unknown record type " + std::to_string(op));
+			ok = false;
+			break;
+		}
+		if (!ok)
+			break;
+		nb_rec++;
+
+		/* converter without deferred mode: compare now */
+		if (!pending.empty() && (!deferred || pending_size >= REPLAY_RX_SIZE)) {
+			nb_err += replay_check(jtag, pending, verbose);
+			pending_size = 0;
+		}
+	}
+	if (!ok)
+		printError("replay: stopped at record " + std::to_string(nb_rec));
+	fclose(fd);
+
+	nb_err += replay_check(jtag, pending, verbose);
+	if (deferred)
+		jtag->setDeferredRead(false);
+
+	if (verbose > 0) {
+		double duration = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+		char mess[128];
+		snprintf(mess, 128, "replay: %u records %llu bits in %.3f s", nb_rec,
+			(unsigned long long)nb_bits, duration);
+		printInfo(mess);
+	}
+	if (nb_err != 0) {
+		printError("replay: " + std::to_string(nb_err) + " TDO mismatch");
+		return false;
+	}
+	return ok;
+}
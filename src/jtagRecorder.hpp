@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_JTAGRECORDER_HPP_
+#define SRC_JTAGRECORDER_HPP_
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "jtagInterface.hpp"
+
+/*!
+ * \file jtagRecorder.hpp
+ * \class JtagRecorder
+ * \brief JtagInterface wrapper: all calls are forwarded to the real
+ *        converter and logged (with TDO read back) in a binary file.
+ *        A recorded session is replayed on any converter without
+ *        vendor specific logic
+ *
+ * File format (little endian): "OFLR" + version (u32) then records
+ * starting with an opcode (u8):
+ * - TMS:    len (u32), flush (u8), tms
+ * - TDI:    len (u32), flags (u8: end, tx, rx), [tx], [expected tdo]
+ * - TMSTDI: len (u32), flags (u8: rx), tms, tdi, [expected tdo]
+ * - CLK:    tms (u8), tdi (u8), len (u32)
+ * - FREQ:   frequency (u32)
+ * - FLUSH
+ * - DELAY:  tms (u8), ns (u64), min_clocks (u32)
+ */
+class JtagRecorder : public JtagInterface {
+ public:
+	/*!
+	 * \brief constructor: open record file
+	 * \param[in] jtag: converter (owned by the recorder)
+	 * \param[in] filename: record file
+	 * \param[in] verbose: verbose level
+	 */
+	JtagRecorder(JtagInterface *jtag, const std::string &filename,
+		int8_t verbose);
+	~JtagRecorder();
+
+	/*!
+	 * \brief replay a recorded session: TDO are compared with
+	 *        recorded values. Reads are deferred when converter allows it
+	 * \param[in] filename: record file
+	 * \param[in] jtag: converter
+	 * \param[in] verbose: verbose level
+	 * \return false when file is invalid or TDO mismatch
+	 */
+	static bool replay(const std::string &filename, JtagInterface *jtag,
+		int8_t verbose);
+
+	/*!
+	 * \brief return real converter
+	 */
+	JtagInterface *get_ll_class() { return _jtag;}
+
+	int setClkFreq(uint32_t clkHZ) override;
+	uint32_t getClkFreq() override { return _jtag->getClkFreq();}
+	int writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer) override;
+	int writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end) override;
+	bool writeTMSTDI(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, uint32_t len) override;
+	int toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len) override;
+	int delay(uint8_t tms, uint64_t ns, uint32_t min_clocks) override;
+	int get_buffer_size() override { return _jtag->get_buffer_size();}
+	bool isFull() override { return _jtag->isFull();}
+	int flush() override;
+	bool setDeferredRead(bool enable) override;
+	int flushDeferred() override;
+
+ private:
+	/*!
+	 * \brief copy TDO filled by converter in pending records
+	 */
+	void resolve();
+	/*!
+	 * \brief write records to file (only when no TDO is pending)
+	 * \param[in] force: write even if buffer is small
+	 */
+	void store(bool force);
+
+	JtagInterface *_jtag;        /*!< real converter */
+	FILE *_fd;                   /*!< record file */
+	int8_t _verbose;
+	bool _deferred;              /*!< converter deferred read mode */
+	std::vector<uint8_t> _buf;   /*!< records not yet written */
+	typedef struct {
+		size_t offset;           /*!< expected tdo offset in _buf */
+		const uint8_t *rx;       /*!< converter tdo buffer */
+		uint32_t len;            /*!< length in byte */
+	} pending_rx_t;
+	std::vector<pending_rx_t> _pending; /*!< TDO not yet available */
+};
+#endif  // SRC_JTAGRECORDER_HPP_
@@ -10,8 +10,10 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include "jtag.hpp"
 #include "lattice.hpp"
@@ -19,9 +21,11 @@
 #include "mcsParser.hpp"
 #include "progressBar.hpp"
 #include "rawParser.hpp"
+#include "bitOps.hpp"
 #include "display.hpp"
 #include "part.hpp"
 #include "spiFlash.hpp"
+#include "traceEvent.hpp"
 
 using namespace std;
 
@@ -214,42 +218,42 @@ void displayFeabits(uint16_t _featbits)
 {
 	uint8_t boot_sequence = (_featbits >> 12) & 0x03;
 	uint8_t m = (_featbits >> 11) & 0x01;
-	printf("\tboot mode                                :");
+	printfInfo("\tboot mode                                :");
 	switch (boot_sequence) {
 		case 0:
 			if (m != 0x01)
-				printf(" Single Boot from NVCM/Flash\n");
+				printfInfo(" Single Boot from NVCM/Flash\n");
 			else
-				printf(" Dual Boot from NVCM/Flash then External if there is a failure\n");
+				printfInfo(" Dual Boot from NVCM/Flash then External if there is a failure\n");
 			break;
 		case 1:
 			if (m == 0x01)
-				printf(" Single Boot from External Flash\n");
+				printfInfo(" Single Boot from External Flash\n");
 			else
-				printf(" Error!\n");
+				printfInfo(" Error!\n");
 			break;
 		default:
-			printf(" Error!\n");
+			printfInfo(" Error!\n");
 	}
-	printf("\tMaster Mode SPI                          : %s\n",
+	printfInfo("\tMaster Mode SPI                          : %s\n",
 	    (((_featbits>>11)&0x01)?"enable":"disable"));
-	printf("\tI2c port                                 : %s\n",
+	printfInfo("\tI2c port                                 : %s\n",
 	    (((_featbits>>10)&0x01)?"disable":"enable"));
-	printf("\tSlave SPI port                           : %s\n",
+	printfInfo("\tSlave SPI port                           : %s\n",
 	    (((_featbits>>9)&0x01)?"disable":"enable"));
-	printf("\tJTAG port                                : %s\n",
+	printfInfo("\tJTAG port                                : %s\n",
 	    (((_featbits>>8)&0x01)?"disable":"enable"));
-	printf("\tDONE                                     : %s\n",
+	printfInfo("\tDONE                                     : %s\n",
 	    (((_featbits>>7)&0x01)?"enable":"disable"));
-	printf("\tINITN                                    : %s\n",
+	printfInfo("\tINITN                                    : %s\n",
 	    (((_featbits>>6)&0x01)?"enable":"disable"));
-	printf("\tPROGRAMN                                 : %s\n",
+	printfInfo("\tPROGRAMN                                 : %s\n",
 	    (((_featbits>>5)&0x01)?"disable":"enable"));
-	printf("\tMy_ASSP                                  : %s\n",
+	printfInfo("\tMy_ASSP                                  : %s\n",
 	    (((_featbits>>4)&0x01)?"enable":"disable"));
-	printf("\tPassword (Flash Protect Key) Protect All : %s\n",
+	printfInfo("\tPassword (Flash Protect Key) Protect All : %s\n",
 	    (((_featbits>>3)&0x01)?"Enabled" : "Disabled"));
-	printf("\tPassword (Flash Protect Key) Protect     : %s\n",
+	printfInfo("\tPassword (Flash Protect Key) Protect     : %s\n",
 	    (((_featbits>>2)&0x01)?"Enabled" : "Disabled"));
 }
 
@@ -293,7 +297,7 @@ bool Lattice::program_mem()
 	}
 
 	if (_verbose) {
-		printf("IDCode : %x\n", idcode);
+		printfInfo("IDCode : %x\n", idcode);
 		displayReadReg(readStatusReg());
 	}
 
@@ -336,7 +340,9 @@ bool Lattice::program_mem()
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
 	_jtag->toggleClk(2);
 
-	uint8_t tmp[1024];
+	/* bitstream in wire order, reversed once */
+	std::vector<uint8_t> wire(length);
+	bit_reverse_bytes(wire.data(), data, length);
 	int size = 1024;
 	int next_state = Jtag::SHIFT_DR;
 
@@ -350,10 +356,7 @@ bool Lattice::program_mem()
 			next_state = Jtag::RUN_TEST_IDLE;
 		}
 
-		for (int ii = 0; ii < size; ii++)
-			tmp[ii] = ConfigBitstreamParser::reverseByte(data[i+ii]);
-
-		_jtag->shiftDR(tmp, NULL, size*8, next_state);
+		_jtag->shiftDR(wire.data() + i, NULL, size*8, next_state);
 	}
 
 	uint32_t status_mask;
@@ -373,7 +376,7 @@ bool Lattice::program_mem()
 	wr_rd(0xff, NULL, 0, NULL, 0);
 
 	if (_verbose)
-		printf("userCode: %08x\n", userCode());
+		printfInfo("userCode: %08x\n", userCode());
 
 	/* bypass */
 	wr_rd(0xff, NULL, 0, NULL, 0);
@@ -665,7 +668,9 @@ bool Lattice::program_extFlash(unsigned int offset, bool unprotect_flash)
 {
 	int ret;
 	ConfigBitstreamParser *_bit;
+	TraceSpan span("Lattice::program_extFlash", "device");
 
+	uint64_t parse_start = trace_now();
 	printInfo("Open file ", false);
 	try {
 		if (_file_extension == "mcs")
@@ -690,6 +695,8 @@ bool Lattice::program_extFlash(unsigned int offset, bool unprotect_flash)
 	} else {
 		printSuccess("DONE");
 	}
+	if (parse_start != 0)
+		trace_complete("parse", "phase", parse_start, trace_now());
 
 	if (_verbose)
 		_bit->displayHeader();
@@ -718,7 +725,7 @@ bool Lattice::program_flash(unsigned int offset, bool unprotect_flash)
 {
 	/* read ID Code 0xE0 */
 	if (_verbose) {
-		printf("IDCode : %x\n", idCode());
+		printfInfo("IDCode : %x\n", idCode());
 		displayReadReg(readStatusReg());
 	}
 
@@ -865,8 +872,8 @@ int Lattice::userCode()
 
 bool Lattice::checkID()
 {
-	printf("\n");
-	printf("check ID\n");
+	printfInfo("\n");
+	printfInfo("check ID\n");
 	uint8_t tx[4] = { 0 };
 	wr_rd(0xE2, tx, 4, NULL, 0);
 	_jtag->set_state(Jtag::RUN_TEST_IDLE);
@@ -884,8 +891,8 @@ bool Lattice::checkID()
 	_jtag->toggleClk(1000);
 	reg = readStatusReg();
 	displayReadReg(reg);
-	printf("%08x\n", reg);
-	printf("\n");
+	printfInfo("%08x\n", reg);
+	printfInfo("\n");
 	return true;
 }
 
@@ -932,8 +939,8 @@ bool Lattice::wr_rd(uint8_t cmd,
 	if (rx) {
 		if (verbose) {
 			for (i=kXferLen-1; i >= 0; i--)
-				printf("%02x ", xfer_rx[i]);
-			printf("\n");
+				printfInfo("%02x ", xfer_rx[i]);
+			printfInfo("\n");
 		}
 		for (i = 0; i < rx_len; i++)
 			rx[i] = (xfer_rx[i]);
@@ -944,152 +951,152 @@ bool Lattice::wr_rd(uint8_t cmd,
 void Lattice::displayReadReg(uint32_t dev)
 {
 	uint8_t err;
-	printf("displayReadReg\n");
-	if (dev & 1<<0) printf("\tTRAN Mode\n");
-	printf("\tConfig Target Selection : %x\n", (dev >> 1) & 0x07);
-	if (dev & 1<<4) printf("\tJTAG Active\n");
-	if (dev & 1<<5) printf("\tPWD Protect\n");
-	if (dev & 1<<6) printf("\tOTP\n");
-	if (dev & 1<<7) printf("\tDecrypt Enable\n");
-	if (dev & REG_STATUS_DONE) printf("\tDone Flag\n");
-	if (dev & REG_STATUS_ISC_EN) printf("\tISC Enable\n");
-	if (dev & 1 << 10) printf("\tWrite Enable\n");
-	if (dev & 1 << 11) printf("\tRead Enable\n");
-	if (dev & REG_STATUS_BUSY) printf("\tBusy Flag\n");
-	if (dev & REG_STATUS_FAIL) printf("\tFail Flag\n");
-	if (dev & 1 << 14) printf("\tFFEA OTP\n");
-	if (dev & 1 << 15) printf("\tDecrypt Only\n");
-	if (dev & 1 << 16) printf("\tPWD Enable\n");
+	printfInfo("displayReadReg\n");
+	if (dev & 1<<0) printfInfo("\tTRAN Mode\n");
+	printfInfo("\tConfig Target Selection : %x\n", (dev >> 1) & 0x07);
+	if (dev & 1<<4) printfInfo("\tJTAG Active\n");
+	if (dev & 1<<5) printfInfo("\tPWD Protect\n");
+	if (dev & 1<<6) printfInfo("\tOTP\n");
+	if (dev & 1<<7) printfInfo("\tDecrypt Enable\n");
+	if (dev & REG_STATUS_DONE) printfInfo("\tDone Flag\n");
+	if (dev & REG_STATUS_ISC_EN) printfInfo("\tISC Enable\n");
+	if (dev & 1 << 10) printfInfo("\tWrite Enable\n");
+	if (dev & 1 << 11) printfInfo("\tRead Enable\n");
+	if (dev & REG_STATUS_BUSY) printfInfo("\tBusy Flag\n");
+	if (dev & REG_STATUS_FAIL) printfInfo("\tFail Flag\n");
+	if (dev & 1 << 14) printfInfo("\tFFEA OTP\n");
+	if (dev & 1 << 15) printfInfo("\tDecrypt Only\n");
+	if (dev & 1 << 16) printfInfo("\tPWD Enable\n");
 	if (_fpga_family == NEXUS_FAMILY) {
-		if (dev & 1 << 17) printf("\tPWD All\n");
-		if (dev & 1 << 18) printf("\tCID En\n");
-		if (dev & 1 << 19) printf("\tinternal use\n");
-		if (dev & 1 << 21) printf("\tEncryption PreAmble\n");
-		if (dev & 1 << 22) printf("\tStd PreAmble\n");
-		if (dev & 1 << 23) printf("\tSPIm Fail1\n");
+		if (dev & 1 << 17) printfInfo("\tPWD All\n");
+		if (dev & 1 << 18) printfInfo("\tCID En\n");
+		if (dev & 1 << 19) printfInfo("\tinternal use\n");
+		if (dev & 1 << 21) printfInfo("\tEncryption PreAmble\n");
+		if (dev & 1 << 22) printfInfo("\tStd PreAmble\n");
+		if (dev & 1 << 23) printfInfo("\tSPIm Fail1\n");
 		err = (dev >> 24)&0x0f;
 	} else {
-		if (dev & 1 << 17) printf("\tUFM OTP\n");
-		if (dev & 1 << 18) printf("\tASSP\n");
-		if (dev & 1 << 19) printf("\tSDM Enable\n");
-		if (dev & 1 << 20) printf("\tEncryption PreAmble\n");
-		if (dev & 1 << 21) printf("\tStd PreAmble\n");
-		if (dev & 1 << 22) printf("\tSPIm Fail1\n");
+		if (dev & 1 << 17) printfInfo("\tUFM OTP\n");
+		if (dev & 1 << 18) printfInfo("\tASSP\n");
+		if (dev & 1 << 19) printfInfo("\tSDM Enable\n");
+		if (dev & 1 << 20) printfInfo("\tEncryption PreAmble\n");
+		if (dev & 1 << 21) printfInfo("\tStd PreAmble\n");
+		if (dev & 1 << 22) printfInfo("\tSPIm Fail1\n");
 		err = (dev >> 23)&0x07;
 	}
 
-	printf("\t");
+	printfInfo("\t");
 	switch (err) {
 		case 0:
-			printf("No err\n");
+			printfInfo("No err\n");
 			break;
 		case 1:
-			printf("ID ERR\n");
+			printfInfo("ID ERR\n");
 			break;
 		case 2:
-			printf("CMD ERR\n");
+			printfInfo("CMD ERR\n");
 			break;
 		case 3:
-			printf("CRC ERR\n");
+			printfInfo("CRC ERR\n");
 			break;
 		case 4:
-			printf("Preamble ERR\n");
+			printfInfo("Preamble ERR\n");
 			break;
 		case 5:
-			printf("Abort ERR\n");
+			printfInfo("Abort ERR\n");
 			break;
 		case 6:
-			printf("Overflow ERR\n");
+			printfInfo("Overflow ERR\n");
 			break;
 		case 7:
-			printf("SDM EOF\n");
+			printfInfo("SDM EOF\n");
 			break;
 		default:
-			printf("unknown %x\n", err);
+			printfInfo("unknown %x\n", err);
 	}
 
 	if (_fpga_family == NEXUS_FAMILY) {
-		if ((dev >> 28) & 0x01) printf("\tEXEC Error\n");
-		if ((dev >> 29) & 0x01) printf("\tID Error\n");
-		if ((dev >> 30) & 0x01) printf("\tInvalid Command\n");
-		if ((dev >> 31) & 0x01) printf("\tWDT Busy\n");
+		if ((dev >> 28) & 0x01) printfInfo("\tEXEC Error\n");
+		if ((dev >> 29) & 0x01) printfInfo("\tID Error\n");
+		if ((dev >> 30) & 0x01) printfInfo("\tInvalid Command\n");
+		if ((dev >> 31) & 0x01) printfInfo("\tWDT Busy\n");
 	} else {
-		if (dev & REG_STATUS_EXEC_ERR) printf("\tEXEC Error\n");
-		if ((dev >> 27) & 0x01) printf("\tDevice failed to verify\n");
-		if ((dev >> 28) & 0x01) printf("\tInvalid Command\n");
-		if ((dev >> 29) & 0x01) printf("\tSED Error\n");
-		if ((dev >> 30) & 0x01) printf("\tBypass Mode\n");
-		if ((dev >> 31) & 0x01) printf("\tFT Mode\n");
+		if (dev & REG_STATUS_EXEC_ERR) printfInfo("\tEXEC Error\n");
+		if ((dev >> 27) & 0x01) printfInfo("\tDevice failed to verify\n");
+		if ((dev >> 28) & 0x01) printfInfo("\tInvalid Command\n");
+		if ((dev >> 29) & 0x01) printfInfo("\tSED Error\n");
+		if ((dev >> 30) & 0x01) printfInfo("\tBypass Mode\n");
+		if ((dev >> 31) & 0x01) printfInfo("\tFT Mode\n");
 	}
 
 #if 0
 	if (_fpga_family == NEXUS_FAMILY) {
-		if ((dev >> 33) & 0x01) printf("\tDry Run Done\n");
+		if ((dev >> 33) & 0x01) printfInfo("\tDry Run Done\n");
 		err = (dev >> 34)&0x0f;
-		printf("\tBSE Error 1 Code for previous bitstream execution\n");
-		printf("\t\t");
+		printfInfo("\tBSE Error 1 Code for previous bitstream execution\n");
+		printfInfo("\t\t");
 		switch (err) {
 			case 0:
-				printf("No err\n");
+				printfInfo("No err\n");
 				break;
 			case 1:
-				printf("ID ERR\n");
+				printfInfo("ID ERR\n");
 				break;
 			case 2:
-				printf("CMD ERR\n");
+				printfInfo("CMD ERR\n");
 				break;
 			case 3:
-				printf("CRC ERR\n");
+				printfInfo("CRC ERR\n");
 				break;
 			case 4:
-				printf("Preamble ERR\n");
+				printfInfo("Preamble ERR\n");
 				break;
 			case 5:
-				printf("Abort ERR\n");
+				printfInfo("Abort ERR\n");
 				break;
 			case 6:
-				printf("Overflow ERR\n");
+				printfInfo("Overflow ERR\n");
 				break;
 			case 7:
-				printf("SDM EOF\n");
+				printfInfo("SDM EOF\n");
 				break;
 			case 8:
-				printf("Authentication ERR\n");
+				printfInfo("Authentication ERR\n");
 				break;
 			case 9:
-				printf("Authentication Setup ERR\n");
+				printfInfo("Authentication Setup ERR\n");
 				break;
 			case 10:
-				printf("Bitstream Engine Timeout ERR\n");
+				printfInfo("Bitstream Engine Timeout ERR\n");
 				break;
 			default:
-				printf("unknown %x\n", err);
+				printfInfo("unknown %x\n", err);
 		}
-		if ((dev >> 38) & 0x01) printf("\tBypass Mode\n");
-		if ((dev >> 39) & 0x01) printf("\tFlow Through Mode\n");
-		if ((dev >> 42) & 0x01) printf("\tSFDP Timeout\n");
-		if ((dev >> 43) & 0x01) printf("\tKey Destroy pass\n");
-		if ((dev >> 44) & 0x01) printf("\tINITN\n");
-		if ((dev >> 45) & 0x01) printf("\tI3C Parity Error2\n");
-		if ((dev >> 46) & 0x01) printf("\tINIT Bus ID Error\n");
-		if ((dev >> 47) & 0x01) printf("\tI3C Parity Error1\n");
+		if ((dev >> 38) & 0x01) printfInfo("\tBypass Mode\n");
+		if ((dev >> 39) & 0x01) printfInfo("\tFlow Through Mode\n");
+		if ((dev >> 42) & 0x01) printfInfo("\tSFDP Timeout\n");
+		if ((dev >> 43) & 0x01) printfInfo("\tKey Destroy pass\n");
+		if ((dev >> 44) & 0x01) printfInfo("\tINITN\n");
+		if ((dev >> 45) & 0x01) printfInfo("\tI3C Parity Error2\n");
+		if ((dev >> 46) & 0x01) printfInfo("\tINIT Bus ID Error\n");
+		if ((dev >> 47) & 0x01) printfInfo("\tI3C Parity Error1\n");
 		err = (dev >> 48) & 0x03;
-		printf("\tAuthentication mode:\n");
-		printf("\t\t");
+		printfInfo("\tAuthentication mode:\n");
+		printfInfo("\t\t");
 		switch (err) {
 			case 3:
 			case 0:
-				printf("No Auth\n");
+				printfInfo("No Auth\n");
 				break;
 			case 1:
-				printf("ECDSA\n");
+				printfInfo("ECDSA\n");
 				break;
 			case 2:
-				printf("HMAC\n");
+				printfInfo("HMAC\n");
 				break;
 		}
-		if ((dev >> 50) & 0x01) printf("\tAuthentication Done\n");
-		if ((dev >> 51) & 0x01) printf("\tDry Run Authentication Done\n");
+		if ((dev >> 50) & 0x01) printfInfo("\tAuthentication Done\n");
+		if ((dev >> 51) & 0x01) printfInfo("\tDry Run Authentication Done\n");
 #endif
 }
 
@@ -1102,7 +1109,7 @@ bool Lattice::pollBusyFlag(bool verbose)
 		_jtag->set_state(Jtag::RUN_TEST_IDLE);
 		_jtag->toggleClk(1000);
 		if (verbose)
-			printf("pollBusyFlag :%02x\n", rx);
+			printfInfo("pollBusyFlag :%02x\n", rx);
 		if (timeout == 100000000){
 			cerr << "timeout" << endl;
 			return false;
@@ -1151,7 +1158,8 @@ bool Lattice::flashProg(uint32_t start_addr, const string &name, vector<string>
 		wr_rd(PROG_CFG_FLASH, (uint8_t *)data[line].c_str(),
 				16, NULL, 0);
 		_jtag->set_state(Jtag::RUN_TEST_IDLE);
-		_jtag->toggleClk(1000);
+		/* RUNTEST IDLE 2 TCK 2.00E-04 SEC */
+		_jtag->delay(200000, 2);
 		progress.display(line);
 		if (pollBusyFlag() == false)
 			return false;
@@ -1162,7 +1170,7 @@ bool Lattice::flashProg(uint32_t start_addr, const string &name, vector<string>
 
 bool Lattice::Verify(std::vector<std::string> data, bool unlock, uint32_t flash_area)
 {
-	uint8_t tx_buf[16], rx_buf[16];
+	uint8_t tx_buf[16];
 	if (unlock)
 		EnableISC(0x08);
 
@@ -1184,23 +1192,40 @@ bool Lattice::Verify(std::vector<std::string> data, bool unlock, uint32_t flash_
 
 	memset(tx_buf, 0, 16);
 	bool failure = false;
+	/* rows are read by batch: scans are queued and
+	 * all TDO are received with a single execute
+	 */
+	const size_t batch = 128;
+	std::vector<uint8_t> rx_buf(batch * 16);
 	ProgressBar progress("Verifying", data.size(), 50, _quiet);
-	for (size_t line = 0;  line< data.size(); line++) {
-		_jtag->set_state(Jtag::RUN_TEST_IDLE);
-		_jtag->toggleClk(2);
-		_jtag->shiftDR(tx_buf, rx_buf, 16*8, Jtag::PAUSE_DR);
-		for (size_t i = 0; i < data[line].size(); i++) {
-			if (rx_buf[i] != (unsigned char)data[line][i]) {
-				printf("%3zu %3zu %02x -> %02x\n", line, i,
-						rx_buf[i], (unsigned char)data[line][i]);
-				failure = true;
-			}
+	for (size_t first = 0; first < data.size() && !failure; first += batch) {
+		size_t nb_lines = std::min(batch, data.size() - first);
+		for (size_t l = 0; l < nb_lines; l++) {
+			_jtag->set_state(Jtag::RUN_TEST_IDLE);
+			_jtag->toggleClk(2);
+			_jtag->queue_shiftDR(tx_buf, &rx_buf[l * 16], 16*8,
+				Jtag::PAUSE_DR);
 		}
-		if (failure) {
-			printf("Verify Failure\n");
+		if (_jtag->execute() < 0) {
+			failure = true;
 			break;
 		}
-		progress.display(line);
+		for (size_t l = 0; l < nb_lines; l++) {
+			size_t line = first + l;
+			uint8_t *rx = &rx_buf[l * 16];
+			for (size_t i = 0; i < data[line].size(); i++) {
+				if (rx[i] != (unsigned char)data[line][i]) {
+					printfInfo("%3zu %3zu %02x -> %02x\n", line, i,
+							rx[i], (unsigned char)data[line][i]);
+					failure = true;
+				}
+			}
+			if (failure) {
+				printfInfo("Verify Failure\n");
+				break;
+			}
+			progress.display(line);
+		}
 	}
 	if (unlock)
 		DisableISC();
@@ -1337,10 +1362,8 @@ int Lattice::spi_put(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint32_t len)
 
 	jtx[0] = LatticeBitParser::reverseByte(cmd);
 
-	if (tx) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i+1] = LatticeBitParser::reverseByte(tx[i]);
-	}
+	if (tx)
+		bit_reverse_bytes(jtx + 1, tx, len);
 
 	/* send first already stored cmd,
 	 * in the same time store each byte
@@ -1348,10 +1371,8 @@ int Lattice::spi_put(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint32_t len)
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = LatticeBitParser::reverseByte(jrx[i+1]);
-	}
+	if (rx != NULL)
+		bit_reverse_bytes(rx, jrx + 1, len);
 	return 0;
 }
 
@@ -1361,10 +1382,8 @@ int Lattice::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	uint8_t jtx[xfer_len];
 	uint8_t jrx[xfer_len];
 
-	if (tx) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i] = LatticeBitParser::reverseByte(tx[i]);
-	}
+	if (tx)
+		bit_reverse_bytes(jtx, tx, len);
 
 	/* send first already stored cmd,
 	 * in the same time store each byte
@@ -1372,10 +1391,8 @@ int Lattice::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = LatticeBitParser::reverseByte(jrx[i]);
-	}
+	if (rx != NULL)
+		bit_reverse_bytes(rx, jrx, len);
 	return 0;
 }
 
@@ -1399,17 +1416,17 @@ int Lattice::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		tmp = (LatticeBitParser::reverseByte(rx));
 		count++;
 		if (count == timeout){
-			printf("timeout: %x %x %u\n", tmp, rx, count);
+			printfInfo("timeout: %x %x %u\n", tmp, rx, count);
 			break;
 		}
 
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			printfInfo("%x %x %x %u\n", tmp, mask, cond, count);
 		}
 	} while ((tmp & mask) != cond);
 	_jtag->shiftDR(dummy, &rx, 8, Jtag::RUN_TEST_IDLE);
 	if (count == timeout) {
-		printf("%x\n", tmp);
+		printfInfo("%x\n", tmp);
 		std::cout << "wait: Error" << std::endl;
 		return -ETIME;
 	}
@@ -1428,11 +1445,11 @@ bool Lattice::programFeatureRow_MachXO3D(uint8_t* feature_row)
 		tx[i] = feature_row[i];
 
 	if (_verbose) {
-		printf("\tProgramming feature row: [0x");
+		printfInfo("\tProgramming feature row: [0x");
 		for (int i = 11; i >= 0; i--) {
-			printf("%02x", feature_row[i]);
+			printfInfo("%02x", feature_row[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	wr_rd(PROG_FEATURE_ROW, tx, 16, NULL, 0);
@@ -1450,17 +1467,17 @@ bool Lattice::programFeatureRow_MachXO3D(uint8_t* feature_row)
 	}
 
 	if (_verbose) {
-		printf("\tReadback Feature Row: [0x");
+		printfInfo("\tReadback Feature Row: [0x");
 		for(int i = 11; i >= 0; i--) {
-			printf("%02x", rx[i]);
+			printfInfo("%02x", rx[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	if (_verify) {
 		for(int i = 0; i < 15; i++) {
 			if (feature_row[i] != rx[i]) {
-				printf("\tVerify Failed...\n");
+				printfInfo("\tVerify Failed...\n");
 				return false;
 			}
 		}
@@ -1480,11 +1497,11 @@ bool Lattice::programFeabits_MachXO3D(uint32_t feabits)
 	}
 
 	if (_verbose) {
-		printf("\tProgramming FEAbits: [0x");
+		printfInfo("\tProgramming FEAbits: [0x");
 		for (int i = 3; i >= 0; i--) {
-			printf("%02x", tx[i]);
+			printfInfo("%02x", tx[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	wr_rd(PROG_FEABITS, tx, 4, NULL, 0);
@@ -1502,17 +1519,17 @@ bool Lattice::programFeabits_MachXO3D(uint32_t feabits)
 	}
 
 	if (_verbose) {
-		printf("\tReadback Feabits: [0x");
+		printfInfo("\tReadback Feabits: [0x");
 		for(int i = 4; i >= 0; i--) {
-			printf("%02x", rx[i]);
+			printfInfo("%02x", rx[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	if (_verify) {
 		for(int i = 0; i < 4; i++) {
 			if (((feabits >> (8*i)) & 0xff) != rx[i]) {
-				printf("\tVerify Failed...\n");
+				printfInfo("\tVerify Failed...\n");
 				return false;
 			}
 		}
@@ -1528,11 +1545,11 @@ bool Lattice::programPubKey_MachXO3D(uint8_t* pubkey)
 	int i;
 
 	if (_verbose) {
-		printf("\tProgramming ECDSA PubKey: [");
+		printfInfo("\tProgramming ECDSA PubKey: [");
 		for (i = 0; i < PUBKEY_LENGTH_BYTES; i++) {
-			printf("%02x", pubkey[i]);
+			printfInfo("%02x", pubkey[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	for(i = 0; i < 16; i++) {
@@ -1599,18 +1616,18 @@ bool Lattice::programPubKey_MachXO3D(uint8_t* pubkey)
 	}
 
 	if (_verbose) {
-		printf("Readback PubKey: [");
+		printfInfo("Readback PubKey: [");
 		for (i=PUBKEY_LENGTH_BYTES-1; i >= 0; i--) {
-			printf("%02x", rxkey[i]);
-			if (i && (i%16 == 0)) printf(" ");
+			printfInfo("%02x", rxkey[i]);
+			if (i && (i%16 == 0)) printfInfo(" ");
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	if (_verify) {
 		for (int i = 0; i < PUBKEY_LENGTH_BYTES; i++) {
 			if (pubkey[i] != rxkey[PUBKEY_LENGTH_BYTES - i - 1]) {
-				printf("\tVerify Failed...\n");
+				printfInfo("\tVerify Failed...\n");
 				return false;
 			}
 		}
@@ -1659,11 +1676,11 @@ bool Lattice::program_fea_MachXO3D()
 	_jtag->toggleClk(2);
 
 	if (_verbose) {
-		printf("Read Feature Row: [0x");
+		printfInfo("Read Feature Row: [0x");
 		for(int i = 11; i >= 0; i--) {
-			printf("%02x", rx[i]);
+			printfInfo("%02x", rx[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	uint8_t* feature_row = (uint8_t*)_fea.featuresRow();
@@ -1679,11 +1696,11 @@ bool Lattice::program_fea_MachXO3D()
 	_jtag->toggleClk(2);
 
 	if (_verbose) {
-		printf("Read Feabits: [0x");
+		printfInfo("Read Feabits: [0x");
 		for(int i = 4; i >= 0; i--) {
-			printf("%02x", rx[i]);
+			printfInfo("%02x", rx[i]);
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	for (int i = 0; i < 4; i++) {
@@ -1691,13 +1708,13 @@ bool Lattice::program_fea_MachXO3D()
 			same = false;
 	}
 
-	printf("Feature Row / Feabits Compare: %s\n", same ? "Same" : "Different");
+	printfInfo("Feature Row / Feabits Compare: %s\n", same ? "Same" : "Different");
 	if (same == false) {
 		/* LSC_INIT_ADDRESS */
 		tx[0] = (uint8_t)((FLASH_SEC_FEA >> 8) & 0xff);
 		tx[1] = (uint8_t)((FLASH_SEC_FEA >> 16) & 0xff);
 		if (_verbose)
-			printf("Selected address (I): 0x%x 0x%x\n", tx[0], tx[1]);
+			printfInfo("Selected address (I): 0x%x 0x%x\n", tx[0], tx[1]);
 		wr_rd(RESET_CFG_ADDR, tx, 2, NULL, 0);
 
 		/* ISC ERASE */
@@ -1799,7 +1816,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 		}
 
 		if (note == "END CONFIG DATA") {
-			printf("Processing PADDING data (offset: %d (0x%x))\n", offset, offset);
+			printfInfo("Processing PADDING data (offset: %d (0x%x))\n", offset, offset);
 			/* PADDING - this should be padding to CFGx area that we're currently
 			 * programming therefore the flash area will already have been erased...
 			 * NOTE: We have to write this data if we're using bitstream authentication
@@ -1818,10 +1835,10 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 
 			/* offset should not be zero */
 			if (offset == 0) {
-				printf("Warning: offset (%d) is for programming PADDING\n", offset);
+				printfInfo("Warning: offset (%d) is for programming PADDING\n", offset);
 			}
 		} else if (note == "EBR_INIT DATA") {
-			printf("Processing EBR_INIT data (offset: %d (0x%x))\n", offset, offset);
+			printfInfo("Processing EBR_INIT data (offset: %d (0x%x))\n", offset, offset);
 			/* EBR - Embedded Block RAM initialisation data */
 			if (offset == 0) {
 				if (_flash_sector == LATTICE_FLASH_CFG0) {
@@ -1838,7 +1855,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 				continue;
 			}
 		} else if (note.compare(0, 16, "USER MEMORY DATA") == 0) {
-			printf("Processing UFM data (offset: %d (0x%x))\n", offset, offset);
+			printfInfo("Processing UFM data (offset: %d (0x%x))\n", offset, offset);
 			if ((_flash_sector == LATTICE_FLASH_CFG0)||
 						(_flash_sector == LATTICE_FLASH_UFM0)) {
 				if (offset == 0) {
@@ -1887,7 +1904,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 				area_name = "UFM3";
 			}
 		} else {
-			printf("Processing CFG data (offset: %d (0x%x))\n", offset, offset);
+			printfInfo("Processing CFG data (offset: %d (0x%x))\n", offset, offset);
 			if (_flash_sector == LATTICE_FLASH_CFG0) {
 				erase_op = FLASH_SEC_CFG0;
 				prog_op = FLASH_SEC_CFG0;
@@ -1900,7 +1917,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 
 			/* offset should be zero */
 			if (offset != 0) {
-				printf("Warning: offset (%d) is not 0 for programming CFG\n", offset);
+				printfInfo("Warning: offset (%d) is not 0 for programming CFG\n", offset);
 			}
 		}
 
@@ -1920,7 +1937,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 				(uint8_t)((prog_op >> 8) & 0xff),
 				(uint8_t)((prog_op >> 16) & 0xff)
 			};
-			printf("address (I): 0x%x 0x%x\n", tx[0], tx[1]);
+			printfInfo("address (I): 0x%x 0x%x\n", tx[0], tx[1]);
 			wr_rd(RESET_CFG_ADDR, tx, 2, NULL, 0);
 		} else {
 			/* LSC_WRITE_ADDRESS */
@@ -1929,7 +1946,7 @@ bool Lattice::program_intFlash_MachXO3D(JedParser& _jed)
 				(uint8_t)((prog_op >> 8) & 0xff),
 				(uint8_t)((prog_op >> 16) & 0x03)
 			};
-			printf("address (W): 0x%x 0x%x 0x%x\n", tx[0], tx[1], tx[2]);
+			printfInfo("address (W): 0x%x 0x%x 0x%x\n", tx[0], tx[1], tx[2]);
 			wr_rd(LSC_WRITE_ADDRESS, tx, 3, NULL, 0);
 		}
 		_jtag->set_state(Jtag::RUN_TEST_IDLE);
@@ -2015,7 +2032,7 @@ bool Lattice::program_pubkey_MachXO3D()
 	if (data[0] == 0x0f && data[1] == 0xf0) {
 		for (i = 2; i < len; i++) {
 			if (data[i] == 0xf0 && data[i+1] == 0x0f) {
-				if (_verbose) printf("Header: [%.*s]\n", i-2, ((char *)data)+2);
+				if (_verbose) printfInfo("Header: [%.*s]\n", i-2, ((char *)data)+2);
 				i+=2;
 				break;
 			}
@@ -2039,20 +2056,20 @@ bool Lattice::program_pubkey_MachXO3D()
 		0x63: 9da5a124050789520f4a616e3a27bc7d
 */
 		if (_verbose) {
-			printf("PubKey: [");
+			printfInfo("PubKey: [");
 			for (j=0; j < PUBKEY_LENGTH_BYTES; j++) {
-				if (j && (j%16 == 0)) printf(" ");
-				printf("%02x", pubkey[j]);
+				if (j && (j%16 == 0)) printfInfo(" ");
+				printfInfo("%02x", pubkey[j]);
 			}
-			printf("]\n");
+			printfInfo("]\n");
 		}
 
 		if (_verbose) {
-			printf("Trailing bytes: [");
+			printfInfo("Trailing bytes: [");
 			for (; i < len; i++) {
-				printf("%02x ", data[i]);
+				printfInfo("%02x ", data[i]);
 			}
-			printf("\b]\n");
+			printfInfo("\b]\n");
 		}
 	}
 	else {
@@ -2091,12 +2108,12 @@ bool Lattice::program_pubkey_MachXO3D()
 	_jtag->toggleClk(2);
 
 	if (_verbose) {
-		printf("Read PubKey: [");
+		printfInfo("Read PubKey: [");
 		for (j=PUBKEY_LENGTH_BYTES-1; j >= 0; j--) {
-			printf("%02x", rxkey[j]);
-			if (j && (j%16 == 0)) printf(" ");
+			printfInfo("%02x", rxkey[j]);
+			if (j && (j%16 == 0)) printfInfo(" ");
 		}
-		printf("]\n");
+		printfInfo("]\n");
 	}
 
 	for (int i = 0; i < PUBKEY_LENGTH_BYTES; i++) {
@@ -2104,14 +2121,14 @@ bool Lattice::program_pubkey_MachXO3D()
 			same = false;
 	}
 
-	printf("PubKey Compare: %s\n", same ? "Same" : "Different");
+	printfInfo("PubKey Compare: %s\n", same ? "Same" : "Different");
 	if (same == false) {
 		uint8_t tx[2];
 		/* LSC_INIT_ADDRESS */
 		tx[0] = (uint8_t)((FLASH_SEC_PKEY >> 8) & 0xff);
 		tx[1] = (uint8_t)((FLASH_SEC_PKEY >> 16) & 0xff);
 		if (_verbose)
-			printf("Selected address (I): 0x%x 0x%x\n", tx[0], tx[1]);
+			printfInfo("Selected address (I): 0x%x 0x%x\n", tx[0], tx[1]);
 		wr_rd(RESET_CFG_ADDR, tx, 2, NULL, 0);
 
 		/* ISC ERASE */
@@ -2156,7 +2173,7 @@ bool Lattice::program_pubkey_MachXO3D()
 		_jtag->set_state(Jtag::RUN_TEST_IDLE);
 		_jtag->toggleClk(2);
 
-		printf("Auth Mode: [%s] (0x%x)\n", (rxkey[1] & 0x03 ? "ECDSA Signature Verification" : rxkey[1] & 0x01 ? "HMAC Authentication" : "No Authentication"), rxkey[1] & 0x03);
+		printfInfo("Auth Mode: [%s] (0x%x)\n", (rxkey[1] & 0x03 ? "ECDSA Signature Verification" : rxkey[1] & 0x01 ? "HMAC Authentication" : "No Authentication"), rxkey[1] & 0x03);
 	}
 
 	/* ISC program done 0x5E */
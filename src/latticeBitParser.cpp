@@ -40,7 +40,7 @@ int LatticeBitParser::parseHeader()
 	/* radiant .bit start with LSCC */
 	if (_raw_data[0] == 'L') {
 		if (_raw_data.substr(0, 4) != "LSCC") {
-			printf("Wrong File %s\n", _raw_data.substr(0, 4).c_str());
+			printfInfo("Wrong File %s\n", _raw_data.substr(0, 4).c_str());
 			return EXIT_FAILURE;
 		}
 		currPos += 4;
@@ -49,7 +49,7 @@ int LatticeBitParser::parseHeader()
 	/* bit file comment area start with 0xff00 */
 	if ((uint8_t)_raw_data[currPos] != 0xff ||
 			(uint8_t)_raw_data[currPos + 1] != 0x00) {
-		printf("Wrong File %02x%02x\n", (uint8_t) _raw_data[currPos],
+		printfInfo("Wrong File %02x%02x\n", (uint8_t) _raw_data[currPos],
 			(uint8_t)_raw_data[currPos]);
 		return EXIT_FAILURE;
 	}
@@ -26,7 +26,7 @@
 #ifdef DEBUG
 #define display(...) \
 	do { \
-		if (_verbose) fprintf(stdout, __VA_ARGS__); \
+		if (_verbose) printfInfo(__VA_ARGS__); \
 	}while(0)
 #else
 #define display(...) do {}while(0)
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "libopenFPGALoader.h"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+#include "cable.hpp"
+#include "configBitstreamParser.hpp"
+#include "device.hpp"
+#include "display.hpp"
+#include "jtag.hpp"
+#include "session.hpp"
+
+#define DEFAULT_FREQ 	6000000
+
+struct ofl_ctx {
+	Jtag *jtag;
+	struct arguments args; /* cable configuration and default options */
+	std::string log;
+};
+
+/* redirect messages to ctx log during a call */
+class LogCapture {
+ public:
+	explicit LogCapture(ofl_ctx_t *ctx) {
+		ctx->log.clear();
+		setThreadLog(&ctx->log);
+	}
+	~LogCapture() { setThreadLog(NULL); }
+};
+
+/* run one operation with args based on ctx defaults */
+static int run_op(ofl_ctx_t *ctx, struct arguments &args)
+{
+	try {
+		return (run_jtag_session(args, ctx->jtag) == EXIT_SUCCESS) ? 0 : -1;
+	} catch (std::exception &e) {
+		printError("Error: " + std::string(e.what()));
+	}
+	return -1;
+}
+
+ofl_ctx_t *ofl_open(const char *cable, const char *serial, uint32_t freq,
+	int verbose)
+{
+	if (!cable)
+		return NULL;
+
+	auto select_cable = cable_list.find(cable);
+	if (select_cable == cable_list.end())
+		return NULL;
+	cable_t cable_cfg = select_cable->second;
+
+	ofl_ctx_t *ctx = new ofl_ctx_t();
+	ctx->args = default_arguments;
+	ctx->args.cable = cable;
+	ctx->args.ftdi_serial = (serial) ? serial : "";
+	ctx->args.freq = (freq) ? freq : DEFAULT_FREQ;
+	ctx->args.verbose = verbose;
+	cable_cfg.config.index = ctx->args.cable_index;
+	cable_cfg.config.status_pin = ctx->args.status_pin;
+
+	jtag_pins_conf_t pins_config = {0, 0, 0, 0};
+
+	LogCapture capture(ctx);
+	try {
+		ctx->jtag = new Jtag(cable_cfg, &pins_config, ctx->args.device,
+			ctx->args.ftdi_serial, ctx->args.freq, ctx->args.verbose,
+			ctx->args.ip_adr, ctx->args.port, ctx->args.invert_read_edge,
+			ctx->args.probe_firmware, ctx->args.chain_cache);
+	} catch (std::exception &e) {
+		printError("JTAG init failed with: " + std::string(e.what()));
+		delete ctx;
+		return NULL;
+	}
+	return ctx;
+}
+
+int ofl_set_option(ofl_ctx_t *ctx, const char *name, const char *value)
+{
+	if (!ctx)
+		return -1;
+	LogCapture capture(ctx);
+	if (!name) {
+		printError("Error: option not specified");
+		return -1;
+	}
+	std::string opt(name);
+	std::string val = (value) ? value : "";
+	if (opt == "fpga-part") {
+		ctx->args.fpga_part = val;
+	} else if (opt == "bridge") {
+		ctx->args.bridge_path = val;
+	} else if (opt == "file-type") {
+		ctx->args.file_type = val;
+	} else if (opt == "board") {
+		auto board = board_list.find(val);
+		if (value && board == board_list.end()) {
+			printError("Error: cannot find board \'" + val + "\'");
+			return -1;
+		}
+		/* same as command line: fpga-part set by user has priority
+		 * over board default
+		 */
+		auto prev = board_list.find(ctx->args.board);
+		if (ctx->args.fpga_part.empty() || (prev != board_list.end() &&
+				ctx->args.fpga_part == prev->second.fpga_part))
+			ctx->args.fpga_part = (value) ? board->second.fpga_part : "";
+		ctx->args.board = (value) ? val : default_arguments.board;
+	} else {
+		printError("Error: unknown option " + opt);
+		return -1;
+	}
+	return 0;
+}
+
+void ofl_close(ofl_ctx_t *ctx)
+{
+	if (!ctx)
+		return;
+	delete ctx->jtag;
+	delete ctx;
+}
+
+int ofl_detect(ofl_ctx_t *ctx, uint32_t *idcodes, int max)
+{
+	if (!ctx)
+		return -1;
+	LogCapture capture(ctx);
+	int found;
+	try {
+		found = ctx->jtag->detectChain(16);
+	} catch (std::exception &e) {
+		printError("Error: " + std::string(e.what()));
+		return -1;
+	}
+	if (found < 0)
+		return -1;
+
+	std::vector<int> list = ctx->jtag->get_devices_list();
+	for (int i = 0; idcodes && i < found && i < max; i++)
+		idcodes[i] = list[i];
+	return found;
+}
+
+int ofl_program(ofl_ctx_t *ctx, int index, const char *bitfile,
+	int to_flash, uint32_t offset, int verify)
+{
+	if (!ctx)
+		return -1;
+	LogCapture capture(ctx);
+	if (!bitfile) {
+		printError("Error: bitfile not specified");
+		return -1;
+	}
+	struct arguments args = ctx->args;
+	args.index_chain = index;
+	args.bit_file = bitfile;
+	args.prg_type = (to_flash) ? Device::WR_FLASH : Device::WR_SRAM;
+	args.offset = offset;
+	args.verify = verify != 0;
+	return run_op(ctx, args);
+}
+
+int ofl_dump_flash(ofl_ctx_t *ctx, int index, const char *filename,
+	uint32_t offset, uint32_t size)
+{
+	if (!ctx)
+		return -1;
+	LogCapture capture(ctx);
+	if (!filename) {
+		printError("Error: output file not specified");
+		return -1;
+	}
+	struct arguments args = ctx->args;
+	args.index_chain = index;
+	args.bit_file = filename;
+	args.prg_type = Device::RD_FLASH;
+	args.offset = offset;
+	args.file_size = size;
+	return run_op(ctx, args);
+}
+
+int ofl_reset(ofl_ctx_t *ctx, int index)
+{
+	if (!ctx)
+		return -1;
+	LogCapture capture(ctx);
+	struct arguments args = ctx->args;
+	args.index_chain = index;
+	args.reset = true;
+	return run_op(ctx, args);
+}
+
+void ofl_set_file_cache(int enable)
+{
+	ConfigBitstreamParser::setFileCache(enable != 0);
+}
+
+const char *ofl_get_log(ofl_ctx_t *ctx)
+{
+	return (ctx) ? ctx->log.c_str() : "";
+}
+
+const char *ofl_version(void)
+{
+	return VERSION;
+}
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_LIBOPENFPGALOADER_H_
+#define SRC_LIBOPENFPGALOADER_H_
+
+#include <stdint.h>
+
+/*!
+ * \file libopenFPGALoader.h
+ * \brief C interface to openFPGALoader JTAG operations. A context keeps
+ *        one cable opened between calls (no USB enumeration, cable
+ *        configuration and chain detection for each operation).
+ *        Functions return 0 on success and -1 on failure (including
+ *        a NULL context), messages are available with ofl_get_log()
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ofl_ctx ofl_ctx_t;
+
+/*!
+ * \brief open a JTAG cable and detect chain
+ * \param[in] cable: cable name (same as --cable)
+ * \param[in] serial: FTDI serial number or NULL
+ * \param[in] freq: JTAG frequency in Hz (0: default)
+ * \param[in] verbose: verbosity level (-1: quiet, 0: normal, 1: verbose)
+ * \return context or NULL
+ */
+ofl_ctx_t *ofl_open(const char *cable, const char *serial, uint32_t freq,
+	int verbose);
+
+/*!
+ * \brief set an option used by following operations (same as
+ *        command line option with the same name)
+ * \param[in] name: "fpga-part" (Xilinx/Altera/Efinix package),
+ *            "bridge" (spiOverJtag bitstream), "board" (board name:
+ *            default fpga-part) or "file-type"
+ * \param[in] value: option value, NULL to restore default
+ */
+int ofl_set_option(ofl_ctx_t *ctx, const char *name, const char *value);
+
+/*!
+ * \brief close cable and free context
+ */
+void ofl_close(ofl_ctx_t *ctx);
+
+/*!
+ * \brief rescan JTAG chain
+ * \param[out] idcodes: devices idcodes (may be NULL)
+ * \param[in] max: idcodes size
+ * \return number of devices or -1
+ */
+int ofl_detect(ofl_ctx_t *ctx, uint32_t *idcodes, int max);
+
+/*!
+ * \brief load a bitstream
+ * \param[in] index: device position in the chain (-1: only FPGA)
+ * \param[in] bitfile: bitstream file
+ * \param[in] to_flash: 0 to load SRAM, 1 to write flash
+ * \param[in] offset: flash offset
+ * \param[in] verify: verify flash content after write
+ */
+int ofl_program(ofl_ctx_t *ctx, int index, const char *bitfile,
+	int to_flash, uint32_t offset, int verify);
+
+/*!
+ * \brief read flash content
+ * \param[in] index: device position in the chain (-1: only FPGA)
+ * \param[in] filename: output file
+ * \param[in] offset: flash offset
+ * \param[in] size: number of bytes to read
+ */
+int ofl_dump_flash(ofl_ctx_t *ctx, int index, const char *filename,
+	uint32_t offset, uint32_t size);
+
+/*!
+ * \brief reset FPGA (reload configuration)
+ * \param[in] index: device position in the chain (-1: only FPGA)
+ */
+int ofl_reset(ofl_ctx_t *ctx, int index);
+
+/*!
+ * \brief keep bitstreams in memory: a file loaded by more than one
+ *        ofl_program() call is read once
+ */
+void ofl_set_file_cache(int enable);
+
+/*!
+ * \brief messages produced by last call (valid until next call)
+ */
+const char *ofl_get_log(ofl_ctx_t *ctx);
+
+/*!
+ * \brief library version string
+ */
+const char *ofl_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SRC_LIBOPENFPGALOADER_H_ */
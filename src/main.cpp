@@ -3,37 +3,47 @@
  * Copyright (C) 2019 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
-#include "altera.hpp"
-#include "anlogic.hpp"
 #include "board.hpp"
 #include "cable.hpp"
+#include "configBitstreamParser.hpp"
 #include "colognechip.hpp"
 #include "cxxopts.hpp"
+#ifdef ENABLE_DAEMON
+#include "daemonSocket.hpp"
+#endif
 #include "device.hpp"
 #include "dfu.hpp"
 #include "display.hpp"
 #include "efinix.hpp"
 #include "ftdispi.hpp"
-#include "gowin.hpp"
 #include "ice40.hpp"
-#include "lattice.hpp"
+#include "jobManifest.hpp"
 #include "libusb_ll.hpp"
 #include "jtag.hpp"
 #include "part.hpp"
+#include "progressBar.hpp"
 #include "spiFlash.hpp"
 #include "rawParser.hpp"
-#include "xilinx.hpp"
-#include "svf_jtag.hpp"
+#include "session.hpp"
+#include "traceEvent.hpp"
+#include "transportStats.hpp"
 #ifdef ENABLE_XVC
 #include "xvc_server.hpp"
 #endif
@@ -42,56 +52,23 @@
 
 using namespace std;
 
-struct arguments {
-	int8_t verbose;
-	bool reset, detect, verify, scan_usb;
-	unsigned int offset;
-	string bit_file;
-	string secondary_bit_file;
-	string device;
-	string cable;
-	string ftdi_serial;
-	int ftdi_channel;
-	int status_pin;
-	uint32_t freq;
-	bool invert_read_edge;
-	string board;
-	bool pin_config;
-	bool list_cables;
-	bool list_boards;
-	bool list_fpga;
-	Device::prog_type_t prg_type;
-	bool is_list_command;
-	bool spi;
-	bool dfu;
-	string file_type;
-	string fpga_part;
-	string bridge_path;
-	string probe_firmware;
-	int index_chain;
-	unsigned int file_size;
-	string target_flash;
-	bool external_flash;
-	int16_t altsetting;
-	uint16_t vid;
-	uint16_t pid;
-	int16_t cable_index;
-	uint8_t bus_addr;
-	uint8_t device_addr;
-	string ip_adr;
-	uint32_t protect_flash;
-	bool unprotect_flash;
-	bool bulk_erase_flash;
-	string flash_sector;
-	bool skip_load_bridge;
-	bool skip_reset;
-	/* xvc server */
-	bool xvc;
-	int port;
-	string interface;
-	string mcufw;
-	bool conmcu;
-};
+/* --stats output file (used by atexit handler) */
+static string stats_file;
+
+static void write_stats()
+{
+	if (!stats_write(stats_file))
+		printError("Error: can't write stats to " + stats_file);
+}
+
+/* --trace-file output file (used by atexit handler) */
+static string trace_file;
+
+static void write_trace()
+{
+	if (!trace_write(trace_file))
+		printError("Error: can't write trace to " + trace_file);
+}
 
 int run_xvc_server(const struct arguments &args, const cable_t &cable,
 	const jtag_pins_conf_t *pins_config);
@@ -101,26 +78,24 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 
 void displaySupported(const struct arguments &args);
 
+int run_session(struct arguments &args, jtag_pins_conf_t &pins_config);
+
+int run_manifest(const struct arguments &args, Jtag *jtag);
+
+int run_multi_cable(const struct arguments &default_args);
+
+#ifdef ENABLE_DAEMON
+int run_daemon(const struct arguments &args, Jtag *jtag);
+
+int run_daemon_client(const struct arguments &args, int argc, char **argv);
+#endif
+
 int main(int argc, char **argv)
 {
-	cable_t cable;
-	target_board_t *board = NULL;
 	jtag_pins_conf_t pins_config = {0, 0, 0, 0};
 
 	/* command line args. */
-	struct arguments args = {0, false, false, false, false, 0, "", "", "", "-", "", -1,
-			-1, 0, false, "-", false, false, false, false, Device::PRG_NONE, false,
-			/* spi dfu    file_type fpga_part bridge_path probe_firmware */
-			false, false, "",       "",       "",         "",
-			/* index_chain file_size target_flash external_flash altsetting */
-			-1,            0,        "primary",   false,         -1,
-			/* vid, pid, index bus_addr, device_addr */
-			    0,   0,   -1,     0,         0,
-			"127.0.0.1", 0, false, false, "", false, false,
-			/* xvc server */
-			false, 3721, "-",
-			"", false,  // mcufw conmcu
-	};
+	struct arguments args = default_arguments;
 	/* parse arguments */
 	try {
 		if (parse_opt(argc, argv, &args, &pins_config))
@@ -130,15 +105,45 @@ int main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
+#ifdef ENABLE_DAEMON
+	/* job executed by a daemon */
+	if (!args.connect_socket.empty())
+		return run_daemon_client(args, argc, argv);
+#endif
+
+	if (!args.stats_file.empty()) {
+		stats_file = args.stats_file;
+		stats_enable();
+		atexit(write_stats);
+	}
+
+	if (!args.trace_file.empty()) {
+		trace_file = args.trace_file;
+		trace_enable();
+		atexit(write_trace);
+	}
+
 	if (args.is_list_command) {
 		displaySupported(args);
 		return EXIT_SUCCESS;
 	}
 
+	if (!args.multi_cable_file.empty())
+		return run_multi_cable(args);
+
+	return run_session(args, pins_config);
+}
+
+/* one cable/target: all operations requested by args */
+int run_session(struct arguments &args, jtag_pins_conf_t &pins_config)
+{
+	cable_t cable;
+	target_board_t *board = NULL;
+
 	if (args.prg_type == Device::WR_SRAM)
-		cout << "write to ram" << endl;
+		printInfo("write to ram");
 	if (args.prg_type == Device::WR_FLASH)
-		cout << "write to flash" << endl;
+		printInfo("write to flash");
 
 	if (args.board[0] != '-') {
 		if (board_list.find(args.board) != board_list.end()) {
@@ -166,7 +171,7 @@ int main(int argc, char **argv)
 			if (args.cable[0] == '-') {  // no user selection
 				args.cable = (*t).first;  // use board default cable
 			} else {
-				cout << "Board default cable overridden with " << args.cable << endl;
+				printInfo("Board default cable overridden with " + args.cable);
 			}
 		}
 
@@ -244,6 +249,21 @@ int main(int argc, char **argv)
 	cable.config.index = args.cable_index;
 	cable.config.status_pin = args.status_pin;
 
+	if (!args.manifest_file.empty() && (args.spi || args.dfu || args.xvc ||
+			!args.daemon_socket.empty() ||
+			(board && board->mode != COMM_JTAG))) {
+		printError("Error: manifest is only available for JTAG sessions");
+		return EXIT_FAILURE;
+	}
+
+#ifdef ENABLE_DAEMON
+	if (!args.daemon_socket.empty() && (args.spi || args.dfu || args.xvc ||
+			(board && board->mode != COMM_JTAG))) {
+		printError("Error: daemon mode is only available for JTAG");
+		return EXIT_FAILURE;
+	}
+#endif
+
 	/* FLASH direct access */
 	if (args.spi || (board && board->mode == COMM_SPI)) {
 		/* if no instruction from user -> select flash mode */
@@ -256,6 +276,7 @@ int main(int argc, char **argv)
 			pins_config = board->spi_pins_config;
 
 		try {
+			TraceSpan span("open cable", "phase");
 			spi = new FtdiSpi(cable, pins_config, args.freq, args.verbose);
 		} catch (std::exception &e) {
 			printError("Error: Failed to claim cable");
@@ -287,11 +308,13 @@ int main(int argc, char **argv)
 				if (args.file_size == 0) {
 					printError("Error: 0 size for dump");
 				} else {
+					TraceSpan span("Device::dumpFlash", "device");
 					target->dumpFlash(args.offset, args.file_size);
 				}
 			} else if ((args.prg_type == Device::WR_FLASH ||
 						args.prg_type == Device::WR_SRAM) ||
 						!args.bit_file.empty() || !args.file_type.empty()) {
+				TraceSpan span("Device::program", "device");
 				target->program(args.offset, args.unprotect_flash);
 			}
 			if (args.unprotect_flash && args.bit_file.empty())
@@ -438,198 +461,571 @@ int main(int argc, char **argv)
 	/* jtag base */
 
 
-	/* if no instruction from user -> select load */
-	if (args.prg_type == Device::PRG_NONE)
-		args.prg_type = Device::WR_SRAM;
-
 	Jtag *jtag;
 	try {
+		TraceSpan span("open cable", "phase");
 		jtag = new Jtag(cable, &pins_config, args.device, args.ftdi_serial,
 				args.freq, args.verbose, args.ip_adr, args.port,
-				args.invert_read_edge, args.probe_firmware);
+				args.invert_read_edge, args.probe_firmware, args.chain_cache);
 	} catch (std::exception &e) {
 		printError("JTAG init failed with: " + string(e.what()));
 		return EXIT_FAILURE;
 	}
 
-	/* chain detection */
-	vector<int> listDev = jtag->get_devices_list();
-	int found = listDev.size();
-	int idcode = -1, index = 0;
+#ifdef ENABLE_DAEMON
+	/* keep cable opened and wait for jobs */
+	if (!args.daemon_socket.empty()) {
+		int ret = run_daemon(args, jtag);
+		delete jtag;
+		return ret;
+	}
+#endif
+
+	int ret;
+	if (!args.manifest_file.empty())
+		ret = run_manifest(args, jtag);
+	else
+		ret = run_jtag_session(args, jtag);
+	delete jtag;
+	return ret;
+}
 
-	if (args.verbose > 0)
-		cout << "found " << std::to_string(found) << " devices" << endl;
+/* operation using the SPI flash (through a bridge for some devices) */
+static bool manifest_flash_op(const struct arguments &op)
+{
+	return op.prg_type == Device::WR_FLASH || op.prg_type == Device::RD_FLASH ||
+		op.protect_flash || op.unprotect_flash || op.bulk_erase_flash;
+}
 
-	/* in verbose mode or when detect
-	 * display full chain with details
-	 */
-	if (args.verbose > 0 || args.detect) {
-		for (int i = 0; i < found; i++) {
-			int t = listDev[i];
-			printf("index %d:\n", i);
-			if (fpga_list.find(t) != fpga_list.end()) {
-				printf("\tidcode 0x%x\n\tmanufacturer %s\n\tfamily %s\n\tmodel  %s\n",
-				t,
-				fpga_list[t].manufacturer.c_str(),
-				fpga_list[t].family.c_str(),
-				fpga_list[t].model.c_str());
-				printf("\tirlength %d\n", fpga_list[t].irlength);
-			} else if (misc_dev_list.find(t) != misc_dev_list.end()) {
-				printf("\tidcode   0x%x\n\ttype     %s\n\tirlength %d\n",
-				t,
-				misc_dev_list[t].name.c_str(),
-				misc_dev_list[t].irlength);
+/* device selected by an operation: index in the chain (-1 if unknown)
+ * and manufacturer
+ */
+static int manifest_device(const struct arguments &op, Jtag *jtag,
+	string &manufacturer)
+{
+	vector<int> list = jtag->get_devices_list();
+	int index = op.index_chain;
+	if (index == -1) {
+		for (size_t i = 0; i < list.size(); i++) {
+			if (fpga_list.find(list[i]) != fpga_list.end()) {
+				index = i;
+				break;
 			}
 		}
-		if (args.detect == true) {
-			delete jtag;
-			return EXIT_SUCCESS;
-		}
 	}
+	manufacturer = "";
+	if (index < 0 || index >= static_cast<int>(list.size()) ||
+			fpga_list.find(list[index]) == fpga_list.end())
+		return -1;
+	manufacturer = fpga_list[list[index]].manufacturer;
+	return index;
+}
 
-	if (found != 0) {
-		if (args.index_chain == -1) {
-			for (int i = 0; i < found; i++) {
-				if (fpga_list.find(listDev[i]) != fpga_list.end()) {
-					index = i;
-					if (idcode != -1) {
-						printError("Error: more than one FPGA found");
-						printError("Use --index-chain to force selection");
-						for (int i = 0; i < found; i++)
-							printf("0x%08x\n", listDev[i]);
-						delete(jtag);
-						return EXIT_FAILURE;
-					} else {
-						idcode = listDev[i];
-					}
-				}
-			}
-		} else {
-			index = args.index_chain;
-			if (index > found || index < 0) {
-				printError("wrong index for device in JTAG chain");
-				delete(jtag);
-				return EXIT_FAILURE;
-			}
-			idcode = listDev[index];
-		}
-	} else {
-		printError("Error: no device found");
-		delete(jtag);
+/* an operation can't change the opened cable */
+static bool manifest_same_cable(const struct arguments &args,
+	const struct arguments &op)
+{
+	return op.cable == args.cable && op.board == args.board &&
+		op.device == args.device && op.ftdi_serial == args.ftdi_serial &&
+		op.ftdi_channel == args.ftdi_channel && op.freq == args.freq &&
+		op.vid == args.vid && op.pid == args.pid &&
+		op.cable_index == args.cable_index &&
+		op.bus_addr == args.bus_addr && op.device_addr == args.device_addr &&
+		op.ip_adr == args.ip_adr && op.port == args.port &&
+		op.pin_config == args.pin_config &&
+		op.record_file == args.record_file &&
+		op.replay_file == args.replay_file &&
+		op.stats_file == args.stats_file && op.trace_file == args.trace_file;
+}
+
+/* manifest mode: ordered operations on the cable opened by the session.
+ * Command line options are defaults for all operations. All operations
+ * are parsed before the first access. Consecutive SPI flash operations
+ * on the same Xilinx/Altera device keep the spiOverJtag bridge loaded:
+ * the device is reset after the last one only
+ */
+int run_manifest(const struct arguments &args, Jtag *jtag)
+{
+	vector<vector<string>> tokens_list;
+	if (!manifest_load(args.manifest_file, tokens_list))
+		return EXIT_FAILURE;
+	if (tokens_list.empty()) {
+		printError("Error: no operation in " + args.manifest_file);
 		return EXIT_FAILURE;
 	}
 
-	jtag->device_select(index);
+	vector<struct arguments> ops;
+	vector<string> descs;
+	for (auto &tokens : tokens_list) {
+		string desc;
+		vector<char *> argv = {const_cast<char *>("openFPGALoader")};
+		for (auto &t : tokens) {
+			desc += ((desc.empty()) ? "" : " ") + t;
+			argv.push_back(&t[0]);
+		}
+		argv.push_back(NULL);
 
-	/* detect svf file and program the device */
-	if (!args.file_type.compare("svf") ||
-			args.bit_file.find(".svf") != string::npos) {
-		SVF_jtag *svf = new SVF_jtag(jtag, args.verbose);
+		struct arguments op = args;
+		op.manifest_file = "";
+		jtag_pins_conf_t pins_config = {0, 0, 0, 0};
 		try {
-			svf->parse(args.bit_file);
+			if (parse_opt(argv.size() - 1, argv.data(), &op, &pins_config))
+				throw std::exception();
 		} catch (std::exception &e) {
+			printError("Error: invalid manifest operation: " + desc);
 			return EXIT_FAILURE;
 		}
-		return EXIT_SUCCESS;
-	}
 
-    /* check if selected device is supported
-	 * mainly used in conjunction with --index-chain
-	 */
-	if (fpga_list.find(idcode) == fpga_list.end()) {
-		cerr << "Error: device " << hex << idcode << " not supported" << endl;
-		delete(jtag);
-		return EXIT_FAILURE;
+		if (op.is_list_command || op.spi || op.dfu || op.xvc ||
+				!op.multi_cable_file.empty() || !op.manifest_file.empty() ||
+				!op.daemon_socket.empty() || !op.connect_socket.empty() ||
+				!manifest_same_cable(args, op)) {
+			printError("Error: unsupported option in manifest operation: " +
+				desc);
+			return EXIT_FAILURE;
+		}
+		ops.push_back(op);
+		descs.push_back(desc);
 	}
 
-	string fab = fpga_list[idcode].manufacturer;
+	bool bridge_loaded = false;
+	for (size_t i = 0; i < ops.size(); i++) {
+		struct arguments &op = ops[i];
+		string fab;
+		int dev = manifest_device(op, jtag, fab);
+		bool spi_bridge = (fab == "xilinx" || fab == "altera") &&
+			manifest_flash_op(op);
+
+		if (spi_bridge && bridge_loaded)
+			op.skip_load_bridge = true;
+		bridge_loaded = false;
+		/* next operation uses the same bridge: no reset */
+		if (spi_bridge && !op.reset && i + 1 < ops.size() &&
+				manifest_flash_op(ops[i + 1])) {
+			string next_fab;
+			if (manifest_device(ops[i + 1], jtag, next_fab) == dev) {
+				op.skip_reset = true;
+				bridge_loaded = true;
+			}
+		}
+		/* frequency is computed once */
+		if (i > 0)
+			op.freq_auto = false;
+
+		printInfo("manifest: operation " + std::to_string(i + 1) + "/" +
+			std::to_string(ops.size()) + ": " + descs[i]);
+		int ret;
+		try {
+			ret = run_jtag_session(op, jtag);
+		} catch (std::exception &e) {
+			printError("Error: " + string(e.what()));
+			ret = EXIT_FAILURE;
+		}
+		if (ret != EXIT_SUCCESS) {
+			printError("Error: manifest operation " + std::to_string(i + 1) +
+				" failed");
+			return ret;
+		}
+	}
+	return EXIT_SUCCESS;
+}
 
+/* multi-cable mode: one target per line, each running in its own thread */
+typedef struct {
+	string options;               /* target line */
+	struct arguments args;
+	jtag_pins_conf_t pins_config;
+	std::thread thread;
+	string log;                   /* target messages */
+	std::mutex lock;              /* protect step and percent */
+	string step;                  /* current progress bar message */
+	int percent;
+	std::atomic<bool> done;
+	int ret;
+} multi_target_t;
+
+static void multi_target_progress(void *priv, const string &mess, int percent)
+{
+	multi_target_t *target = static_cast<multi_target_t *>(priv);
+	std::lock_guard<std::mutex> lock(target->lock);
+	target->step = mess;
+	target->percent = percent;
+}
 
-	Device *fpga;
+static void multi_target_run(multi_target_t *target)
+{
+	setThreadLog(&target->log);
+	ProgressBar::setThreadCallback(multi_target_progress, target);
 	try {
-		if (fab == "xilinx") {
-			fpga = new Xilinx(jtag, args.bit_file, args.secondary_bit_file,
-				args.file_type, args.prg_type, args.fpga_part, args.bridge_path,
-				args.target_flash, args.verify, args.verbose, args.skip_load_bridge, args.skip_reset);
-		} else if (fab == "altera") {
-			fpga = new Altera(jtag, args.bit_file, args.file_type,
-				args.prg_type, args.fpga_part, args.bridge_path, args.verify,
-				args.verbose, args.skip_load_bridge, args.skip_reset);
-		} else if (fab == "anlogic") {
-			fpga = new Anlogic(jtag, args.bit_file, args.file_type,
-				args.prg_type, args.verify, args.verbose);
-		} else if (fab == "efinix") {
-			fpga = new Efinix(jtag, args.bit_file, args.file_type,
-				args.prg_type, args.board, args.fpga_part, args.bridge_path,
-				args.verify, args.verbose);
-		} else if (fab == "Gowin") {
-			fpga = new Gowin(jtag, args.bit_file, args.file_type, args.mcufw,
-				args.prg_type, args.external_flash, args.verify, args.verbose);
-		} else if (fab == "lattice") {
-			fpga = new Lattice(jtag, args.bit_file, args.file_type,
-				args.prg_type, args.flash_sector, args.verify, args.verbose);
-		} else if (fab == "colognechip") {
-			fpga = new CologneChip(jtag, args.bit_file, args.file_type,
-				args.prg_type, args.board, args.cable, args.verify, args.verbose);
-		} else {
-			printError("Error: manufacturer " + fab + " not supported");
-			delete(jtag);
-			return EXIT_FAILURE;
-		}
+		target->ret = run_session(target->args, target->pins_config);
 	} catch (std::exception &e) {
-		printError("Error: Failed to claim FPGA device: " + string(e.what()));
-		delete(jtag);
-		return EXIT_FAILURE;
+		printError("Error: " + string(e.what()));
+		target->ret = EXIT_FAILURE;
+	}
+	ProgressBar::setThreadCallback(NULL, NULL);
+	setThreadLog(NULL);
+	target->done = true;
+}
+
+/* parse multi-cable file: one line per target with same options as
+ * command line (no quoting), empty lines and lines starting with #
+ * are ignored
+ */
+static bool multi_cable_parse(const struct arguments &default_args,
+	vector<multi_target_t *> &targets)
+{
+	std::ifstream fd(default_args.multi_cable_file);
+	if (!fd.is_open()) {
+		printError("Error: can't open " + default_args.multi_cable_file);
+		return false;
 	}
 
-	if ((!args.bit_file.empty() ||
-		 !args.secondary_bit_file.empty() ||
-		 !args.file_type.empty())
-			&& args.prg_type != Device::RD_FLASH) {
+	string line;
+	while (std::getline(fd, line)) {
+		size_t pos = line.find_first_not_of(" \t\r");
+		if (pos == string::npos || line[pos] == '#')
+			continue;
+
+		vector<string> tokens = {"openFPGALoader"};
+		std::istringstream iss(line);
+		string token;
+		while (iss >> token)
+			tokens.push_back(token);
+		vector<char *> argv;
+		for (auto &t : tokens)
+			argv.push_back(&t[0]);
+		argv.push_back(NULL);
+
+		multi_target_t *target = new multi_target_t();
+		target->options = line.substr(pos);
+		target->args = default_args;
+		target->args.multi_cable_file = "";
+		target->pins_config = {0, 0, 0, 0};
+		target->percent = 0;
+		target->done = false;
+		target->ret = EXIT_FAILURE;
+		targets.push_back(target);
+
 		try {
-			fpga->program(args.offset, args.unprotect_flash);
+			if (parse_opt(argv.size() - 1, argv.data(), &target->args,
+						&target->pins_config))
+				throw std::exception();
 		} catch (std::exception &e) {
-			printError("Error: Failed to program FPGA: " + string(e.what()));
-			delete(fpga);
-			delete(jtag);
-			return EXIT_FAILURE;
+			printError("Error: invalid target: " + target->options);
+			return false;
+		}
+
+		if (target->args.is_list_command || target->args.xvc ||
+				!target->args.multi_cable_file.empty() ||
+				!target->args.stats_file.empty() ||
+				!target->args.trace_file.empty()) {
+			printError("Error: unsupported option in multi-cable mode: " +
+				target->options);
+			return false;
 		}
 	}
 
-	if (args.conmcu == true) {
-		fpga->connectJtagToMCU();
+	if (targets.empty()) {
+		printError("Error: no target in " + default_args.multi_cable_file);
+		return false;
 	}
+	return true;
+}
 
-	/* unprotect SPI flash */
-	if (args.unprotect_flash && args.bit_file.empty()) {
-		fpga->unprotect_flash();
+int run_multi_cable(const struct arguments &default_args)
+{
+	if (!default_args.stats_file.empty() || !default_args.trace_file.empty()) {
+		printError("Error: --stats and --trace-file not supported in "
+			"multi-cable mode");
+		return EXIT_FAILURE;
 	}
 
-	/* bulk erase SPI flash */
-	if (args.bulk_erase_flash && args.bit_file.empty()) {
-		fpga->bulk_erase_flash();
+	vector<multi_target_t *> targets;
+	if (!multi_cable_parse(default_args, targets)) {
+		for (auto target : targets)
+			delete target;
+		return EXIT_FAILURE;
 	}
 
-	/* protect SPI flash */
-	if (args.protect_flash != 0) {
-		fpga->protect_flash(args.protect_flash);
+	/* same bitstream (and bridge) files are read once */
+	ConfigBitstreamParser::setFileCache(true);
+
+	for (auto target : targets)
+		target->thread = std::thread(multi_target_run, target);
+
+	/* aggregated progress */
+	bool tty = isatty(STDOUT_FILENO);
+	bool all_done = false;
+	while (!all_done) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		all_done = true;
+		string status;
+		for (size_t i = 0; i < targets.size(); i++) {
+			multi_target_t *target = targets[i];
+			std::lock_guard<std::mutex> lock(target->lock);
+			status += "[" + std::to_string(i) + "] ";
+			if (target->done) {
+				status += (target->ret == EXIT_SUCCESS) ? "done " : "fail ";
+			} else {
+				all_done = false;
+				if (target->step.empty())
+					status += "... ";
+				else
+					status += target->step + " " +
+						std::to_string(target->percent) + "% ";
+			}
+		}
+		if (tty)
+			printf("\r%-79s", status.c_str());
+	}
+	if (tty)
+		printf("\n");
+
+	/* result report */
+	int nb_fail = 0;
+	for (size_t i = 0; i < targets.size(); i++) {
+		multi_target_t *target = targets[i];
+		target->thread.join();
+		printInfo("target " + std::to_string(i) + ": " + target->options);
+		cout << target->log;
+		if (target->ret == EXIT_SUCCESS) {
+			printSuccess("target " + std::to_string(i) + ": Done");
+		} else {
+			printError("target " + std::to_string(i) + ": Fail");
+			nb_fail++;
+		}
+		delete target;
 	}
+	ConfigBitstreamParser::setFileCache(false);
+
+	string summary = std::to_string(targets.size() - nb_fail) + "/" +
+		std::to_string(targets.size()) + " targets succeeded";
+	if (nb_fail == 0) {
+		printSuccess(summary);
+		return EXIT_SUCCESS;
+	}
+	printError(summary);
+	return EXIT_FAILURE;
+}
+
+#ifdef ENABLE_DAEMON
+static volatile sig_atomic_t daemon_must_stop = 0;
 
-	if (args.prg_type == Device::RD_FLASH) {
-		if (args.file_size == 0) {
-			printError("Error: 0 size for dump");
+static void daemon_signal(int sig)
+{
+	(void)sig;
+	daemon_must_stop = 1;
+}
+
+/* file received as descriptor: a symlink with the client filename keeps
+ * the extension used to guess file type (and gz compression).
+ * /dev/fd/N is reopened with daemon credentials: the descriptor must
+ * already grant the access required by the operation
+ */
+static string daemon_link_file(const string &dir, const string &prefix,
+	const string &filename, int fd, bool write)
+{
+	int flags = fcntl(fd, F_GETFL);
+	int mode = flags & O_ACCMODE;
+	bool allowed = (flags >= 0) && ((write) ?
+		(mode == O_WRONLY || mode == O_RDWR) :
+		(mode == O_RDONLY || mode == O_RDWR));
+#ifdef O_PATH
+	if (flags & O_PATH)
+		allowed = false;
+#endif
+	if (!allowed)
+		throw std::runtime_error(filename + ": file descriptor not opened " +
+			((write) ? "for writing" : "for reading"));
+
+	string link = dir + "/" + prefix + filename.substr(
+		filename.find_last_of("/") + 1);
+	string target = "/dev/fd/" + std::to_string(fd);
+	if (symlink(target.c_str(), link.c_str()) < 0)
+		throw std::runtime_error("can't create " + link);
+	return link;
+}
+
+static int daemon_run_job(daemon_job_t &job, Jtag *jtag, const string &dir)
+{
+	struct arguments args = default_arguments;
+	jtag_pins_conf_t pins_config = {0, 0, 0, 0};
+	vector<string> tokens = {"openFPGALoader"};
+	tokens.insert(tokens.end(), job.args.begin(), job.args.end());
+	vector<char *> argv;
+	for (auto &t : tokens)
+		argv.push_back(&t[0]);
+	argv.push_back(NULL);
+
+	/* job messages go to client stdout/stderr */
+	fflush(stdout);
+	cout.flush();
+	int saved_out = dup(STDOUT_FILENO);
+	int saved_err = dup(STDERR_FILENO);
+	dup2(job.out_fd, STDOUT_FILENO);
+	dup2(job.err_fd, STDERR_FILENO);
+
+	int ret = EXIT_FAILURE;
+	vector<string> links;
+	try {
+		if (parse_opt(argv.size() - 1, argv.data(), &args, &pins_config)) {
+			ret = EXIT_SUCCESS;  // help or version
+		} else if (args.is_list_command || args.spi || args.dfu ||
+				args.xvc || !args.record_file.empty() ||
+				!args.multi_cable_file.empty() ||
+				!args.manifest_file.empty() ||
+				!args.daemon_socket.empty() ||
+				!args.stats_file.empty() || !args.trace_file.empty()) {
+			printError("Error: unsupported option for a daemon job");
+		} else if ((!args.bit_file.empty() && job.bit_fd < 0) ||
+				(!args.secondary_bit_file.empty() && job.secondary_fd < 0)) {
+			/* never open a client file with daemon rights */
+			printError("Error: file not sent with the job");
 		} else {
-			fpga->dumpFlash(args.offset, args.file_size);
+			if (job.bit_fd >= 0) {
+				args.bit_file = daemon_link_file(dir, "1_", args.bit_file,
+					job.bit_fd, args.prg_type == Device::RD_FLASH);
+				links.push_back(args.bit_file);
+			}
+			if (job.secondary_fd >= 0) {
+				args.secondary_bit_file = daemon_link_file(dir, "2_",
+					args.secondary_bit_file, job.secondary_fd, false);
+				links.push_back(args.secondary_bit_file);
+			}
+			/* chain may have changed since daemon start */
+			if (args.detect)
+				jtag->detectChain(16);
+			ret = run_jtag_session(args, jtag);
 		}
+	} catch (std::exception &e) {
+		printError("Error: " + string(e.what()));
+		ret = EXIT_FAILURE;
 	}
 
-	if (args.reset)
-		fpga->reset();
+	fflush(stdout);
+	cout.flush();
+	dup2(saved_out, STDOUT_FILENO);
+	dup2(saved_err, STDERR_FILENO);
+	close(saved_out);
+	close(saved_err);
+	for (const string &link : links)
+		unlink(link.c_str());
 
-	delete(fpga);
-	delete(jtag);
+	return ret;
 }
 
+int run_daemon(const struct arguments &args, Jtag *jtag)
+{
+	int sock = daemon_listen(args.daemon_socket);
+	if (sock < 0)
+		return EXIT_FAILURE;
+
+	char tmp_dir[] = "/tmp/openFPGALoader-XXXXXX";
+	if (!mkdtemp(tmp_dir)) {
+		printError("daemon: can't create temporary directory");
+		close(sock);
+		return EXIT_FAILURE;
+	}
+
+	/* no SA_RESTART: accept() is interrupted */
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = daemon_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	/* a client may leave during a job */
+	signal(SIGPIPE, SIG_IGN);
+
+	printInfo("daemon: waiting for jobs on " + args.daemon_socket);
+	while (!daemon_must_stop) {
+		int client = daemon_accept(sock);
+		if (client < 0) {
+			if (errno == EINTR)
+				continue;
+			printError("daemon: accept failed");
+			break;
+		}
+
+		daemon_job_t job;
+		if (daemon_recv_job(client, &job)) {
+			int32_t ret = daemon_run_job(job, jtag, tmp_dir);
+			daemon_send_result(client, ret);
+			daemon_close_job(&job);
+			if (args.verbose > 0)
+				printInfo("daemon: job done (" + std::to_string(ret) + ")");
+		}
+		close(client);
+	}
+
+	close(sock);
+	unlink(args.daemon_socket.c_str());
+	rmdir(tmp_dir);
+	printInfo("daemon: stopped");
+	return EXIT_SUCCESS;
+}
+
+int run_daemon_client(const struct arguments &args, int argc, char **argv)
+{
+	daemon_job_t job;
+	job.out_fd = STDOUT_FILENO;
+	job.err_fd = STDERR_FILENO;
+	job.bit_fd = -1;
+	job.secondary_fd = -1;
+
+	/* same command line without --connect */
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--connect") {
+			i++;
+			continue;
+		}
+		if (arg.compare(0, 10, "--connect=") == 0)
+			continue;
+		job.args.push_back(arg);
+	}
+
+	/* files are opened by the client with the access required by the
+	 * operation, daemon rejects descriptors without this access
+	 */
+	if (!args.bit_file.empty()) {
+		if (args.prg_type == Device::RD_FLASH)
+			job.bit_fd = open(args.bit_file.c_str(),
+				O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		else
+			job.bit_fd = open(args.bit_file.c_str(), O_RDONLY);
+		if (job.bit_fd < 0) {
+			printError("Error: can't open " + args.bit_file);
+			return EXIT_FAILURE;
+		}
+	}
+	if (!args.secondary_bit_file.empty()) {
+		job.secondary_fd = open(args.secondary_bit_file.c_str(), O_RDONLY);
+		if (job.secondary_fd < 0) {
+			printError("Error: can't open " + args.secondary_bit_file);
+			if (job.bit_fd >= 0)
+				close(job.bit_fd);
+			return EXIT_FAILURE;
+		}
+	}
+
+	int32_t ret = EXIT_FAILURE;
+	int sock = daemon_connect(args.connect_socket);
+	if (sock >= 0) {
+		if (!daemon_send_job(sock, job) || !daemon_recv_result(sock, &ret)) {
+			printError("Error: connection to daemon lost");
+			ret = EXIT_FAILURE;
+		}
+		close(sock);
+	}
+
+	if (job.bit_fd >= 0)
+		close(job.bit_fd);
+	if (job.secondary_fd >= 0)
+		close(job.secondary_fd);
+	return ret;
+}
+#endif
+
 #ifdef ENABLE_XVC
 int run_xvc_server(const struct arguments &args, const cable_t &cable,
 	const jtag_pins_conf_t *pins_config)
@@ -715,6 +1111,15 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 				"bitstream(intel/xilinx)",
 				cxxopts::value<string>(args->bridge_path))
 			("c,cable", "jtag interface", cxxopts::value<string>(args->cable))
+			("chain-cache", "file to store JTAG chain (skip detection when "
+				"the chain is unchanged)",
+				cxxopts::value<string>(args->chain_cache))
+#ifdef ENABLE_DAEMON
+			("connect", "send operations to a daemon (socket file)",
+				cxxopts::value<string>(args->connect_socket))
+			("daemon", "keep cable opened and wait for jobs on a socket file",
+				cxxopts::value<string>(args->daemon_socket))
+#endif
 			("status-pin",
 				"JTAG mode / FTDI: GPIO pin number to use as a status indicator (active low)",
 				cxxopts::value<int>(args->status_pin))
@@ -760,11 +1165,12 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 				cxxopts::value<string>(args->flash_sector))
 			("fpga-part",   "fpga model flavor + package",
 				cxxopts::value<string>(args->fpga_part))
-			("freq",        "jtag frequency (Hz)", cxxopts::value<string>(freqo))
+			("freq",        "jtag frequency (Hz or auto)", cxxopts::value<string>(freqo))
 			("f,write-flash",
 				"write bitstream in flash (default: false)")
-			("index-chain",  "device index in JTAG-chain",
-				cxxopts::value<int>(args->index_chain))
+			("index-chain",  "device index in JTAG-chain (a comma separated "
+				"list configures identical devices together: Xilinx SRAM only)",
+				cxxopts::value<vector<int>>(args->index_chain_list))
 			("ip", "IP address (XVC and remote bitbang client)",
 				cxxopts::value<string>(args->ip_adr))
 			("list-boards", "list all supported boards",
@@ -775,6 +1181,12 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 				cxxopts::value<bool>(args->list_fpga))
 			("m,write-sram",
 				"write bitstream in SRAM (default: true)")
+			("manifest", "run ordered operations of the file (YAML or JSON) "
+				"with the cable opened once",
+				cxxopts::value<string>(args->manifest_file))
+			("multi-cable", "run in parallel one target per line of the file "
+				"(line: cable and target options)",
+				cxxopts::value<string>(args->multi_cable_file))
 			("o,offset", "Start address (in bytes) for read/write into non volatile memory (default: 0)",
 				cxxopts::value<unsigned int>(args->offset))
 			("pins", "pin config TDI:TDO:TCK:TMS",
@@ -785,6 +1197,12 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 				cxxopts::value<uint32_t>(args->protect_flash))
 			("quiet", "Produce quiet output (no progress bar)",
 				cxxopts::value<bool>(quiet))
+			("record", "record JTAG transactions (with TDO) in a file",
+				cxxopts::value<string>(args->record_file))
+			("replay", "replay a recorded JTAG session (no device specific "
+				"action, busy polling is not replayed: SRAM load or ID reads "
+				"only)",
+				cxxopts::value<string>(args->replay_file))
 			("r,reset",   "reset FPGA after operations",
 				cxxopts::value<bool>(args->reset))
 			("scan-usb",  "scan USB to display connected probes",
@@ -795,6 +1213,11 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 				cxxopts::value<bool>(args->skip_reset))
 			("spi",   "SPI mode (only for FTDI in serial mode)",
 				cxxopts::value<bool>(args->spi))
+			("stats", "write transport counters (JSON) per phase at exit "
+				"(default: stdout)",
+				cxxopts::value<string>(args->stats_file)->implicit_value("-"))
+			("trace-file", "write a Chrome/Perfetto trace (JSON) of the session",
+				cxxopts::value<string>(args->trace_file))
 			("unprotect-flash",   "Unprotect flash blocks",
 				cxxopts::value<bool>(args->unprotect_flash))
 			("v,verbose", "Produce verbose output", cxxopts::value<bool>(verbose))
@@ -861,7 +1284,9 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 		else if (result.count("external-flash"))
 			args->prg_type = Device::WR_FLASH;
 
-		if (result.count("freq")) {
+		if (result.count("freq") && freqo == "auto") {
+			args->freq_auto = true;
+		} else if (result.count("freq")) {
 			double freq;
 			if (parse_eng(freqo, &freq)) {
 				printError("Error: invalid format for --freq");
@@ -874,6 +1299,14 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 			args->freq = static_cast<uint32_t>(freq);
 		}
 
+		if (result.count("index-chain")) {
+			if (args->index_chain_list.empty()) {
+				printError("Error: --index-chain requires at least one index");
+				throw std::exception();
+			}
+			args->index_chain = args->index_chain_list[0];
+		}
+
 		if (result.count("status-pin")) {
 			if (args->status_pin < 4 || args->status_pin > 15) {
 				printError("Error: valid status pin numbers are 4-15.");
@@ -977,7 +1410,11 @@ int parse_opt(int argc, char **argv, struct arguments *args,
 			!args->bulk_erase_flash &&
 			!args->xvc &&
 			!args->reset &&
-			!args->conmcu) {
+			!args->conmcu &&
+			args->multi_cable_file.empty() &&
+			args->manifest_file.empty() &&
+			args->replay_file.empty() &&
+			args->daemon_socket.empty()) {
 			printError("Error: bitfile not specified");
 			cout << options.help() << endl;
 			throw std::exception();
@@ -0,0 +1,453 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "mpsseEmu.hpp"
+
+#include <ftdi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "common.hpp"
+#include "display.hpp"
+
+/* MPSSE opcodes not always defined by ftdi.h */
+#define EMU_EN_3_PHASE      0x8C
+#define EMU_DIS_3_PHASE     0x8D
+#define EMU_CLK_BITS        0x8E
+#define EMU_CLK_BYTES       0x8F
+#define EMU_CLK_WAIT_HIGH   0x94
+#define EMU_CLK_WAIT_LOW    0x95
+#define EMU_EN_ADAPTIVE     0x96
+#define EMU_DIS_ADAPTIVE    0x97
+#define EMU_CLK_BYTES_HIGH  0x9C
+#define EMU_CLK_BYTES_LOW   0x9D
+#define EMU_OPEN_COLLECTOR  0x9E
+#define EMU_WAIT_ON_HIGH    0x88
+#define EMU_WAIT_ON_LOW     0x89
+#define EMU_BAD_CMD_ANSWER  0xFA
+
+MpsseEmu::MpsseEmu(bool high_speed):
+	_vjtag(NULL), _high_speed(high_speed), _spi(false), _cs_mask(0x08),
+	_cs_low(false), _bitmode(BITMODE_RESET), _bb_dir(0), _bb_pins(0),
+	_tdi_pin(1 << 1), _tdo_pin(1 << 2), _tck_pin(1 << 0), _tms_pin(1 << 3),
+	_low_val(0), _low_dir(0), _high_val(0), _high_dir(0), _tdo(0),
+	_loopback(false), _div5(true), _three_phase(false), _divisor(0),
+	_baudrate(9600), _rx_immediate(false),
+	_packet_size((high_speed) ? 512 : 64),
+	_frame_us((high_speed) ? 125 : 1000),
+	_packets_per_frame((high_speed) ? 13 : 19),
+	_latency_ms(16), _realtime(false), _wait_us(0),
+	_out_since_in(false), _nb_out(0), _nb_in(0), _nb_in_empty(0),
+	_nb_round_trips(0), _out_packets(0), _in_packets(0), _out_bytes(0),
+	_in_bytes(0), _tck_cycles(0), _total_us(0)
+{
+	std::string target = get_shell_env_var("OPENFPGALOADER_MPSSE_EMU_TARGET",
+		"jtag");
+	if (target == "spi")
+		_spi = true;
+	else if (target != "jtag")
+		throw std::runtime_error("mpsse-emu: unknown target " + target);
+
+	_cs_mask = strtoul(get_shell_env_var("OPENFPGALOADER_MPSSE_EMU_CS",
+		"0x08").c_str(), NULL, 0);
+	_realtime = get_shell_env_var("OPENFPGALOADER_MPSSE_EMU_REALTIME",
+		"0") == "1";
+
+	/* bitbang pins: same order as --pins */
+	std::stringstream pins(get_shell_env_var("OPENFPGALOADER_MPSSE_EMU_PINS",
+		"1:2:0:3"));
+	std::string pin;
+	uint8_t *masks[4] = {&_tdi_pin, &_tdo_pin, &_tck_pin, &_tms_pin};
+	for (int i = 0; i < 4; i++) {
+		if (!std::getline(pins, pin, ':'))
+			throw std::runtime_error("mpsse-emu: invalid pins configuration");
+		*masks[i] = 1 << (strtoul(pin.c_str(), NULL, 0) & 0x07);
+	}
+
+	_vjtag = new VirtualJtag(0, 0);
+}
+
+MpsseEmu::~MpsseEmu()
+{
+	char mess[256];
+	snprintf(mess, sizeof(mess), "mpsse-emu: OUT %u transfers %llu packets "
+		"%llu Bytes", _nb_out, (unsigned long long)_out_packets,
+		(unsigned long long)_out_bytes);
+	printInfo(mess);
+	snprintf(mess, sizeof(mess), "mpsse-emu: IN %u transfers (%u empty) "
+		"%llu packets %llu Bytes", _nb_in, _nb_in_empty,
+		(unsigned long long)_in_packets, (unsigned long long)_in_bytes);
+	printInfo(mess);
+	snprintf(mess, sizeof(mess), "mpsse-emu: %u round trips %llu clock "
+		"cycles %.3f ms", _nb_round_trips, (unsigned long long)_tck_cycles,
+		_total_us / 1000);
+	printInfo(mess);
+
+	/* flash image written back */
+	delete _vjtag;
+}
+
+/* host interface */
+
+int MpsseEmu::write(const uint8_t *buf, int len)
+{
+	usb_transfer(true, len, false);
+	_nb_out++;
+	_out_bytes += len;
+	_out_since_in = true;
+
+	if (_bitmode == BITMODE_BITBANG || _bitmode == BITMODE_SYNCBB) {
+		bitbang_write(buf, len);
+	} else if (_bitmode == BITMODE_MPSSE) {
+		_cmd.insert(_cmd.end(), buf, buf + len);
+		uint32_t pos = 0;
+		while (pos < _cmd.size()) {
+			uint32_t cmd_len = mpsse_cmd_len(&_cmd[pos], _cmd.size() - pos);
+			if (cmd_len == 0 || cmd_len > _cmd.size() - pos)
+				break;
+			mpsse_exec(&_cmd[pos]);
+			pos += cmd_len;
+		}
+		_cmd.erase(_cmd.begin(), _cmd.begin() + pos);
+	}
+
+	realtime_wait();
+	return len;
+}
+
+int MpsseEmu::read(uint8_t *buf, int len)
+{
+	int n = std::min((size_t)len, _rx.size());
+	/* the FTDI sends data when a packet is full or on SEND_IMMEDIATE,
+	 * otherwise (and when empty) at latency timer expiration
+	 */
+	bool wait_latency = n == 0 || (!_rx_immediate &&
+		_rx.size() < (size_t)(_packet_size - 2));
+	usb_transfer(false, n, wait_latency);
+	_nb_in++;
+	_in_bytes += n;
+
+	if (n == 0) {
+		_nb_in_empty++;
+	} else if (_out_since_in) {
+		_nb_round_trips++;
+		_out_since_in = false;
+	}
+
+	std::copy(_rx.begin(), _rx.begin() + n, buf);
+	_rx.erase(_rx.begin(), _rx.begin() + n);
+	if (_rx.empty())
+		_rx_immediate = false;
+
+	realtime_wait();
+	return n;
+}
+
+void MpsseEmu::set_bitmode(uint8_t bitmask, uint8_t mode)
+{
+	_bitmode = mode;
+	_bb_dir = bitmask;
+	_cmd.clear();
+	if (mode == BITMODE_RESET)
+		_loopback = false;
+}
+
+void MpsseEmu::purge_rx()
+{
+	_rx.clear();
+	_rx_immediate = false;
+}
+
+/* target */
+
+uint8_t MpsseEmu::cycle(uint8_t tms, uint8_t tdi)
+{
+	_tck_cycles++;
+	if (_loopback)
+		_tdo = tdi;
+	else if (_spi)
+		_tdo = _vjtag->spi_clock(tdi);
+	else
+		_tdo = _vjtag->tck(tms, tdi);
+	return _tdo;
+}
+
+/* MPSSE */
+
+uint32_t MpsseEmu::mpsse_cmd_len(const uint8_t *c, uint32_t avail)
+{
+	uint8_t op = c[0];
+
+	if (!(op & 0x80)) {
+		/* invalid shift: no data nor TMS, TMS in byte mode */
+		if (!(op & (MPSSE_DO_WRITE | MPSSE_DO_READ | MPSSE_WRITE_TMS)) ||
+				((op & MPSSE_WRITE_TMS) && !(op & MPSSE_BITMODE)))
+			return 1;
+		if (op & MPSSE_WRITE_TMS)
+			return 3;
+		if (op & MPSSE_BITMODE)
+			return (op & MPSSE_DO_WRITE) ? 3 : 2;
+		if (avail < 3)
+			return 0;
+		uint32_t len = (c[1] | (c[2] << 8)) + 1;
+		return 3 + ((op & MPSSE_DO_WRITE) ? len : 0);
+	}
+
+	switch (op) {
+	case SET_BITS_LOW:
+	case SET_BITS_HIGH:
+	case TCK_DIVISOR:
+	case EMU_CLK_BYTES:
+	case EMU_CLK_BYTES_HIGH:
+	case EMU_CLK_BYTES_LOW:
+	case EMU_OPEN_COLLECTOR:
+		return 3;
+	case EMU_CLK_BITS:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+void MpsseEmu::mpsse_exec(const uint8_t *c)
+{
+	uint8_t op = c[0];
+	uint64_t cycles;
+
+	if (!(op & 0x80)) {
+		if (mpsse_cmd_len(c, 3) == 1)
+			mpsse_bad_cmd(op);
+		else
+			mpsse_shift(c);
+		return;
+	}
+
+	switch (op) {
+	case SET_BITS_LOW:
+		mpsse_set_pins(true, c[1], c[2]);
+		break;
+	case SET_BITS_HIGH:
+		mpsse_set_pins(false, c[1], c[2]);
+		break;
+	case GET_BITS_LOW:
+		_rx.push_back(mpsse_get_pins(true));
+		break;
+	case GET_BITS_HIGH:
+		_rx.push_back(mpsse_get_pins(false));
+		break;
+	case LOOPBACK_START:
+		_loopback = true;
+		break;
+	case LOOPBACK_END:
+		_loopback = false;
+		break;
+	case TCK_DIVISOR:
+		_divisor = c[1] | (c[2] << 8);
+		break;
+	case SEND_IMMEDIATE:
+		_rx_immediate = true;
+		break;
+	case DIS_DIV_5:
+	case EN_DIV_5:
+		/* full speed devices have no divide by 5 */
+		if (!_high_speed) {
+			mpsse_bad_cmd(op);
+			break;
+		}
+		_div5 = (op == EN_DIV_5);
+		break;
+	case EMU_EN_3_PHASE:
+	case EMU_DIS_3_PHASE:
+		if (!_high_speed) {
+			mpsse_bad_cmd(op);
+			break;
+		}
+		_three_phase = (op == EMU_EN_3_PHASE);
+		break;
+	case EMU_CLK_BITS:
+	case EMU_CLK_BYTES:
+	case EMU_CLK_BYTES_HIGH:
+	case EMU_CLK_BYTES_LOW:
+		if (op == EMU_CLK_BITS)
+			cycles = c[1] + 1;
+		else
+			cycles = ((c[1] | (c[2] << 8)) + 1) * 8;
+		for (uint64_t i = 0; i < cycles; i++)
+			cycle((_low_val >> 3) & 0x01, (_low_val >> 1) & 0x01);
+		engine_time(cycles);
+		break;
+	case EMU_OPEN_COLLECTOR:
+	case EMU_WAIT_ON_HIGH:
+	case EMU_WAIT_ON_LOW:
+	case EMU_CLK_WAIT_HIGH:
+	case EMU_CLK_WAIT_LOW:
+	case EMU_EN_ADAPTIVE:
+	case EMU_DIS_ADAPTIVE:
+		/* no external event: immediately satisfied */
+		break;
+	default:
+		mpsse_bad_cmd(op);
+		break;
+	}
+}
+
+/* data shift: TCK on ADBUS0, TDI/DO ADBUS1, TDO/DI ADBUS2, TMS/CS ADBUS3 */
+void MpsseEmu::mpsse_shift(const uint8_t *c)
+{
+	uint8_t op = c[0];
+	bool lsb = (op & MPSSE_LSB) != 0;
+	bool wr = (op & MPSSE_DO_WRITE) != 0;
+	uint8_t tms = (_low_val >> 3) & 0x01;
+	uint8_t tdi = (_low_val >> 1) & 0x01;
+
+	if (op & MPSSE_WRITE_TMS) {
+		/* TDI is bit 7, constant during TMS bits, TDO shifted from MSB */
+		uint32_t len = (c[1] & 0x07) + 1;
+		uint8_t val = c[2], rx = 0;
+		tdi = val >> 7;
+		for (uint32_t i = 0; i < len; i++) {
+			tms = (val >> i) & 0x01;
+			rx = (rx >> 1) | (cycle(tms, tdi) << 7);
+		}
+		_low_val = (_low_val & ~0x0A) | (tms << 3) | (tdi << 1);
+		if (op & MPSSE_DO_READ)
+			_rx.push_back(rx);
+		engine_time(len);
+		return;
+	}
+
+	uint32_t nb_byte, nb_bit;
+	const uint8_t *data;
+	if (op & MPSSE_BITMODE) {
+		nb_byte = 1;
+		nb_bit = (c[1] & 0x07) + 1;
+		data = c + 2;
+	} else {
+		nb_byte = (c[1] | (c[2] << 8)) + 1;
+		nb_bit = 8;
+		data = c + 3;
+	}
+
+	for (uint32_t b = 0; b < nb_byte; b++) {
+		uint8_t val = (wr) ? data[b] : 0, rx = 0;
+		for (uint32_t i = 0; i < nb_bit; i++) {
+			/* DO keeps its last state without write */
+			if (wr)
+				tdi = (lsb) ? ((val >> i) & 0x01) : ((val >> (7 - i)) & 0x01);
+			uint8_t tdo = cycle(tms, tdi);
+			rx = (lsb) ? ((rx >> 1) | (tdo << 7)) : ((rx << 1) | tdo);
+		}
+		if (op & MPSSE_DO_READ)
+			_rx.push_back(rx);
+	}
+	_low_val = (_low_val & ~0x02) | (tdi << 1);
+	engine_time((uint64_t)nb_byte * nb_bit);
+}
+
+void MpsseEmu::mpsse_set_pins(bool low, uint8_t val, uint8_t dir)
+{
+	if (low) {
+		_low_val = val;
+		_low_dir = dir;
+	} else {
+		_high_val = val;
+		_high_dir = dir;
+	}
+	if (_spi) {
+		uint16_t pins = (_high_val << 8) | _low_val;
+		bool cs_low = (pins & _cs_mask) == 0;
+		if (cs_low != _cs_low)
+			_vjtag->spi_select(cs_low);
+		_cs_low = cs_low;
+	}
+}
+
+/* inputs: TDO/MISO on ADBUS2, others are pulled up */
+uint8_t MpsseEmu::mpsse_get_pins(bool low)
+{
+	if (!low)
+		return (_high_val & _high_dir) | ~_high_dir;
+	uint8_t in = ~_low_dir & ~0x04;
+	return (_low_val & _low_dir) | in | ((_tdo) ? 0x04 : 0x00);
+}
+
+void MpsseEmu::mpsse_bad_cmd(uint8_t op)
+{
+	_rx.push_back(EMU_BAD_CMD_ANSWER);
+	_rx.push_back(op);
+}
+
+/* bitbang: each Byte is a pins update, a TCK rising edge clocks the
+ * target. With synchronous mode pins are sampled before each update
+ */
+void MpsseEmu::bitbang_write(const uint8_t *buf, int len)
+{
+	for (int i = 0; i < len; i++) {
+		uint8_t pins = buf[i] & _bb_dir;
+		if (!(_bb_pins & _tck_pin) && (pins & _tck_pin))
+			cycle((pins & _tms_pin) ? 1 : 0, (pins & _tdi_pin) ? 1 : 0);
+		if (_bitmode == BITMODE_SYNCBB)
+			_rx.push_back((_bb_pins & ~_tdo_pin) | ((_tdo) ? _tdo_pin : 0));
+		_bb_pins = pins;
+	}
+	if (_bitmode == BITMODE_SYNCBB)
+		_rx_immediate = true;
+	if (_baudrate > 0) {
+		double us = len * 1e6 / _baudrate;
+		_total_us += us;
+		_wait_us += us;
+	}
+}
+
+/* timing model */
+
+void MpsseEmu::usb_transfer(bool out, uint32_t bytes, bool wait_latency)
+{
+	/* IN packets start with two modem status Bytes */
+	uint32_t payload = (out) ? _packet_size : _packet_size - 2;
+	uint32_t packets = std::max(1U, (bytes + payload - 1) / payload);
+	uint32_t frames = (packets + _packets_per_frame - 1) / _packets_per_frame;
+	double us = frames * _frame_us;
+	if (wait_latency)
+		us += _latency_ms * 1000;
+
+	if (out)
+		_out_packets += packets;
+	else
+		_in_packets += packets;
+	_total_us += us;
+	_wait_us += us;
+}
+
+void MpsseEmu::engine_time(uint64_t cycles)
+{
+	/* 60MHz (H series without divide by 5) or 12MHz base clock */
+	double base = (_high_speed && !_div5) ? 60e6 : 12e6;
+	double freq = base / ((1 + _divisor) * 2);
+	if (_three_phase)
+		freq = freq * 2 / 3;
+	double us = cycles * 1e6 / freq;
+	_total_us += us;
+	_wait_us += us;
+}
+
+void MpsseEmu::realtime_wait()
+{
+	if (!_realtime) {
+		_wait_us = 0;
+		return;
+	}
+	/* sub-microsecond costs are accumulated */
+	if (_wait_us >= 1) {
+		usleep((useconds_t)_wait_us);
+		_wait_us -= (useconds_t)_wait_us;
+	}
+}
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_MPSSEEMU_HPP_
+#define SRC_MPSSEEMU_HPP_
+
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+#include "virtualJtag.hpp"
+
+/*!
+ * \file mpsseEmu.hpp
+ * \class MpsseEmu
+ * \brief software FTDI device: MPSSE command interpreter and bitbang
+ *        modes driving the virtual cable TAP (JTAG) or its first device
+ *        primary flash (SPI), with a USB transfer model (bulk packets,
+ *        latency timer, (micro)frames) and transfers statistics.
+ *        Used in place of libftdi when built with ENABLE_MPSSE_EMU
+ *        (see ftdiEmu.cpp). Configured with environment variables:
+ *        - OPENFPGALOADER_MPSSE_EMU_TARGET: jtag (default) or spi
+ *        - OPENFPGALOADER_MPSSE_EMU_CS: SPI chip select pins mask
+ *          (default: 0x08)
+ *        - OPENFPGALOADER_MPSSE_EMU_PINS: bitbang pins tdi:tdo:tck:tms
+ *          (default: 1:2:0:3)
+ *        - OPENFPGALOADER_MPSSE_EMU_REALTIME: 1 to wait modeled time
+ *        Chain and flash image are configured as for virtual cable
+ */
+class MpsseEmu {
+ public:
+	/*!
+	 * \brief constructor
+	 * \param[in] high_speed: 2232H/4232H/232H (60MHz base clock,
+	 *            512 Bytes packets, 125us microframes), full speed
+	 *            otherwise (12MHz, 64 Bytes, 1ms frames)
+	 */
+	explicit MpsseEmu(bool high_speed);
+	~MpsseEmu();
+
+	/*!
+	 * \brief bulk OUT transfer: commands (MPSSE) or pins states (bitbang)
+	 * \return len
+	 */
+	int write(const uint8_t *buf, int len);
+	/*!
+	 * \brief bulk IN transfer
+	 * \return number of Bytes received (0 when nothing is available
+	 *         before latency timer expiration)
+	 */
+	int read(uint8_t *buf, int len);
+
+	void set_bitmode(uint8_t bitmask, uint8_t mode);
+	void set_latency(uint8_t latency) { _latency_ms = latency;}
+	void set_baudrate(int baudrate) { _baudrate = baudrate;}
+	void purge_rx();
+	void purge_tx() { _cmd.clear();}
+	int max_packet_size() { return _packet_size;}
+
+ private:
+	/* MPSSE */
+	/*!
+	 * \brief number of Bytes required by the command starting at c
+	 * \return command length, 0 when more Bytes are needed to know it
+	 */
+	uint32_t mpsse_cmd_len(const uint8_t *c, uint32_t avail);
+	void mpsse_exec(const uint8_t *c);
+	void mpsse_shift(const uint8_t *c);
+	void mpsse_set_pins(bool low, uint8_t val, uint8_t dir);
+	uint8_t mpsse_get_pins(bool low);
+	void mpsse_bad_cmd(uint8_t op);
+	/* bitbang */
+	void bitbang_write(const uint8_t *buf, int len);
+	/*!
+	 * \brief one clock cycle on the target
+	 * \return TDO/MISO state
+	 */
+	uint8_t cycle(uint8_t tms, uint8_t tdi);
+	/* timing model */
+	void usb_transfer(bool out, uint32_t bytes, bool wait_latency);
+	void engine_time(uint64_t cycles);
+	void realtime_wait();
+
+	VirtualJtag *_vjtag;
+	bool _high_speed;
+	bool _spi;                /*!< target is SPI flash */
+	uint16_t _cs_mask;        /*!< SPI CS pins */
+	bool _cs_low;             /*!< SPI CS state */
+
+	/* device state */
+	uint8_t _bitmode;         /*!< BITMODE_xxx */
+	uint8_t _bb_dir;          /*!< bitbang outputs */
+	uint8_t _bb_pins;         /*!< bitbang pins state */
+	uint8_t _tdi_pin, _tdo_pin, _tck_pin, _tms_pin;  /*!< bitbang masks */
+	uint8_t _low_val, _low_dir, _high_val, _high_dir;
+	uint8_t _tdo;             /*!< last TDO/MISO state */
+	bool _loopback;
+	bool _div5;
+	bool _three_phase;
+	uint16_t _divisor;
+	int _baudrate;
+	std::vector<uint8_t> _cmd;   /*!< incomplete command */
+	std::deque<uint8_t> _rx;     /*!< Bytes to send to host */
+	bool _rx_immediate;          /*!< SEND_IMMEDIATE received */
+
+	/* USB model */
+	uint32_t _packet_size;
+	uint32_t _frame_us;
+	uint32_t _packets_per_frame;
+	uint8_t _latency_ms;
+	bool _realtime;
+	double _wait_us;             /*!< modeled time not yet waited */
+
+	/* statistics */
+	bool _out_since_in;          /*!< OUT transfer since last IN */
+	uint32_t _nb_out, _nb_in, _nb_in_empty, _nb_round_trips;
+	uint64_t _out_packets, _in_packets;
+	uint64_t _out_bytes, _in_bytes;
+	uint64_t _tck_cycles;
+	double _total_us;
+};
+#endif  // SRC_MPSSEEMU_HPP_
@@ -61,21 +61,21 @@ int POFParser::parse()
 	uint32_t pos = 0;
 
 	if (_verbose)
-		printf("[%08x:%08x] %s\n", 0, 3, ptr);
+		printfInfo("[%08x:%08x] %s\n", 0, 3, ptr);
 	/* [0:3]: POF\0 */
 	ptr += 4;
 	pos += 4;
 	/* unknown */
 	if (_verbose) {
 		uint32_t first_section = ARRAY2INT32(ptr);
-		printf("first section:     %08x %4u\n", first_section, first_section);
+		printfInfo("first section:     %08x %4u\n", first_section, first_section);
 	}
 	ptr += 4;
 	pos += 4;
 	/* number of packets */
 	if (_verbose) {
 		uint32_t num_packets = ARRAY2INT32(ptr);
-		printf("number of packets: %08x %4u\n", num_packets, num_packets);
+		printfInfo("number of packets: %08x %4u\n", num_packets, num_packets);
 	}
 	pos += 4;
 
@@ -102,7 +102,7 @@ uint32_t POFParser::parseSection(uint16_t flag, uint32_t pos, uint32_t size)
 	std::string content;
 
 	if (_verbose)
-		printf("%d %u\n", flag, size);
+		printfInfo("%d %u\n", flag, size);
 
 	/* 0x01: software name/version */
 	/* 0x02: full FPGAs model */
@@ -139,7 +139,7 @@ uint32_t POFParser::parseSection(uint16_t flag, uint32_t pos, uint32_t size)
 					_bit_data.begin());
 			_bit_length = size * 8;
 			if (_verbose)
-				printf("size %u %zu\n", size, _bit_data.size());
+				printfInfo("size %u %zu\n", size, _bit_data.size());
 			break;
 		case 0x1a:  // flash sections
 					// 12Bytes ?
@@ -168,16 +168,16 @@ void POFParser::parseFlag26(uint16_t flag, uint32_t pos,
 		uint32_t size, const std::string &payload)
 {
 	if (_verbose)
-		printf("%04x %08x %08x\n", flag, pos, size);
+		printfInfo("%04x %08x %08x\n", flag, pos, size);
 
 	if (size != payload.size())
-		printf("mismatch size\n");
+		printfInfo("mismatch size\n");
 
 	if (_verbose) {
 		uint32_t val0 = ARRAY2INT32((&payload.c_str()[0]));
 		uint32_t val1 = ARRAY2INT32((&payload.c_str()[4]));
 		uint32_t val2 = ARRAY2INT32((&payload.c_str()[8]));
-		printf("%08x %08x %08x\n", val0, val1, val2);
+		printfInfo("%08x %08x %08x\n", val0, val1, val2);
 	}
 
 	std::regex regex{R"([;]+)"};  // split on space
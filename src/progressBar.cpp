@@ -9,16 +9,35 @@
 #include <string>
 #include "progressBar.hpp"
 #include "display.hpp"
+#include "traceEvent.hpp"
+#include "transportStats.hpp"
+
+/* per thread progress callback (multi-cable mode) */
+static thread_local ProgressBar::callback_t thread_cb = NULL;
+static thread_local void *thread_cb_priv = NULL;
+
+void ProgressBar::setThreadCallback(callback_t cb, void *priv)
+{
+	thread_cb = cb;
+	thread_cb_priv = priv;
+}
 
 ProgressBar::ProgressBar(const std::string &mess, int maxValue,
 		int progressLen, bool quiet): _mess(mess), _maxValue(maxValue),
 		_progressLen(progressLen), last_time(std::chrono::system_clock::now()),
-		_quiet(quiet), _first(true)
+		_quiet(quiet), _first(true), _trace_start(trace_now())
 {
+	_prev_phase = stats_set_phase(mess);
 }
 
 void ProgressBar::display(int value, char force)
 {
+	if (thread_cb) {
+		thread_cb(thread_cb_priv, _mess, (_maxValue > 0) ?
+			static_cast<int>((int64_t)value * 100 / _maxValue) : 100);
+		return;
+	}
+
 	if (_quiet) {
 		if (_first) {
 			printInfo(_mess + ": ", false);
@@ -43,13 +62,21 @@ void ProgressBar::display(int value, char force)
 	for (int z=0; z < nbEq; z++) {
 		fputc('=', stdout);
 	}
-	fprintf(stdout, "%*s", (int)(_progressLen-nbEq), "");
+	printfInfo("%*s", (int)(_progressLen-nbEq), "");
 	char perc_str[11];
 	snprintf(perc_str, sizeof(perc_str), "] %3.2f%%", percent);
 	printInfo(perc_str, false);
 }
 void ProgressBar::done()
 {
+	stats_set_phase(_prev_phase);
+	if (_trace_start != 0)
+		trace_complete(_mess, "phase", _trace_start, trace_now());
+	if (thread_cb) {
+		thread_cb(thread_cb_priv, _mess, 100);
+		printSuccess(_mess + ": Done");
+		return;
+	}
 	if (_quiet) {
 		printSuccess("Done");
 	} else {
@@ -59,6 +86,14 @@ void ProgressBar::done()
 }
 void ProgressBar::fail()
 {
+	stats_set_phase(_prev_phase);
+	if (_trace_start != 0)
+		trace_complete(_mess, "phase", _trace_start, trace_now());
+	if (thread_cb) {
+		thread_cb(thread_cb_priv, _mess, -1);
+		printError(_mess + ": Fail");
+		return;
+	}
 	if (_quiet) {
 		printError("Fail");
 	} else {
@@ -7,6 +7,7 @@
 #define PROGRESSBARE_HPP
 #include <iostream>
 #include <chrono>
+#include <cstdint>
 
 class ProgressBar {
 	public:
@@ -15,6 +16,15 @@ class ProgressBar {
 		void display(int value, char force = 0);
 		void done();
 		void fail();
+
+		/*!
+		 * \brief progress callback for the current thread: when set,
+		 *        progress is reported through it instead of console
+		 *        (percent is -1 on fail)
+		 */
+		typedef void (*callback_t)(void *priv, const std::string &mess,
+				int percent);
+		static void setThreadCallback(callback_t cb, void *priv);
 	private:
 		std::string _mess;
 		int _maxValue;
@@ -23,6 +33,8 @@ class ProgressBar {
 		std::chrono::time_point<std::chrono::system_clock> last_time;
 		bool _quiet;
 		bool _first;
+		std::string _prev_phase; /*!< transport stats phase to restore */
+		uint64_t _trace_start;   /*!< trace span start (0: disabled) */
 };
 
 #endif
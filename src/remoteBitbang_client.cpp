@@ -24,7 +24,9 @@
 #include <utility>
 #include <vector>
 
+#include "bitOps.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -63,11 +65,11 @@ RemoteBitbang_client::~RemoteBitbang_client()
 
 	// set led high
 	if (xfer_pkt('B', NULL) < 0)
-		printf("can't set led high");
+		printfInfo("can't set led high");
 
 	// send close request
 	if (xfer_pkt('Q', NULL) < 0)
-		printf("can't send close request");
+		printfInfo("can't send close request");
 
 	// cleanup
 	if (_xfer_buf)
@@ -110,7 +112,7 @@ int RemoteBitbang_client::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len,
 	for (uint32_t pos = 0; pos < len; pos++) {
 		if (_num_bytes == _buffer_size)
 			ll_write(NULL);  // NULL because _num_bytes is always 0 when read
-		_last_tdi = (tx[pos >> 3] & (1 << (pos & 0x07))) ? TDI_BIT : 0;
+		_last_tdi = bit_get(tx, pos) ? TDI_BIT : 0;
 		if (end && pos == len - 1) {
 			_last_tms = TMS_BIT;
 			base_v = '0' + _last_tms;
@@ -120,10 +122,7 @@ int RemoteBitbang_client::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len,
 		if (rx) {
 			uint8_t tdo;
 			ll_write(&tdo);
-			if (tdo == '1')
-				rx[pos >> 3] |= (1 << (pos & 0x07));
-			else
-				rx[pos >> 3] &= ~(1 << (pos & 0x07));
+			bit_set(rx, pos, tdo == '1');
 		}
 	}
 
@@ -200,14 +199,18 @@ ssize_t RemoteBitbang_client::xfer_pkt(uint8_t instr, uint8_t *rx)
 {
 	ssize_t len;
 	// 1. instruction
+	uint64_t t = stats_start();
 	if ((len = write(_sock, &instr, 1)) == -1) {
 		printError("Send instruction failed with error " +
 				std::to_string(len));
 		return -1;
 	}
+	stats_xfer_out(1, t);
 
 	if (rx) {
+		t = stats_start();
 		len = recv(_sock, rx, 1, 0);
+		stats_xfer_in((len < 0) ? 0 : len, t);
 		if (len < 0) {
 			printError("Receive error");
 			return len;
@@ -224,10 +227,14 @@ bool RemoteBitbang_client::ll_write(uint8_t *tdo)
 
 	ssize_t len;
 	// write current buffer
+	uint64_t t = stats_start();
 	if ((len = write(_sock, _xfer_buf, _num_bytes)) == -1) {
 		printError("Send error error: " + std::to_string(len));
 		return false;
 	}
+	stats_xfer_out(len, t);
+	if (tdo || _num_bytes < _buffer_size)
+		stats_forced_flush();
 	_num_bytes = 0;
 
 	// read only one char (if tdo is not null
@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2019 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "session.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "altera.hpp"
+#include "anlogic.hpp"
+#include "colognechip.hpp"
+#include "device.hpp"
+#include "display.hpp"
+#include "efinix.hpp"
+#include "gowin.hpp"
+#include "lattice.hpp"
+#include "jtag.hpp"
+#include "part.hpp"
+#include "xilinx.hpp"
+#include "svf_jtag.hpp"
+#include "traceEvent.hpp"
+#include "transportStats.hpp"
+
+#define AUTO_FREQ_MAX 	30000000
+
+using namespace std;
+
+const struct arguments default_arguments = {
+		0, false, false, false, false, 0, "", "", "", "-", "", -1,
+		-1, 0, false, "-", false, false, false, false, Device::PRG_NONE, false,
+		/* spi dfu    file_type fpga_part bridge_path probe_firmware */
+		false, false, "",       "",       "",         "",
+		/* index_chain file_size target_flash external_flash altsetting */
+		-1,            0,        "primary",   false,         -1,
+		/* vid, pid, index bus_addr, device_addr */
+		    0,   0,   -1,     0,         0,
+		"127.0.0.1", 0, false, false, "", false, false,
+		/* xvc server */
+		false, 3721, "-",
+		"", false,  // mcufw conmcu
+		{},         // index_chain_list
+		"",         // chain_cache
+		false,      // freq_auto
+		"", "",     // record_file replay_file
+		"",         // stats_file
+		"",         // trace_file
+		"",         // multi_cable_file
+		"", "",     // daemon_socket connect_socket
+		"",         // manifest_file
+};
+
+/* operations on an opened JTAG cable */
+int run_jtag_session(struct arguments &args, Jtag *jtag)
+{
+	/* if no instruction from user -> select load */
+	if (args.prg_type == Device::PRG_NONE)
+		args.prg_type = Device::WR_SRAM;
+
+	/* chain detection */
+	vector<int> listDev = jtag->get_devices_list();
+	int found = listDev.size();
+	int idcode = -1, index = 0;
+
+	/* search highest stable frequency: before detect early return */
+	if (args.freq_auto && found != 0) {
+		uint32_t freq = jtag->auto_freq(AUTO_FREQ_MAX);
+		if (freq == 0) {
+			return EXIT_FAILURE;
+		}
+		printInfo("JTAG frequency: " + std::to_string(freq) + "Hz");
+	}
+
+	/* messages go through display functions: per target log in
+	 * multi-cable mode
+	 */
+	if (args.verbose > 0)
+		printInfo("found " + std::to_string(found) + " devices");
+
+	/* in verbose mode or when detect
+	 * display full chain with details
+	 */
+	if (args.verbose > 0 || args.detect) {
+		char mess[512];
+		for (int i = 0; i < found; i++) {
+			int t = listDev[i];
+			printInfo("index " + std::to_string(i) + ":");
+			if (fpga_list.find(t) != fpga_list.end()) {
+				snprintf(mess, sizeof(mess),
+					"\tidcode 0x%x\n\tmanufacturer %s\n\tfamily %s\n\tmodel  %s\n"
+					"\tirlength %d",
+					t,
+					fpga_list[t].manufacturer.c_str(),
+					fpga_list[t].family.c_str(),
+					fpga_list[t].model.c_str(),
+					fpga_list[t].irlength);
+				printInfo(mess);
+			} else if (misc_dev_list.find(t) != misc_dev_list.end()) {
+				snprintf(mess, sizeof(mess),
+					"\tidcode   0x%x\n\ttype     %s\n\tirlength %d",
+					t,
+					misc_dev_list[t].name.c_str(),
+					misc_dev_list[t].irlength);
+				printInfo(mess);
+			}
+		}
+		if (args.detect == true) {
+			return EXIT_SUCCESS;
+		}
+	}
+
+	if (found != 0) {
+		if (args.index_chain == -1) {
+			for (int i = 0; i < found; i++) {
+				if (fpga_list.find(listDev[i]) != fpga_list.end()) {
+					index = i;
+					if (idcode != -1) {
+						printError("Error: more than one FPGA found");
+						printError("Use --index-chain to force selection");
+						for (int i = 0; i < found; i++) {
+							char mess[16];
+							snprintf(mess, sizeof(mess), "0x%08x", listDev[i]);
+							printError(mess);
+						}
+						return EXIT_FAILURE;
+					} else {
+						idcode = listDev[i];
+					}
+				}
+			}
+		} else {
+			index = args.index_chain;
+			if (index > found || index < 0) {
+				printError("wrong index for device in JTAG chain");
+				return EXIT_FAILURE;
+			}
+			idcode = listDev[index];
+			/* all devices to configure must be identical */
+			for (int dev : args.index_chain_list) {
+				if (dev >= found || dev < 0 || listDev[dev] != idcode) {
+					printError("wrong index or device mismatch in JTAG chain");
+					return EXIT_FAILURE;
+				}
+			}
+		}
+	} else {
+		printError("Error: no device found");
+		return EXIT_FAILURE;
+	}
+
+	jtag->device_select(index);
+
+	/* replay a recorded session: no vendor specific action */
+	if (!args.replay_file.empty()) {
+		bool ret = jtag->replay(args.replay_file);
+		if (ret)
+			printSuccess("replay: DONE");
+		return (ret) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/* log all following transactions */
+	if (!args.record_file.empty() && !jtag->start_recording(args.record_file)) {
+		return EXIT_FAILURE;
+	}
+
+	/* detect svf file and program the device */
+	if (!args.file_type.compare("svf") ||
+			args.bit_file.find(".svf") != string::npos) {
+		SVF_jtag *svf = new SVF_jtag(jtag, args.verbose);
+		try {
+			svf->parse(args.bit_file);
+		} catch (std::exception &e) {
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+    /* check if selected device is supported
+	 * mainly used in conjunction with --index-chain
+	 */
+	if (fpga_list.find(idcode) == fpga_list.end()) {
+		cerr << "Error: device " << hex << idcode << " not supported" << endl;
+		return EXIT_FAILURE;
+	}
+
+	string fab = fpga_list[idcode].manufacturer;
+
+
+	Device *fpga;
+	try {
+		TraceSpan span("Device::Device", "device");
+		if (fab == "xilinx") {
+			Xilinx *xil = new Xilinx(jtag, args.bit_file, args.secondary_bit_file,
+				args.file_type, args.prg_type, args.fpga_part, args.bridge_path,
+				args.target_flash, args.verify, args.verbose, args.skip_load_bridge, args.skip_reset);
+			xil->set_broadcast_list(args.index_chain_list);
+			fpga = xil;
+		} else if (args.index_chain_list.size() > 1) {
+			printError("Error: multiple devices only supported for Xilinx");
+			return EXIT_FAILURE;
+		} else if (fab == "altera") {
+			fpga = new Altera(jtag, args.bit_file, args.file_type,
+				args.prg_type, args.fpga_part, args.bridge_path, args.verify,
+				args.verbose, args.skip_load_bridge, args.skip_reset);
+		} else if (fab == "anlogic") {
+			fpga = new Anlogic(jtag, args.bit_file, args.file_type,
+				args.prg_type, args.verify, args.verbose);
+		} else if (fab == "efinix") {
+			fpga = new Efinix(jtag, args.bit_file, args.file_type,
+				args.prg_type, args.board, args.fpga_part, args.bridge_path,
+				args.verify, args.verbose);
+		} else if (fab == "Gowin") {
+			fpga = new Gowin(jtag, args.bit_file, args.file_type, args.mcufw,
+				args.prg_type, args.external_flash, args.verify, args.verbose);
+		} else if (fab == "lattice") {
+			fpga = new Lattice(jtag, args.bit_file, args.file_type,
+				args.prg_type, args.flash_sector, args.verify, args.verbose);
+		} else if (fab == "colognechip") {
+			fpga = new CologneChip(jtag, args.bit_file, args.file_type,
+				args.prg_type, args.board, args.cable, args.verify, args.verbose);
+		} else {
+			printError("Error: manufacturer " + fab + " not supported");
+			return EXIT_FAILURE;
+		}
+	} catch (std::exception &e) {
+		printError("Error: Failed to claim FPGA device: " + string(e.what()));
+		return EXIT_FAILURE;
+	}
+
+	if ((!args.bit_file.empty() ||
+		 !args.secondary_bit_file.empty() ||
+		 !args.file_type.empty())
+			&& args.prg_type != Device::RD_FLASH) {
+		stats_set_phase("program");
+		try {
+			TraceSpan span("Device::program", "device");
+			fpga->program(args.offset, args.unprotect_flash);
+		} catch (std::exception &e) {
+			printError("Error: Failed to program FPGA: " + string(e.what()));
+			delete(fpga);
+			return EXIT_FAILURE;
+		}
+	}
+
+	stats_set_phase("flash");
+	if (args.conmcu == true) {
+		TraceSpan span("Device::connectJtagToMCU", "device");
+		fpga->connectJtagToMCU();
+	}
+
+	/* unprotect SPI flash */
+	if (args.unprotect_flash && args.bit_file.empty()) {
+		TraceSpan span("Device::unprotect_flash", "device");
+		fpga->unprotect_flash();
+	}
+
+	/* bulk erase SPI flash */
+	if (args.bulk_erase_flash && args.bit_file.empty()) {
+		TraceSpan span("Device::bulk_erase_flash", "device");
+		fpga->bulk_erase_flash();
+	}
+
+	/* protect SPI flash */
+	if (args.protect_flash != 0) {
+		TraceSpan span("Device::protect_flash", "device");
+		fpga->protect_flash(args.protect_flash);
+	}
+
+	if (args.prg_type == Device::RD_FLASH) {
+		if (args.file_size == 0) {
+			printError("Error: 0 size for dump");
+		} else {
+			stats_set_phase("dump");
+			TraceSpan span("Device::dumpFlash", "device");
+			fpga->dumpFlash(args.offset, args.file_size);
+		}
+	}
+
+	if (args.reset) {
+		stats_set_phase("reset");
+		TraceSpan span("Device::reset", "device");
+		fpga->reset();
+	}
+
+	delete(fpga);
+	return EXIT_SUCCESS;
+}
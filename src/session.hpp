@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_SESSION_HPP_
+#define SRC_SESSION_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "device.hpp"
+#include "jtag.hpp"
+
+/*!
+ * \file session.hpp
+ * \brief options of one openFPGALoader session and JTAG operations
+ *        sequence (detect, load, flash, dump, reset) shared by the
+ *        command line front end and the library
+ */
+
+struct arguments {
+	int8_t verbose;
+	bool reset, detect, verify, scan_usb;
+	unsigned int offset;
+	std::string bit_file;
+	std::string secondary_bit_file;
+	std::string device;
+	std::string cable;
+	std::string ftdi_serial;
+	int ftdi_channel;
+	int status_pin;
+	uint32_t freq;
+	bool invert_read_edge;
+	std::string board;
+	bool pin_config;
+	bool list_cables;
+	bool list_boards;
+	bool list_fpga;
+	Device::prog_type_t prg_type;
+	bool is_list_command;
+	bool spi;
+	bool dfu;
+	std::string file_type;
+	std::string fpga_part;
+	std::string bridge_path;
+	std::string probe_firmware;
+	int index_chain;
+	unsigned int file_size;
+	std::string target_flash;
+	bool external_flash;
+	int16_t altsetting;
+	uint16_t vid;
+	uint16_t pid;
+	int16_t cable_index;
+	uint8_t bus_addr;
+	uint8_t device_addr;
+	std::string ip_adr;
+	uint32_t protect_flash;
+	bool unprotect_flash;
+	bool bulk_erase_flash;
+	std::string flash_sector;
+	bool skip_load_bridge;
+	bool skip_reset;
+	/* xvc server */
+	bool xvc;
+	int port;
+	std::string interface;
+	std::string mcufw;
+	bool conmcu;
+	std::vector<int> index_chain_list; /* devices configured together */
+	std::string chain_cache;
+	bool freq_auto;
+	std::string record_file;
+	std::string replay_file;
+	std::string stats_file;
+	std::string trace_file;
+	std::string multi_cable_file;
+	std::string daemon_socket;
+	std::string connect_socket;
+	std::string manifest_file;
+};
+
+/*!
+ * \brief default values for all options (command line without arguments)
+ */
+extern const struct arguments default_arguments;
+
+/*!
+ * \brief run operations described by args on an opened JTAG cable:
+ *        chain detection, device selection, then load/flash/dump/reset
+ * \param[in] args: session options (prg_type may be updated)
+ * \param[in] jtag: opened cable (not deleted)
+ * \return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int run_jtag_session(struct arguments &args, Jtag *jtag);
+
+#endif  // SRC_SESSION_HPP_
@@ -17,6 +17,7 @@
 #include "spiFlash.hpp"
 #include "spiFlashdb.hpp"
 #include "spiInterface.hpp"
+#include "traceEvent.hpp"
 
 /* read/write status register : 0B addr + 0 dummy */
 #define FLASH_WRSR     0x01
@@ -94,6 +95,7 @@ SPIFlash::SPIFlash(SPIInterface *spi, bool unprotect, int8_t verbose):
 
 int SPIFlash::bulk_erase()
 {
+	TraceSpan span("SPIFlash::bulk_erase", "spiflash");
 	int ret, ret2 = 0;
 	uint32_t timeout=1000000;
 	uint8_t bp = get_bp();
@@ -111,8 +113,10 @@ int SPIFlash::bulk_erase()
 	if ((ret = write_enable()) != 0)
 		return ret;
 	ret2 = _spi->spi_put(FLASH_CE, NULL, NULL, 0);
-	if (ret2 == 0)
+	if (ret2 == 0) {
+		TraceSpan busy("flash busy", "wait");
 		ret2 = _spi->spi_wait(FLASH_RDSR, FLASH_RDSR_WIP, 0x00, timeout);
+	}
 
 	if (bp != 0)
 		ret = enable_protection(bp);
@@ -123,6 +127,7 @@ int SPIFlash::bulk_erase()
 /* sector -> subsector for micron */
 int SPIFlash::sector_erase(int addr)
 {
+	TraceSpan span("SPIFlash::sector_erase", "spiflash");
 	uint8_t tx[5];
 	uint32_t len = 0;
 
@@ -142,6 +147,7 @@ int SPIFlash::sector_erase(int addr)
 
 int SPIFlash::block32_erase(int addr)
 {
+	TraceSpan span("SPIFlash::block32_erase", "spiflash");
 	uint8_t tx[5];
 	uint32_t len = 0;
 
@@ -162,6 +168,7 @@ int SPIFlash::block32_erase(int addr)
 /* block64 -> sector for micron */
 int SPIFlash::block64_erase(int addr)
 {
+	TraceSpan span("SPIFlash::block64_erase", "spiflash");
 	uint8_t tx[5];
 	uint32_t len = 0;
 
@@ -181,6 +188,7 @@ int SPIFlash::block64_erase(int addr)
 
 int SPIFlash::sectors_erase(int base_addr, int size)
 {
+	TraceSpan span("SPIFlash::sectors_erase", "spiflash", size);
 
 	// check if chip support sector and subsector erase
 	bool subsector_rdy = false, sector_rdy = true;
@@ -219,6 +227,7 @@ int SPIFlash::sectors_erase(int base_addr, int size)
 		if (ret == -1) {
 			break;
 		}
+		TraceSpan busy("flash busy", "wait");
 		if (_spi->spi_wait(FLASH_RDSR, FLASH_RDSR_WIP, 0x00, 100000, false) == -1) {
 			ret = -1;
 			break;
@@ -235,6 +244,7 @@ int SPIFlash::sectors_erase(int base_addr, int size)
 
 int SPIFlash::write_page(int addr, uint8_t *data, int len)
 {
+	TraceSpan span("SPIFlash::write_page", "spiflash", len);
 	uint32_t addr_len;
 	uint8_t write_cmd;
 	uint32_t i = 0;
@@ -261,11 +271,13 @@ int SPIFlash::write_page(int addr, uint8_t *data, int len)
 		return -1;
 
 	_spi->spi_put(write_cmd, tx, NULL, len+addr_len);
+	TraceSpan busy("flash busy", "wait");
 	return _spi->spi_wait(FLASH_RDSR, FLASH_RDSR_WIP, 0x00, 1000);
 }
 
 int SPIFlash::read(int base_addr, uint8_t *data, int len)
 {
+	TraceSpan span("SPIFlash::read", "spiflash", len);
 	uint32_t addr_len;
 	uint8_t read_cmd;
 	uint32_t i = 0;
@@ -291,13 +303,14 @@ int SPIFlash::read(int base_addr, uint8_t *data, int len)
 	if (ret == 0)
 		memcpy(data, rx+addr_len, len);
 	else
-		printf("error\n");
+		printfInfo("error\n");
 	return ret;
 }
 
 bool SPIFlash::dump(const std::string &filename, const int &base_addr,
 		const int &len, int rd_burst)
 {
+	TraceSpan span("SPIFlash::dump", "spiflash", len);
 	if (rd_burst == 0)
 		rd_burst = len;
 
@@ -342,6 +355,7 @@ bool SPIFlash::dump(const std::string &filename, const int &base_addr,
 
 int SPIFlash::erase_and_prog(int base_addr, uint8_t *data, int len)
 {
+	TraceSpan span("SPIFlash::erase_and_prog", "spiflash", len);
 	if (_jedec_id == 0) {
 		try {
 			read_id();
@@ -379,7 +393,7 @@ int SPIFlash::erase_and_prog(int base_addr, uint8_t *data, int len)
 			if (tb == -1)
 				return -1;
 			std::map<std::string, uint32_t> lock_len = bp_to_len(status, tb);
-			printf("%08x %08x %08x %02x\n", base_addr,
+			printfInfo("%08x %08x %08x %02x\n", base_addr,
 					lock_len["start"], lock_len["end"], status);
 
 			/* if some blocks are locked */
@@ -419,7 +433,7 @@ int SPIFlash::erase_and_prog(int base_addr, uint8_t *data, int len)
 
 	/* if it's needs to unlock */
 	if (must_relock) {
-		printf("unlock blocks\n");
+		printfInfo("unlock blocks\n");
 		if (!_unprotect) {
 			printError("Error: block protection is set");
 			printError("       can't unlock without --unprotect-flash");
@@ -460,6 +474,7 @@ int SPIFlash::erase_and_prog(int base_addr, uint8_t *data, int len)
 bool SPIFlash::verify(const int &base_addr, const uint8_t *data,
 		const int &len, int rd_burst)
 {
+	TraceSpan span("SPIFlash::verify", "spiflash", len);
 	if (rd_burst == 0) {
 		rd_burst = len;
 		if (rd_burst > 65536)
@@ -519,7 +534,7 @@ void SPIFlash::read_id()
 		_jedec_id = _jedec_id << 8;
 		_jedec_id |= (0x00ff & (int)rx[i]);
 		if (_verbose > 0)
-			printf("%x ", rx[i]);
+			printfInfo("%x ", rx[i]);
 	}
 
 	/* something wrong with read */
@@ -527,7 +542,7 @@ void SPIFlash::read_id()
 		throw std::runtime_error("Read ID failed");
 
 	if (_verbose > 0)
-		printf("read %x\n", _jedec_id);
+		printfInfo("read %x\n", _jedec_id);
 	auto t = flash_list.find(_jedec_id >> 8);
 	if (t != flash_list.end()) {
 		_flash_model = &(*t).second;
@@ -546,20 +561,20 @@ void SPIFlash::read_id()
 
 		/* must be 0x20BA1810 ... */
 
-		printf("Detail: \n");
-		printf("Jedec ID          : %02x\n", rx[0]);
-		printf("memory type       : %02x\n", rx[1]);
-		printf("memory capacity   : %02x\n", rx[2]);
+		printfInfo("Detail: \n");
+		printfInfo("Jedec ID          : %02x\n", rx[0]);
+		printfInfo("memory type       : %02x\n", rx[1]);
+		printfInfo("memory capacity   : %02x\n", rx[2]);
 		if (has_edid) {
-			printf("EDID + CFD length : %02x\n", rx[3]);
-			printf("EDID              : %02x%02x\n", rx[5], rx[4]);
-			printf("CFD               : ");
+			printfInfo("EDID + CFD length : %02x\n", rx[3]);
+			printfInfo("EDID              : %02x%02x\n", rx[5], rx[4]);
+			printfInfo("CFD               : ");
 			if (_verbose > 0) {
 				for (int i = 6; i < len; i++)
-					printf("%02x ", rx[i]);
-				printf("\n");
+					printfInfo("%02x ", rx[i]);
+				printfInfo("\n");
 			} else {
-				printf("\n");
+				printfInfo("\n");
 			}
 		}
 	}
@@ -583,48 +598,48 @@ void SPIFlash::display_status_reg(uint8_t reg)
 	}
 
 	// status register
-	printf("RDSR : %02x\n", reg);
+	printfInfo("RDSR : %02x\n", reg);
 	if ((_jedec_id >> 8) != 0xBF2642) {
-		printf("WIP  : %d\n", reg&0x01);
-		printf("WEL  : %d\n", (reg>>1)&0x01);
-		printf("BP   : %x\n", bp);
+		printfInfo("WIP  : %d\n", reg&0x01);
+		printfInfo("WEL  : %d\n", (reg>>1)&0x01);
+		printfInfo("BP   : %x\n", bp);
 		if ((_jedec_id >> 8) != 0x9d60) {
-			printf("TB   : %d\n", tb);
+			printfInfo("TB   : %d\n", tb);
 		} else {  // ISSI IS25LP
-			printf("QE   : %d\n", ((reg >> 6) & 0x01));
+			printfInfo("QE   : %d\n", ((reg >> 6) & 0x01));
 		}
-		printf("SRWD : %d\n", ((reg >> 7) & 0x01));
+		printfInfo("SRWD : %d\n", ((reg >> 7) & 0x01));
 	} else {
-		printf("BUSY : %d\n", (reg >> 0) & 0x01);
-		printf("WEL  : %d\n", (reg >> 1) & 0x01);
-		printf("WSE  : %d\n", (reg >> 2) & 0x01);
-		printf("WSP  : %d\n", (reg >> 3) & 0x01);
-		printf("WPLD : %d\n", (reg >> 4) & 0x01);
-		printf("SEC  : %d\n", (reg >> 5) & 0x01);
-		printf("BUSY : %d\n", (reg >> 7) & 0x01);
+		printfInfo("BUSY : %d\n", (reg >> 0) & 0x01);
+		printfInfo("WEL  : %d\n", (reg >> 1) & 0x01);
+		printfInfo("WSE  : %d\n", (reg >> 2) & 0x01);
+		printfInfo("WSP  : %d\n", (reg >> 3) & 0x01);
+		printfInfo("WPLD : %d\n", (reg >> 4) & 0x01);
+		printfInfo("SEC  : %d\n", (reg >> 5) & 0x01);
+		printfInfo("BUSY : %d\n", (reg >> 7) & 0x01);
 	}
 
 	/* function register */
 	switch (_jedec_id >> 8) {
 		case 0x9d60:
 			_spi->spi_put(FLASH_RDFR, NULL, &reg, 1);
-			printf("\nFunction Register\n");
-			printf("RDFR : %02x\n", reg);
-			printf("RES  : %d\n", ((reg >> 0) & 0x01));
-			printf("TBS  : %d\n", ((reg >> 1) & 0x01));
-			printf("PSUS : %d\n", ((reg >> 2) & 0x01));
-			printf("ESUS : %d\n", ((reg >> 3) & 0x01));
-			printf("IRL  : %x\n", ((reg >> 4) & 0x0f));
+			printfInfo("\nFunction Register\n");
+			printfInfo("RDFR : %02x\n", reg);
+			printfInfo("RES  : %d\n", ((reg >> 0) & 0x01));
+			printfInfo("TBS  : %d\n", ((reg >> 1) & 0x01));
+			printfInfo("PSUS : %d\n", ((reg >> 2) & 0x01));
+			printfInfo("ESUS : %d\n", ((reg >> 3) & 0x01));
+			printfInfo("IRL  : %x\n", ((reg >> 4) & 0x0f));
 			break;
 		case 0x010216:
 			_spi->spi_put(FLASH_RDCR, NULL, &reg, 1);
-			printf("\nConfiguration Register\n");
-			printf("RDCR   : %02x\n", reg);
-			printf("FREEZE : %d\n", ((reg >> 0) & 0x01));
-			printf("QUAD   : %d\n", ((reg >> 1) & 0x01));
-			printf("TBPARM : %d\n", ((reg >> 2) & 0x01));
-			printf("BPNV   : %d\n", ((reg >> 3) & 0x01));
-			printf("TBPROT : %d\n", ((reg >> 5) & 0x01));
+			printfInfo("\nConfiguration Register\n");
+			printfInfo("RDCR   : %02x\n", reg);
+			printfInfo("FREEZE : %d\n", ((reg >> 0) & 0x01));
+			printfInfo("QUAD   : %d\n", ((reg >> 1) & 0x01));
+			printfInfo("TBPARM : %d\n", ((reg >> 2) & 0x01));
+			printfInfo("BPNV   : %d\n", ((reg >> 3) & 0x01));
+			printfInfo("TBPROT : %d\n", ((reg >> 5) & 0x01));
 			break;
 	}
 }
@@ -641,7 +656,7 @@ uint16_t SPIFlash::readNonVolatileCfgReg()
 	uint8_t rx[2];
 	_spi->spi_put(FLASH_RDNVCR, NULL, rx, 2);
 	if (_verbose > 0)
-		printf("Non Volatile %x %x\n", rx[0], rx[1]);
+		printfInfo("Non Volatile %x %x\n", rx[0], rx[1]);
 	return (rx[1] << 8) | rx[0];
 }
 
@@ -650,7 +665,7 @@ uint16_t SPIFlash::readVolatileCfgReg()
 	uint8_t rx[2];
 	_spi->spi_put(FLASH_RDVCR, NULL, rx, 2);
 	if (_verbose > 0)
-		printf("Volatile %x %x\n", rx[0], rx[1]);
+		printfInfo("Volatile %x %x\n", rx[0], rx[1]);
 	return (rx[1] << 8) | rx[0];
 }
 
@@ -669,7 +684,7 @@ int SPIFlash::write_enable()
 	_spi->spi_put(FLASH_WREN, NULL, NULL, 0);
 	/* wait WEL */
 	if (_spi->spi_wait(FLASH_RDSR, FLASH_RDSR_WEL, FLASH_RDSR_WEL, 1000)) {
-		printf("write en: Error\n");
+		printfInfo("write en: Error\n");
 		return -1;
 	}
 
@@ -682,9 +697,9 @@ int SPIFlash::write_disable()
 	/* wait ! WEL */
 	int ret = _spi->spi_wait(FLASH_RDSR, FLASH_RDSR_WEL, 0x00, 1000);
 	if (ret == -1)
-		printf("write disable: Error\n");
+		printfInfo("write disable: Error\n");
 	else if (_verbose > 0)
-		printf("write disable: Success\n");
+		printfInfo("write disable: Success\n");
 	return ret;
 }
 
@@ -702,7 +717,7 @@ int SPIFlash::disable_protection()
 
 	/* read status */
 	if (read_status_reg() != 0) {
-		std::cout << "disable protection failed" << std::endl;
+		printError("disable protection failed");
 		return -1;
 	}
 
@@ -897,7 +912,7 @@ std::map<std::string, uint32_t> SPIFlash::bp_to_len(uint8_t bp, uint8_t tb)
 			tmp |= (1 << i);
 	/* bp code is 2^(bp-1) blocks */
 	uint16_t nr_sectors = (1 << (tmp-1));
-	printf("nr_sectors : %d\n", nr_sectors);
+	printfInfo("nr_sectors : %d\n", nr_sectors);
 	uint32_t len = nr_sectors * 0x10000;
 	if (tb == 1) {
 		protect_area["start"] = 0;
@@ -948,7 +963,7 @@ bool SPIFlash::global_unlock()
 	/* check if all sectors are unlocked */
 	uint8_t rx2[10];
 	_spi->spi_put(FLASH_RBPR, NULL, rx2, 10);
-	printf("Non Volatile\n");
+	printfInfo("Non Volatile\n");
 	for (int i = 0; i < 10; i++) {
 		if (rx2[i] != 0)
 			return false;
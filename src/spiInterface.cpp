@@ -9,6 +9,7 @@
 #include "display.hpp"
 #include "spiInterface.hpp"
 #include "spiFlash.hpp"
+#include "traceEvent.hpp"
 
 SPIInterface::SPIInterface():_spif_verbose(0), _spif_rd_burst(0),
 	_spif_verify(false), _skip_load_bridge(false)
@@ -22,6 +23,18 @@ SPIInterface::SPIInterface(const std::string &filename, int8_t verbose,
 	_skip_reset(skip_reset), _spif_filename(filename)
 {}
 
+bool SPIInterface::enter_flash_access()
+{
+	TraceSpan span("bridge load", "phase");
+	return prepare_flash_access();
+}
+
+bool SPIInterface::leave_flash_access()
+{
+	TraceSpan span("post flash access", "phase");
+	return post_flash_access();
+}
+
 /* spiFlash generic acces */
 bool SPIInterface::protect_flash(uint32_t len)
 {
@@ -29,7 +42,7 @@ bool SPIInterface::protect_flash(uint32_t len)
 	printInfo("protect_flash: ", false);
 
 	/* move device to spi access */
-	if (!prepare_flash_access()) {
+	if (!enter_flash_access()) {
 		printError("Fail");
 		return false;
 	}
@@ -51,7 +64,7 @@ bool SPIInterface::protect_flash(uint32_t len)
 	}
 
 	/* reload bitstream */
-	return post_flash_access() && ret;
+	return leave_flash_access() && ret;
 }
 
 bool SPIInterface::unprotect_flash()
@@ -59,7 +72,7 @@ bool SPIInterface::unprotect_flash()
 	bool ret = true;
 
 	/* move device to spi access */
-	if (!prepare_flash_access()) {
+	if (!enter_flash_access()) {
 		printError("SPI Flash prepare access failed");
 		return false;
 	}
@@ -82,7 +95,7 @@ bool SPIInterface::unprotect_flash()
 	}
 
 	/* reload bitstream */
-	return post_flash_access() && ret;
+	return leave_flash_access() && ret;
 }
 
 bool SPIInterface::bulk_erase_flash()
@@ -91,7 +104,7 @@ bool SPIInterface::bulk_erase_flash()
 	printInfo("bulk_erase: ", false);
 
 	/* move device to spi access */
-	if (!prepare_flash_access()) {
+	if (!enter_flash_access()) {
 		printError("Fail");
 		return false;
 	}
@@ -113,14 +126,14 @@ bool SPIInterface::bulk_erase_flash()
 	}
 
 	/* reload bitstream */
-	return post_flash_access() && ret;
+	return leave_flash_access() && ret;
 }
 
 bool SPIInterface::write(uint32_t offset, uint8_t *data, uint32_t len,
 		bool unprotect_flash)
 {
 	bool ret = true;
-	if (!prepare_flash_access())
+	if (!enter_flash_access())
 		return false;
 
 	/* test SPI */
@@ -136,7 +149,7 @@ bool SPIInterface::write(uint32_t offset, uint8_t *data, uint32_t len,
 		ret = false;
 	}
 
-	bool ret2 = post_flash_access();
+	bool ret2 = leave_flash_access();
 	return ret && ret2;
 }
 
@@ -144,7 +157,7 @@ bool SPIInterface::read(uint8_t *data, uint32_t base_addr, uint32_t len)
 {
 	bool ret = true;
 	/* enable SPI flash access */
-	if (!prepare_flash_access())
+	if (!enter_flash_access())
 		return false;
 
 	try {
@@ -156,14 +169,14 @@ bool SPIInterface::read(uint8_t *data, uint32_t base_addr, uint32_t len)
 	}
 
 	/* reload bitstream */
-	return post_flash_access() && ret == 0;
+	return leave_flash_access() && ret == 0;
 }
 
 bool SPIInterface::dump(uint32_t base_addr, uint32_t len)
 {
 	bool ret = true;
 	/* enable SPI flash access */
-	if (!prepare_flash_access())
+	if (!enter_flash_access())
 		return false;
 
 	try {
@@ -175,5 +188,5 @@ bool SPIInterface::dump(uint32_t base_addr, uint32_t len)
 	}
 
 	/* reload bitstream */
-	return post_flash_access() && ret;
+	return leave_flash_access() && ret;
 }
@@ -118,6 +118,13 @@ class SPIInterface {
 	bool _skip_reset; /*!< don't reset the device after write */
 
  private:
+	/*!
+	 * \brief prepare_flash_access() and post_flash_access() with
+	 *        a trace span (bridge load, device reload)
+	 */
+	bool enter_flash_access();
+	bool leave_flash_access();
+
 	std::string _spif_filename;
 };
 #endif  // SRC_SPIINTERFACE_HPP_
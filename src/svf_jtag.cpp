@@ -225,10 +225,9 @@ void SVF_jtag::parse_runtest(vector<string> const &vstr)
 		_end_state = run_state;
 	}
 	_jtag->set_state(_run_state);
-	_jtag->toggleClk(nb_iter);
-	if (min_duration > 0) {
-		usleep((useconds_t)(min_duration * 1.0E6));
-	}
+	/* both run_count and min_time must be satisfied */
+	_jtag->delay((min_duration > 0) ? (uint64_t)(min_duration * 1.0E9) : 0,
+		nb_iter);
 	_jtag->set_state(_end_state);
 	}
 
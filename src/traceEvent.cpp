@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "traceEvent.hpp"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+typedef struct {
+	std::string name;
+	const char *cat;
+	uint64_t start;
+	uint64_t end;
+	int64_t size;
+} trace_event_t;
+
+static bool trace_on = false;
+static uint64_t trace_origin = 0;
+static std::vector<trace_event_t> trace_events;
+
+void trace_enable()
+{
+	trace_on = true;
+	trace_events.clear();
+	trace_origin = trace_now();
+}
+
+bool trace_enabled()
+{
+	return trace_on;
+}
+
+uint64_t trace_now()
+{
+	if (!trace_on)
+		return 0;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_complete(const std::string &name, const char *cat,
+	uint64_t start, uint64_t end, int64_t size)
+{
+	if (!trace_on)
+		return;
+	trace_events.push_back({name, cat, start, end, size});
+}
+
+/* names are internal strings: only quotes and backslashes are escaped */
+static std::string escape(const std::string &str)
+{
+	std::string ret;
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			ret += '\\';
+		ret += c;
+	}
+	return ret;
+}
+
+bool trace_write(const std::string &filename)
+{
+	if (!trace_on)
+		return false;
+
+	FILE *fd = fopen(filename.c_str(), "w");
+	if (!fd)
+		return false;
+
+	fprintf(fd, "{\"traceEvents\": [\n");
+	fprintf(fd, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+		"\"tid\": 1, \"args\": {\"name\": \"openFPGALoader\"}}");
+	for (const trace_event_t &ev : trace_events) {
+		/* timestamps and durations are in us */
+		fprintf(fd, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+			"\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": 1",
+			escape(ev.name).c_str(), ev.cat,
+			(ev.start - trace_origin) / 1e3, (ev.end - ev.start) / 1e3);
+		if (ev.size >= 0)
+			fprintf(fd, ", \"args\": {\"bytes\": %lld}", (long long)ev.size);
+		fprintf(fd, "}");
+	}
+	fprintf(fd, "\n],\n\"displayTimeUnit\": \"ms\"}\n");
+
+	fclose(fd);
+	return true;
+}
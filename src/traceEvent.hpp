@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_TRACEEVENT_HPP_
+#define SRC_TRACEEVENT_HPP_
+
+#include <cstdint>
+#include <string>
+
+/*!
+ * \file traceEvent.hpp
+ * \brief timeline of a session in Chrome/Perfetto trace-event format
+ *        (JSON, complete "X" events). Events are kept in memory and
+ *        written by trace_write(). All functions do nothing until
+ *        trace_enable() is called
+ */
+
+/*!
+ * \brief enable events recording
+ */
+void trace_enable();
+
+/*!
+ * \brief return true when events are recorded
+ */
+bool trace_enabled();
+
+/*!
+ * \brief monotonic time in ns (same clock as stats_start()),
+ *        0 when disabled
+ */
+uint64_t trace_now();
+
+/*!
+ * \brief add one complete event
+ * \param[in] name: event name
+ * \param[in] cat: event category
+ * \param[in] start: start time (trace_now())
+ * \param[in] end: end time (trace_now())
+ * \param[in] size: size argument (bytes), < 0 when not relevant
+ */
+void trace_complete(const std::string &name, const char *cat,
+	uint64_t start, uint64_t end, int64_t size = -1);
+
+/*!
+ * \brief write events (JSON)
+ * \param[in] filename: output file
+ * \return false when file can't be written
+ */
+bool trace_write(const std::string &filename);
+
+/*!
+ * \class TraceSpan
+ * \brief scoped event: starts at construction, ends at destruction
+ */
+class TraceSpan {
+ public:
+	/*!
+	 * \param[in] name: event name
+	 * \param[in] cat: event category
+	 * \param[in] size: size argument (bytes), < 0 when not relevant
+	 */
+	TraceSpan(const std::string &name, const char *cat, int64_t size = -1):
+		_name(name), _cat(cat), _size(size), _start(trace_now()) {}
+	~TraceSpan() {
+		if (_start != 0)
+			trace_complete(_name, _cat, _start, trace_now(), _size);
+	}
+
+ private:
+	std::string _name;
+	const char *_cat;
+	int64_t _size;
+	uint64_t _start; /*!< 0 when trace is disabled */
+};
+
+#endif  // SRC_TRACEEVENT_HPP_
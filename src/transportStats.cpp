@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "transportStats.hpp"
+#include "traceEvent.hpp"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+typedef struct {
+	std::string name;
+	uint64_t bytes_out;
+	uint64_t bytes_in;
+	uint64_t xfers;
+	uint64_t forced_flushes;
+	uint64_t round_trips;
+	uint64_t bits;
+	uint64_t blocked_ns;
+	uint64_t duration_ns;
+} phase_stats_t;
+
+static bool stats_enabled = false;
+static std::vector<phase_stats_t> stats_phases;
+static size_t stats_cur = 0;
+static uint64_t stats_phase_start = 0;
+static bool stats_last_out = false;  /* last transfer was a write */
+
+static uint64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void stats_enable()
+{
+	stats_enabled = true;
+	stats_phases.clear();
+	stats_phases.push_back({"init", 0, 0, 0, 0, 0, 0, 0, 0});
+	stats_cur = 0;
+	stats_phase_start = now_ns();
+}
+
+std::string stats_set_phase(const std::string &phase)
+{
+	if (!stats_enabled)
+		return "";
+	std::string prev = stats_phases[stats_cur].name;
+	uint64_t now = now_ns();
+	stats_phases[stats_cur].duration_ns += now - stats_phase_start;
+	stats_phase_start = now;
+
+	for (stats_cur = 0; stats_cur < stats_phases.size(); stats_cur++) {
+		if (stats_phases[stats_cur].name == phase)
+			return prev;
+	}
+	stats_phases.push_back({phase, 0, 0, 0, 0, 0, 0, 0, 0});
+	return prev;
+}
+
+uint64_t stats_start()
+{
+	return (stats_enabled || trace_enabled()) ? now_ns() : 0;
+}
+
+void stats_xfer_out(uint32_t bytes, uint64_t start)
+{
+	if (!stats_enabled && !trace_enabled())
+		return;
+	uint64_t now = now_ns();
+	trace_complete("xfer out", "xfer", start, now, bytes);
+	if (!stats_enabled)
+		return;
+	phase_stats_t &s = stats_phases[stats_cur];
+	s.bytes_out += bytes;
+	s.xfers++;
+	s.blocked_ns += now - start;
+	stats_last_out = true;
+}
+
+void stats_xfer_in(uint32_t bytes, uint64_t start)
+{
+	if (!stats_enabled && !trace_enabled())
+		return;
+	uint64_t now = now_ns();
+	trace_complete("xfer in", "xfer", start, now, bytes);
+	if (!stats_enabled)
+		return;
+	phase_stats_t &s = stats_phases[stats_cur];
+	s.bytes_in += bytes;
+	s.xfers++;
+	s.blocked_ns += now - start;
+	if (stats_last_out)
+		s.round_trips++;
+	stats_last_out = false;
+}
+
+int stats_libusb_bulk_transfer(libusb_device_handle *dev_handle,
+	unsigned char endpoint, unsigned char *data, int length,
+	int *transferred, unsigned int timeout)
+{
+	uint64_t t = stats_start();
+	int ret = libusb_bulk_transfer(dev_handle, endpoint, data, length,
+		transferred, timeout);
+	if (endpoint & LIBUSB_ENDPOINT_IN)
+		stats_xfer_in((ret < 0) ? 0 : *transferred, t);
+	else
+		stats_xfer_out((ret < 0) ? 0 : *transferred, t);
+	return ret;
+}
+
+void stats_forced_flush()
+{
+	if (stats_enabled)
+		stats_phases[stats_cur].forced_flushes++;
+}
+
+void stats_bits(uint64_t bits)
+{
+	if (stats_enabled)
+		stats_phases[stats_cur].bits += bits;
+}
+
+static void write_phase(FILE *fd, const phase_stats_t &s, const char *indent)
+{
+	double duration = s.duration_ns / 1e9;
+	fprintf(fd, "%s\"name\": \"%s\",\n", indent, s.name.c_str());
+	fprintf(fd, "%s\"duration_s\": %.6f,\n", indent, duration);
+	fprintf(fd, "%s\"bytes_out\": %llu,\n", indent,
+		(unsigned long long)s.bytes_out);
+	fprintf(fd, "%s\"bytes_in\": %llu,\n", indent,
+		(unsigned long long)s.bytes_in);
+	fprintf(fd, "%s\"transfers\": %llu,\n", indent,
+		(unsigned long long)s.xfers);
+	fprintf(fd, "%s\"forced_flushes\": %llu,\n", indent,
+		(unsigned long long)s.forced_flushes);
+	fprintf(fd, "%s\"read_round_trips\": %llu,\n", indent,
+		(unsigned long long)s.round_trips);
+	fprintf(fd, "%s\"blocked_s\": %.6f,\n", indent, s.blocked_ns / 1e9);
+	fprintf(fd, "%s\"bits_shifted\": %llu,\n", indent,
+		(unsigned long long)s.bits);
+	fprintf(fd, "%s\"bits_per_s\": %.0f\n", indent,
+		(duration > 0) ? s.bits / duration : 0);
+}
+
+bool stats_write(const std::string &filename)
+{
+	if (!stats_enabled)
+		return false;
+	/* close current phase */
+	stats_set_phase(stats_phases[stats_cur].name);
+
+	FILE *fd = (filename == "-") ? stdout : fopen(filename.c_str(), "w");
+	if (!fd)
+		return false;
+
+	phase_stats_t total = {"total", 0, 0, 0, 0, 0, 0, 0, 0};
+	fprintf(fd, "{\n\t\"phases\": [\n");
+	for (size_t i = 0; i < stats_phases.size(); i++) {
+		const phase_stats_t &s = stats_phases[i];
+		fprintf(fd, "\t\t{\n");
+		write_phase(fd, s, "\t\t\t");
+		fprintf(fd, "\t\t}%s\n", (i + 1 < stats_phases.size()) ? "," : "");
+		total.bytes_out += s.bytes_out;
+		total.bytes_in += s.bytes_in;
+		total.xfers += s.xfers;
+		total.forced_flushes += s.forced_flushes;
+		total.round_trips += s.round_trips;
+		total.bits += s.bits;
+		total.blocked_ns += s.blocked_ns;
+		total.duration_ns += s.duration_ns;
+	}
+	fprintf(fd, "\t],\n\t\"total\": {\n");
+	write_phase(fd, total, "\t\t");
+	fprintf(fd, "\t}\n}\n");
+
+	if (fd != stdout)
+		fclose(fd);
+	return true;
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_TRANSPORTSTATS_HPP_
+#define SRC_TRANSPORTSTATS_HPP_
+
+#include <libusb.h>
+
+#include <cstdint>
+#include <string>
+
+/*!
+ * \file transportStats.hpp
+ * \brief converters transport counters (bytes, transfers, flushes, read
+ *        round trips, time blocked in USB/socket calls, bits shifted)
+ *        per program phase. All functions do nothing until
+ *        stats_enable() is called. Transfers are also added to the
+ *        timeline when trace is enabled (traceEvent.hpp)
+ *
+ * usage around a blocking call:
+ *     uint64_t t = stats_start();
+ *     ret = libusb_bulk_transfer(...);
+ *     stats_xfer_out(len, t);
+ */
+
+/*!
+ * \brief enable counters and set first phase
+ */
+void stats_enable();
+
+/*!
+ * \brief select phase for following counters
+ * \param[in] phase: phase name
+ * \return previous phase name
+ */
+std::string stats_set_phase(const std::string &phase);
+
+/*!
+ * \brief timestamp before a blocking call
+ * \return monotonic time in ns (0 when disabled)
+ */
+uint64_t stats_start();
+
+/*!
+ * \brief one transfer to converter done
+ * \param[in] bytes: number of bytes sent
+ * \param[in] start: stats_start() value before the call
+ */
+void stats_xfer_out(uint32_t bytes, uint64_t start);
+
+/*!
+ * \brief one transfer from converter done. The first read after a
+ *        write is counted as a read round trip
+ * \param[in] bytes: number of bytes received
+ * \param[in] start: stats_start() value before the call
+ */
+void stats_xfer_in(uint32_t bytes, uint64_t start);
+
+/*!
+ * \brief libusb_bulk_transfer with counters (same arguments)
+ */
+int stats_libusb_bulk_transfer(libusb_device_handle *dev_handle,
+	unsigned char endpoint, unsigned char *data, int length,
+	int *transferred, unsigned int timeout);
+
+/*!
+ * \brief converter buffer sent before being full (explicit flush,
+ *        read...)
+ */
+void stats_forced_flush();
+
+/*!
+ * \brief bits shifted on JTAG or SPI bus
+ * \param[in] bits: number of bits
+ */
+void stats_bits(uint64_t bits);
+
+/*!
+ * \brief write counters (JSON)
+ * \param[in] filename: output file, "-" for stdout
+ * \return false when file can't be written
+ */
+bool stats_write(const std::string &filename);
+
+#endif  // SRC_TRANSPORTSTATS_HPP_
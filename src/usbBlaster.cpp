@@ -15,6 +15,7 @@
 #include "display.hpp"
 #include "ftdipp_mpsse.hpp"
 #include "fx2_ll.hpp"
+#include "transportStats.hpp"
 #include "usbBlaster.hpp"
 
 using namespace std;
@@ -31,7 +32,7 @@ using namespace std;
 #ifdef DEBUG
 #define display(...) \
 	do { \
-		if (_verbose) fprintf(stdout, __VA_ARGS__); \
+		if (_verbose) printfInfo(__VA_ARGS__); \
 	}while(0)
 #else
 #define display(...) do {}while(0)
@@ -351,7 +352,7 @@ UsbBlasterI::UsbBlasterI()
 
      ret = ftdi_usb_open(_ftdi, 0x09fb, 0x6001);
     if (ret < 0) {
-		fprintf(stderr, "unable to open ftdi device: %d (%s)\n",
+		printfError("unable to open ftdi device: %d (%s)\n",
 			ret, ftdi_get_error_string(_ftdi));
 		ftdi_free(_ftdi);
 		throw std::exception();
@@ -359,7 +360,7 @@ UsbBlasterI::UsbBlasterI()
 
 	ret = ftdi_usb_reset(_ftdi);
 	if (ret < 0) {
-		fprintf(stderr, "Error reset: %d (%s)\n",
+		printfError("Error reset: %d (%s)\n",
 			ret, ftdi_get_error_string(_ftdi));
 		ftdi_free(_ftdi);
 		throw std::exception();
@@ -367,7 +368,7 @@ UsbBlasterI::UsbBlasterI()
 
 	ret = ftdi_set_latency_timer(_ftdi, 2);
 	if (ret < 0) {
-		fprintf(stderr, "Error set latency timer: %d (%s)\n",
+		printfError("Error set latency timer: %d (%s)\n",
 			ret, ftdi_get_error_string(_ftdi));
 		ftdi_free(_ftdi);
 		throw std::exception();
@@ -395,22 +396,26 @@ int UsbBlasterI::write(uint8_t *wr_buf, int wr_len,
 {
 	int ret = 0;
 
+	uint64_t t = stats_start();
 	ret = ftdi_write_data(_ftdi, wr_buf, wr_len);
 	if (ret != wr_len) {
-		printf("problem %d written %d\n", ret, wr_len);
+		printfInfo("problem %d written %d\n", ret, wr_len);
 		return ret;
 	}
+	stats_xfer_out(wr_len, t);
 
 	if (rd_buf) {
 		int timeout = 100;
 		uint8_t byte_read = 0;
 		while (byte_read < rd_len && timeout != 0) {
 			timeout--;
+			t = stats_start();
 			ret = ftdi_read_data(_ftdi, rd_buf + byte_read, rd_len - byte_read);
 			if (ret < 0) {
 				printError("Read error: " + std::to_string(ret));
 				return ret;
 			}
+			stats_xfer_in(ret, t);
 			byte_read += ret;
 		}
 
@@ -418,8 +423,8 @@ int UsbBlasterI::write(uint8_t *wr_buf, int wr_len,
 			printError("Error: timeout " + std::to_string(byte_read) +
 				" " + std::to_string(rd_len));
 			for (int i=0; i < byte_read; i++)
-				printf("%02x ", rd_buf[i]);
-			printf("\n");
+				printfInfo("%02x ", rd_buf[i]);
+			printfInfo("\n");
 			return 0;
 		}
 	}
@@ -476,7 +481,7 @@ int UsbBlasterII::write(uint8_t *wr_buf, int wr_len,
 
 	ret = fx2->write(4, wr_buf, wr_len);
 	if (ret != wr_len) {
-		printf("problem %d written %d\n", ret, wr_len);
+		printfInfo("problem %d written %d\n", ret, wr_len);
 		return ret;
 	}
 
@@ -484,7 +489,7 @@ int UsbBlasterII::write(uint8_t *wr_buf, int wr_len,
 		uint8_t c = 0x5f;
 		ret = fx2->write(4, &c, 1);
 		if (ret != 1) {
-			printf("problem %d written %d\n", ret, wr_len);
+			printfInfo("problem %d written %d\n", ret, wr_len);
 			return ret;
 		}
 
@@ -504,8 +509,8 @@ int UsbBlasterII::write(uint8_t *wr_buf, int wr_len,
 			printError("Error: timeout " + std::to_string(byte_read) +
 				" " + std::to_string(rd_len));
 			for (int i=0; i < byte_read; i++)
-				printf("%02x ", rd_buf[i]);
-			printf("\n");
+				printfInfo("%02x ", rd_buf[i]);
+			printfInfo("\n");
 			return 0;
 		}
 	}
@@ -0,0 +1,627 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#include "virtualJtag.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bitOps.hpp"
+#include "common.hpp"
+#include "display.hpp"
+#include "jtag.hpp"
+#include "part.hpp"
+
+#define VIRTUAL_DEFAULT_CHAIN "0x0362d093"
+
+/* SPI flash: Winbond W25Q128 (16MB) */
+#define VFLASH_SIZE     (16 * 1024 * 1024)
+#define VFLASH_JEDEC_ID {0xef, 0x40, 0x18, 0x00}
+#define VFLASH_RDSR_WIP 0x01
+#define VFLASH_RDSR_WEL 0x02
+
+/* Xilinx status as IR capture (7 series) */
+#define XIL_IR_INIT_COMPLETE (1 << 4)
+#define XIL_IR_DONE          (1 << 5)
+
+/* Lattice status register */
+#define LAT_STATUS_DONE   (1 << 8)
+#define LAT_STATUS_ISC_EN (1 << 9)
+
+/* Gowin status register */
+#define GOW_STATUS_MEMORY_ERASE (1 << 5)
+#define GOW_STATUS_EDIT_MODE    (1 << 7)
+#define GOW_STATUS_DONE_FINAL   (1 << 13)
+
+VirtualJtag::VirtualJtag(uint32_t clkHZ, int8_t verbose):
+	_verbose(verbose), _state(Jtag::TEST_LOGIC_RESET), _last_tdi(0),
+	_buffer_size(4096), _pending_bytes(0), _pending_clk(0),
+	_latency_us(0), _bandwidth(0), _wait_us(0), _nb_xfer(0), _nb_bytes(0),
+	_total_us(0)
+{
+	_clkHZ = clkHZ;
+
+	_latency_us = strtoul(get_shell_env_var(
+			"OPENFPGALOADER_VIRTUAL_LATENCY", "0").c_str(), NULL, 0);
+	_bandwidth = strtoul(get_shell_env_var(
+			"OPENFPGALOADER_VIRTUAL_BANDWIDTH", "0").c_str(), NULL, 0);
+	_flash_file = get_shell_env_var("OPENFPGALOADER_VIRTUAL_FLASH");
+
+	/* chain description: idcode[:irlen],... from TDI to TDO */
+	std::stringstream chain(get_shell_env_var("OPENFPGALOADER_VIRTUAL_CHAIN",
+			VIRTUAL_DEFAULT_CHAIN));
+	std::string entry;
+	while (std::getline(chain, entry, ',')) {
+		vdev_t dev = {};
+		size_t pos = entry.find(':');
+		dev.idcode = strtoul(entry.substr(0, pos).c_str(), NULL, 0);
+		dev.irlen = -1;
+		dev.instr = -1;
+		dev.dr_len = 32;
+
+		std::string manufacturer;
+		auto fpga = fpga_list.find(dev.idcode);
+		if (fpga != fpga_list.end()) {
+			dev.irlen = fpga->second.irlength;
+			manufacturer = fpga->second.manufacturer;
+		} else {
+			auto misc = misc_dev_list.find(dev.idcode);
+			if (misc != misc_dev_list.end())
+				dev.irlen = misc->second.irlength;
+		}
+		if (pos != std::string::npos)
+			dev.irlen = strtol(entry.substr(pos + 1).c_str(), NULL, 0);
+		if (dev.irlen < 2 || dev.irlen > 64)
+			throw std::runtime_error("virtual: unknown or invalid irlength for "
+				"device " + entry);
+		dev.ir_shift = 1;
+		load_preset(dev, manufacturer);
+		_devices.push_back(dev);
+	}
+	if (_devices.empty())
+		throw std::runtime_error("virtual: empty chain");
+
+	/* primary flash of the first device is backed by a file */
+	if (!_flash_file.empty()) {
+		vflash_t &flash = _devices[0].flash[0];
+		flash.mem.resize(VFLASH_SIZE, 0xff);
+		FILE *fd = fopen(_flash_file.c_str(), "rb");
+		if (fd) {
+			size_t len = fread(flash.mem.data(), 1, VFLASH_SIZE, fd);
+			fclose(fd);
+			if (_verbose > 0)
+				printInfo("virtual: " + std::to_string(len) +
+					" Bytes loaded from " + _flash_file);
+		}
+	}
+
+	if (_verbose > 0) {
+		char mess[128];
+		for (size_t i = 0; i < _devices.size(); i++) {
+			snprintf(mess, 128, "virtual: device %zu idcode 0x%08x irlength %d",
+				i, _devices[i].idcode, _devices[i].irlen);
+			printInfo(mess);
+		}
+	}
+}
+
+VirtualJtag::~VirtualJtag()
+{
+	flush();
+
+	if (!_flash_file.empty()) {
+		FILE *fd = fopen(_flash_file.c_str(), "wb");
+		if (!fd) {
+			printError("virtual: can't write " + _flash_file);
+		} else {
+			const std::vector<uint8_t> &mem = _devices[0].flash[0].mem;
+			fwrite(mem.data(), 1, mem.size(), fd);
+			fclose(fd);
+		}
+	}
+
+	if (_verbose > 0) {
+		char mess[256];
+		for (size_t i = 0; i < _devices.size(); i++) {
+			if (_devices[i].cfg_bits == 0)
+				continue;
+			snprintf(mess, 256, "virtual: device %zu received %llu "
+				"configuration bits", i,
+				(unsigned long long)_devices[i].cfg_bits);
+			printInfo(mess);
+		}
+		snprintf(mess, 256, "virtual: %u transfers %llu Bytes %.3f s",
+			_nb_xfer, (unsigned long long)_nb_bytes, _total_us / 1e6);
+		printInfo(mess);
+	}
+}
+
+void VirtualJtag::load_preset(vdev_t &dev, const std::string &manufacturer)
+{
+	if (manufacturer == "xilinx" && dev.irlen == 6) {
+		dev.status_in_ir = true;
+		dev.status = XIL_IR_INIT_COMPLETE;
+		dev.instr_list = {
+			/* code  type        len flash delay set status    clr status */
+			{0x09, DR_IDCODE, 32, 0, 0, 0,           0},           // IDCODE
+			{0x05, DR_SINK,    0, 0, 0, 0,           0},           // CFG_IN
+			{0x02, DR_SPI,     0, 0, 1, 0,           0},           // USER1
+			{0x03, DR_SPI,     0, 1, 1, 0,           0},           // USER2
+			{0x0B, DR_BYPASS,  0, 0, 0, 0,           XIL_IR_DONE}, // JPROGRAM
+			{0x0C, DR_BYPASS,  0, 0, 0, XIL_IR_DONE, 0},           // JSTART
+		};
+	} else if (manufacturer == "lattice" && dev.irlen == 8) {
+		dev.status = LAT_STATUS_DONE;
+		dev.instr_list = {
+			{0xE0, DR_IDCODE, 32, 0, 0, 0, 0},                   // IDCODE
+			{0xC0, DR_CONST,  32, 0, 0, 0, 0},                   // USERCODE
+			{0x3C, DR_STATUS, 32, 0, 0, 0, 0},                   // READ_STATUS
+			{0xF0, DR_CONST,   8, 0, 0, 0, 0},                   // CHECK_BUSY
+			{0x7A, DR_SINK,    0, 0, 0, 0, 0},                   // BITSTREAM_BURST
+			{0x3A, DR_SPI,     0, 0, 0, 0, 0},                   // PROG_SPI
+			{0xC6, DR_CONST,   8, 0, 0, LAT_STATUS_ISC_EN, 0},   // ISC_ENABLE
+			{0x74, DR_CONST,   8, 0, 0, LAT_STATUS_ISC_EN, 0},   // ISC_ENABLE_X
+			{0x0E, DR_CONST,   8, 0, 0, 0, LAT_STATUS_DONE},     // ISC_ERASE
+			{0x26, DR_BYPASS,  0, 0, 0, LAT_STATUS_DONE,
+				LAT_STATUS_ISC_EN},                              // ISC_DISABLE
+			{0x79, DR_BYPASS,  0, 0, 0, LAT_STATUS_DONE, 0},     // REFRESH
+			{0x5E, DR_BYPASS,  0, 0, 0, LAT_STATUS_DONE, 0},     // PROGRAM_DONE
+		};
+	} else if (manufacturer == "Gowin" && dev.irlen == 8) {
+		dev.status = GOW_STATUS_DONE_FINAL;
+		dev.instr_list = {
+			{0x11, DR_IDCODE, 32, 0, 0, 0, 0},                   // READ_IDCODE
+			{0x13, DR_CONST,  32, 0, 0, 0, 0},                   // READ_USERCODE
+			{0x41, DR_STATUS, 32, 0, 0, 0, 0},                   // STATUS_REGISTER
+			{0x15, DR_BYPASS,  0, 0, 0, GOW_STATUS_EDIT_MODE, 0}, // CONFIG_ENABLE
+			{0x3A, DR_BYPASS,  0, 0, 0, 0, GOW_STATUS_EDIT_MODE}, // CONFIG_DISABLE
+			{0x05, DR_BYPASS,  0, 0, 0, GOW_STATUS_MEMORY_ERASE,
+				GOW_STATUS_DONE_FINAL},                          // ERASE_SRAM
+			{0x17, DR_SINK,    0, 0, 0, 0, 0},                   // XFER_WRITE
+			{0x09, DR_BYPASS,  0, 0, 0, GOW_STATUS_DONE_FINAL, 0}, // XFER_DONE
+			{0x71, DR_SINK,    0, 0, 0, 0, 0},                   // EF_PROGRAM
+			{0x75, DR_SINK,    0, 0, 0, 0, 0},                   // EFLASH_ERASE
+			{0x3C, DR_BYPASS,  0, 0, 0, GOW_STATUS_DONE_FINAL, 0}, // RELOAD
+			{0x16, DR_SPI,     0, 0, 1, 0, 0},                   // GW2A SPI (MSB first)
+			{0x3D, DR_BSCAN_SPI, 8, 0, 0, 0, 0},                 // boundary scan SPI
+		};
+		/* SCK/CS/DI/DO boundary scan cells (GW1NSR-4C differs) */
+		if (dev.idcode == 0x0100981b) {
+			dev.bscan_sck = 1 << 7;
+			dev.bscan_cs = 1 << 5;
+			dev.bscan_di = 1 << 3;
+			dev.bscan_do = 1 << 1;
+		} else {
+			dev.bscan_sck = 1 << 1;
+			dev.bscan_cs = 1 << 3;
+			dev.bscan_di = 1 << 5;
+			dev.bscan_do = 1 << 7;
+		}
+		dev.bscan_pins = dev.bscan_cs;
+	}
+	/* others devices: IDCODE after TLR, all instructions are BYPASS */
+}
+
+const VirtualJtag::instr_t &VirtualJtag::cur_instr(const vdev_t &dev) const
+{
+	static const instr_t idcode = {0, DR_IDCODE, 32, 0, 0, 0, 0};
+	static const instr_t bypass = {0, DR_BYPASS, 1, 0, 0, 0, 0};
+	if (dev.instr == -1)
+		return idcode;
+	if (dev.instr == -2)
+		return bypass;
+	return dev.instr_list[dev.instr];
+}
+
+/* TAP */
+
+uint8_t VirtualJtag::clock(uint8_t tms, uint8_t tdi)
+{
+	uint8_t tdo = 0;
+
+	if (_state == Jtag::SHIFT_IR) {
+		uint8_t in = tdi;
+		for (vdev_t &dev : _devices) {
+			uint8_t out = dev.ir_shift & 0x01;
+			dev.ir_shift = (dev.ir_shift >> 1) |
+				((uint64_t)in << (dev.irlen - 1));
+			in = out;
+		}
+		tdo = in;
+	} else if (_state == Jtag::SHIFT_DR) {
+		uint8_t in = tdi;
+		for (vdev_t &dev : _devices) {
+			uint8_t out = dr_peek(dev);
+			dr_shift(dev, in);
+			in = out;
+		}
+		tdo = in;
+	}
+
+	int next = Jtag::walk_tms((Jtag::tapState_t)_state, &tms, 1);
+	if (next != _state)
+		enter_state(next);
+	_state = next;
+
+	return tdo;
+}
+
+void VirtualJtag::enter_state(int state)
+{
+	for (vdev_t &dev : _devices) {
+		const instr_t &instr = cur_instr(dev);
+		switch (state) {
+		case Jtag::TEST_LOGIC_RESET:
+			if ((instr.type == DR_SPI || instr.type == DR_BSCAN_SPI) &&
+					dev.flash[instr.flash].selected)
+				flash_deselect(dev.flash[instr.flash]);
+			dev.bscan_pins = dev.bscan_cs;
+			dev.instr = -1;
+			break;
+		case Jtag::CAPTURE_IR:
+			dev.ir_shift = (dev.status_in_ir) ? (dev.status | 0x01) : 0x01;
+			break;
+		case Jtag::UPDATE_IR: {
+			uint64_t mask = (dev.irlen == 64) ? ~0ULL :
+				((1ULL << dev.irlen) - 1);
+			uint64_t code = dev.ir_shift & mask;
+			dev.instr = -2;
+			for (size_t i = 0; i < dev.instr_list.size(); i++) {
+				if (dev.instr_list[i].code == code) {
+					dev.instr = i;
+					dev.status |= dev.instr_list[i].set_status;
+					dev.status &= ~dev.instr_list[i].clr_status;
+					break;
+				}
+			}
+			break;
+		}
+		case Jtag::CAPTURE_DR:
+			switch (instr.type) {
+			case DR_IDCODE:
+				dev.dr_shift = dev.idcode;
+				dev.dr_len = 32;
+				break;
+			case DR_STATUS:
+				dev.dr_shift = dev.status;
+				dev.dr_len = instr.len;
+				break;
+			case DR_CONST:
+				dev.dr_shift = 0;
+				dev.dr_len = instr.len;
+				break;
+			case DR_BSCAN_SPI:
+				/* DO pin: MISO before next SCK rising edge */
+				dev.dr_shift = (flash_out(dev.flash[instr.flash])) ?
+					dev.bscan_do : 0;
+				dev.dr_len = instr.len;
+				break;
+			default:
+				dev.dr_shift = 0;
+				dev.dr_len = 1;
+				break;
+			}
+			break;
+		case Jtag::SHIFT_DR:
+			if (instr.type == DR_SPI)
+				flash_select(dev.flash[instr.flash]);
+			break;
+		case Jtag::EXIT1_DR:
+			if (instr.type == DR_SPI)
+				flash_deselect(dev.flash[instr.flash]);
+			break;
+		case Jtag::UPDATE_DR:
+			if (instr.type == DR_BSCAN_SPI)
+				bscan_update(dev);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+uint8_t VirtualJtag::dr_peek(vdev_t &dev)
+{
+	const instr_t &instr = cur_instr(dev);
+	if (instr.type == DR_SPI) {
+		const vflash_t &flash = dev.flash[instr.flash];
+		return (instr.miso_delay) ? flash.miso : flash_out(flash);
+	}
+	return dev.dr_shift & 0x01;
+}
+
+void VirtualJtag::dr_shift(vdev_t &dev, uint8_t tdi)
+{
+	const instr_t &instr = cur_instr(dev);
+	if (instr.type == DR_SPI) {
+		flash_clock(dev.flash[instr.flash], tdi);
+		return;
+	}
+	if (instr.type == DR_SINK)
+		dev.cfg_bits++;
+	dev.dr_shift = (dev.dr_shift >> 1) | ((uint64_t)tdi << (dev.dr_len - 1));
+}
+
+void VirtualJtag::bscan_update(vdev_t &dev)
+{
+	vflash_t &flash = dev.flash[cur_instr(dev).flash];
+	uint8_t pins = dev.dr_shift & 0xff;
+
+	if (pins & dev.bscan_cs) {
+		if (flash.selected)
+			flash_deselect(flash);
+	} else {
+		if (!flash.selected)
+			flash_select(flash);
+		/* SCK rising edge */
+		if ((pins & dev.bscan_sck) && !(dev.bscan_pins & dev.bscan_sck))
+			flash_clock(flash, (pins & dev.bscan_di) ? 1 : 0);
+	}
+	dev.bscan_pins = pins;
+}
+
+/* SPI flash */
+
+void VirtualJtag::flash_select(vflash_t &flash)
+{
+	if (flash.mem.empty())
+		flash.mem.resize(VFLASH_SIZE, 0xff);
+	flash.selected = true;
+	flash.rx_cnt = 0;
+	flash.rx_bits = 0;
+	flash.addr = 0;
+	flash.tx_byte = 0xff;
+}
+
+void VirtualJtag::flash_deselect(vflash_t &flash)
+{
+	flash.selected = false;
+	if (flash.rx_cnt == 0 || !(flash.status & VFLASH_RDSR_WEL))
+		return;
+
+	uint32_t block = 0;
+	uint8_t addr_len = 3;
+	switch (flash.cmd) {
+	case 0x21: addr_len = 4;  // fallthrough
+	case 0x20: block = 4 * 1024; break;
+	case 0x5C: addr_len = 4;  // fallthrough
+	case 0x52: block = 32 * 1024; break;
+	case 0xDC: addr_len = 4;  // fallthrough
+	case 0xD8: block = 64 * 1024; break;
+	case 0x60:
+	case 0xC7:
+		addr_len = 0;
+		block = VFLASH_SIZE;
+		break;
+	case 0x01:  // WRSR
+	case 0x02:  // PP
+	case 0x12:  // 4PP
+		break;
+	default:
+		return;
+	}
+
+	if (block != 0 && flash.rx_cnt == 1U + addr_len) {
+		uint32_t base = (flash.addr % VFLASH_SIZE) & ~(block - 1);
+		memset(flash.mem.data() + base, 0xff, block);
+	}
+	flash.status &= ~VFLASH_RDSR_WEL;
+}
+
+uint8_t VirtualJtag::flash_out(const vflash_t &flash)
+{
+	return (flash.tx_byte >> (7 - flash.rx_bits)) & 0x01;
+}
+
+void VirtualJtag::flash_clock(vflash_t &flash, uint8_t mosi)
+{
+	if (!flash.selected)
+		return;
+	flash.miso = flash_out(flash);
+	flash.rx_byte = (flash.rx_byte << 1) | mosi;
+	if (++flash.rx_bits == 8) {
+		flash.rx_bits = 0;
+		flash_byte(flash, flash.rx_byte);
+	}
+}
+
+void VirtualJtag::flash_byte(vflash_t &flash, uint8_t b)
+{
+	static const uint8_t jedec_id[] = VFLASH_JEDEC_ID;
+	uint32_t n = flash.rx_cnt++;
+
+	if (n == 0) {
+		flash.cmd = b;
+		if (b == 0x06)
+			flash.status |= VFLASH_RDSR_WEL;
+		else if (b == 0x04)
+			flash.status &= ~VFLASH_RDSR_WEL;
+	}
+
+	uint8_t addr_len;
+	switch (flash.cmd) {
+	case 0x12: case 0x13: case 0x21: case 0x5C: case 0xDC:
+		addr_len = 4;
+		break;
+	default:
+		addr_len = 3;
+		break;
+	}
+
+	/* byte received */
+	if (n > 0 && n <= addr_len) {
+		flash.addr = (flash.addr << 8) | b;
+	} else if (n > addr_len) {
+		uint32_t offset = n - addr_len - 1;
+		switch (flash.cmd) {
+		case 0x02:
+		case 0x12:
+			/* page program: NOR (only 1 -> 0), wrap in page */
+			if (flash.status & VFLASH_RDSR_WEL) {
+				uint32_t addr = (flash.addr & ~0xffU) |
+					((flash.addr + offset) & 0xff);
+				flash.mem[addr % VFLASH_SIZE] &= b;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	/* WRSR: WIP and WEL are read only */
+	if (flash.cmd == 0x01 && n == 1 && (flash.status & VFLASH_RDSR_WEL))
+		flash.status = (flash.status & 0x03) | (b & 0xfc);
+
+	/* next byte to send */
+	uint32_t k = flash.rx_cnt;
+	flash.tx_byte = 0xff;
+	switch (flash.cmd) {
+	case 0x9F:  // RDID
+		if (k - 1 < sizeof(jedec_id))
+			flash.tx_byte = jedec_id[k - 1];
+		break;
+	case 0x05:  // RDSR
+		flash.tx_byte = flash.status;
+		break;
+	case 0x35:  // RDCR
+		flash.tx_byte = flash.status2;
+		break;
+	case 0x03:  // READ
+	case 0x13:  // 4READ
+		if (k > addr_len)
+			flash.tx_byte = flash.mem[(flash.addr + k - addr_len - 1) %
+				VFLASH_SIZE];
+		break;
+	case 0x0B:  // FAST_READ (one dummy byte)
+		if (k > addr_len + 1U)
+			flash.tx_byte = flash.mem[(flash.addr + k - addr_len - 2) %
+				VFLASH_SIZE];
+		break;
+	default:
+		break;
+	}
+}
+
+/* direct SPI access */
+
+void VirtualJtag::spi_select(bool select)
+{
+	vflash_t &flash = _devices[0].flash[0];
+	if (select && !flash.selected)
+		flash_select(flash);
+	else if (!select && flash.selected)
+		flash_deselect(flash);
+}
+
+uint8_t VirtualJtag::spi_clock(uint8_t mosi)
+{
+	vflash_t &flash = _devices[0].flash[0];
+	if (!flash.selected)
+		return 1;
+	uint8_t miso = flash_out(flash);
+	flash_clock(flash, mosi);
+	return miso;
+}
+
+/* timing model */
+
+void VirtualJtag::account(uint32_t bytes, uint64_t clk)
+{
+	_pending_bytes += bytes;
+	_pending_clk += clk;
+	if (_pending_bytes >= _buffer_size)
+		flush();
+}
+
+int VirtualJtag::flush()
+{
+	if (_pending_bytes == 0 && _pending_clk == 0)
+		return 0;
+
+	double us = _latency_us;
+	if (_bandwidth != 0)
+		us += _pending_bytes * 1e6 / _bandwidth;
+	if (_clkHZ != 0)
+		us += _pending_clk * 1e6 / _clkHZ;
+
+	_nb_xfer++;
+	_nb_bytes += _pending_bytes;
+	_total_us += us;
+	_pending_bytes = 0;
+	_pending_clk = 0;
+
+	/* sub-microsecond costs are accumulated */
+	_wait_us += us;
+	if (_wait_us >= 1) {
+		usleep((useconds_t)_wait_us);
+		_wait_us -= (useconds_t)_wait_us;
+	}
+	return 1;
+}
+
+/* JtagInterface */
+
+int VirtualJtag::setClkFreq(uint32_t clkHZ)
+{
+	_clkHZ = clkHZ;
+	return clkHZ;
+}
+
+int VirtualJtag::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
+{
+	for (uint32_t i = 0; i < len; i++)
+		clock(bit_get(tms, i), _last_tdi);
+	/* MPSSE like: 6 TMS bits per 3 Bytes command */
+	account(((len + 5) / 6) * 3, len);
+	if (flush_buffer)
+		flush();
+	return len;
+}
+
+int VirtualJtag::writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end)
+{
+	if (len == 0)
+		return 0;
+	if (rx)
+		memset(rx, 0, (len + 7) / 8);
+
+	for (uint32_t i = 0; i < len; i++) {
+		uint8_t tdi = (tx) ? bit_get(tx, i) : 0;
+		uint8_t tms = (end && i == len - 1) ? 1 : 0;
+		uint8_t tdo = clock(tms, tdi);
+		if (rx && tdo)
+			bit_set(rx, i, true);
+		_last_tdi = tdi;
+	}
+
+	account(3 + (len + 7) / 8, len);
+	/* read: round trip */
+	if (rx)
+		flush();
+	return len;
+}
+
+int VirtualJtag::toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len)
+{
+	uint32_t i = 0;
+	/* stable state: only clock count matters */
+	for (; i < clk_len; i++) {
+		if (_state != Jtag::SHIFT_DR && _state != Jtag::SHIFT_IR &&
+				Jtag::walk_tms((Jtag::tapState_t)_state, &tms, 1) == _state)
+			break;
+		clock(tms, tdi);
+	}
+	_last_tdi = tdi;
+
+	account(3 * ((clk_len + 0x7ffff) / 0x80000), clk_len);
+	return clk_len;
+}
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+ * Copyright (C) 2023 Gwenhael Goavec-Merou <gwenhael.goavec-merou@trabucayre.com>
+ */
+
+#ifndef SRC_VIRTUALJTAG_HPP_
+#define SRC_VIRTUALJTAG_HPP_
+
+#include <string>
+#include <vector>
+
+#include "jtagInterface.hpp"
+
+/*!
+ * \file virtualJtag.hpp
+ * \class VirtualJtag
+ * \brief virtual cable: IEEE 1149.1 TAP state machine simulator with
+ *        a chain of device models (IDCODE, BYPASS, configuration sink,
+ *        SPI over JTAG bridge backed by an in-memory flash; Xilinx,
+ *        Lattice and Gowin presets) and a transfer latency/bandwidth
+ *        model. Configured with
+ *        environment variables:
+ *        - OPENFPGALOADER_VIRTUAL_CHAIN: devices from TDI to TDO
+ *          "idcode[:irlen],..." (default: 0x0362d093, xc7a35t)
+ *        - OPENFPGALOADER_VIRTUAL_FLASH: flash image file (loaded at
+ *          startup, written back at exit) for the first device
+ *        - OPENFPGALOADER_VIRTUAL_LATENCY: latency per transfer (us)
+ *        - OPENFPGALOADER_VIRTUAL_BANDWIDTH: link bandwidth (Bytes/s,
+ *          0: unlimited)
+ */
+class VirtualJtag : public JtagInterface {
+ public:
+	/*!
+	 * \brief constructor: build chain from environment
+	 * \param[in] clkHZ: TCK frequency (used by timing model)
+	 * \param[in] verbose: verbose level -1 quiet, 0 normal,
+	 *                     1 verbose, 2 debug
+	 */
+	VirtualJtag(uint32_t clkHZ, int8_t verbose);
+	~VirtualJtag();
+
+	/*!
+	 * \brief configure TCK frequency: all frequencies are accepted
+	 * \param[in] clkHZ: frequency in Hertz
+	 * \return clkHZ
+	 */
+	int setClkFreq(uint32_t clkHZ) override;
+
+	/*!
+	 * \brief apply len tms bits (TDI unchanged)
+	 * \param[in] tms: serie of tms state
+	 * \param[in] len: number of tms bits
+	 * \param[in] flush_buffer: force transfer to be completed
+	 * \return len
+	 */
+	int writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer) override;
+
+	/*!
+	 * \brief write and read len bits with optional tms set to 1 if end
+	 * \param[in] tx: serie of tdi state to send (may be NULL)
+	 * \param[out] rx: buffer to store tdo bits from chain (may be NULL)
+	 * \param[in] len: number of bit to read/write
+	 * \param[in] end: if true tms is set to one with the last tdi bit
+	 * \return len
+	 */
+	int writeTDI(uint8_t *tx, uint8_t *rx, uint32_t len, bool end) override;
+
+	/*!
+	 * \brief send a serie of clock cycle with constant TMS and TDI
+	 * \param[in] tms: tms state
+	 * \param[in] tdi: tdi state
+	 * \param[in] clk_len: number of clock cycle
+	 * \return clk_len
+	 */
+	int toggleClk(uint8_t tms, uint8_t tdi, uint32_t clk_len) override;
+
+	/*!
+	 * \brief complete pending transfer: wait for modeled latency,
+	 *        payload and TCK time
+	 * \return 1 if something was pending, 0 otherwise
+	 */
+	int flush() override;
+
+	int get_buffer_size() override { return _buffer_size;}
+	bool isFull() override { return _pending_bytes >= _buffer_size;}
+
+	/* direct access without timing model (used by MPSSE emulator) */
+	/*!
+	 * \brief one TCK cycle
+	 * \param[in] tms: TMS state
+	 * \param[in] tdi: TDI state
+	 * \return TDO state (sampled before the rising edge)
+	 */
+	uint8_t tck(uint8_t tms, uint8_t tdi) { return clock(tms, tdi); }
+	/*!
+	 * \brief select/deselect first device primary flash (SPI mode)
+	 */
+	void spi_select(bool select);
+	/*!
+	 * \brief one SCK cycle on first device primary flash
+	 * \param[in] mosi: MOSI state
+	 * \return MISO state (before the clock edge)
+	 */
+	uint8_t spi_clock(uint8_t mosi);
+
+ private:
+	/*!
+	 * \brief data register selected by an instruction
+	 */
+	typedef enum {
+		DR_BYPASS = 0, /*!< 1 bit, captures 0 */
+		DR_IDCODE,     /*!< 32 bits, captures device IDCODE */
+		DR_STATUS,     /*!< len bits, captures device status */
+		DR_CONST,      /*!< len bits, captures 0 */
+		DR_SINK,       /*!< any length, configuration data (CFG_IN) */
+		DR_SPI,        /*!< SPI over JTAG bridge (CS low in SHIFT_DR) */
+		DR_BSCAN_SPI   /*!< 8 bits boundary scan cells driving flash
+		                *   pins, applied on UPDATE_DR (Gowin) */
+	} dr_type_t;
+
+	typedef struct {
+		uint64_t code;       /*!< instruction */
+		dr_type_t type;      /*!< selected data register */
+		uint8_t len;         /*!< DR_STATUS/DR_CONST length */
+		uint8_t flash;       /*!< DR_SPI: flash index (0: primary) */
+		uint8_t miso_delay;  /*!< DR_SPI: TDO delay (TCK cycles: 0 or 1) */
+		uint32_t set_status; /*!< status bits set on UPDATE_IR */
+		uint32_t clr_status; /*!< status bits cleared on UPDATE_IR */
+	} instr_t;
+
+	typedef struct {
+		std::vector<uint8_t> mem; /*!< content (empty until first access) */
+		uint8_t status;   /*!< status register 1 (WEL) */
+		uint8_t status2;  /*!< status register 2 */
+		bool selected;    /*!< CS state */
+		uint32_t rx_cnt;  /*!< bytes received since CS low */
+		uint8_t cmd;      /*!< current command */
+		uint32_t addr;    /*!< command address */
+		uint8_t rx_byte;  /*!< byte being received */
+		uint8_t rx_bits;  /*!< bits received in rx_byte */
+		uint8_t tx_byte;  /*!< byte being sent */
+		uint8_t miso;     /*!< last MISO bit (delayed bridge) */
+	} vflash_t;
+
+	typedef struct {
+		uint32_t idcode;             /*!< device IDCODE */
+		int irlen;                   /*!< instruction register length */
+		uint64_t ir_shift;           /*!< IR shift register */
+		int instr;                   /*!< index in instr_list, -1: IDCODE */
+		uint64_t dr_shift;           /*!< DR shift register */
+		uint8_t dr_len;              /*!< DR shift register length */
+		uint32_t status;             /*!< device status register */
+		bool status_in_ir;           /*!< status is IR capture value */
+		std::vector<instr_t> instr_list; /*!< known instructions */
+		vflash_t flash[2];           /*!< SPI flash behind the bridge */
+		uint64_t cfg_bits;           /*!< bits received by DR_SINK */
+		uint8_t bscan_sck, bscan_cs; /*!< DR_BSCAN_SPI pins masks */
+		uint8_t bscan_di, bscan_do;
+		uint8_t bscan_pins;          /*!< DR_BSCAN_SPI last pins state */
+	} vdev_t;
+
+	/*!
+	 * \brief fill device instructions list with vendor presets
+	 * \param[in] dev: device to configure
+	 * \param[in] manufacturer: manufacturer name (from fpga_list)
+	 */
+	void load_preset(vdev_t &dev, const std::string &manufacturer);
+	/*!
+	 * \brief currently selected instruction for a device
+	 */
+	const instr_t &cur_instr(const vdev_t &dev) const;
+	/*!
+	 * \brief one TCK cycle
+	 * \param[in] tms: TMS state
+	 * \param[in] tdi: TDI state
+	 * \return TDO state (sampled before the rising edge)
+	 */
+	uint8_t clock(uint8_t tms, uint8_t tdi);
+	/*!
+	 * \brief actions when the TAP enters a new state
+	 */
+	void enter_state(int state);
+	/* data register shift */
+	uint8_t dr_peek(vdev_t &dev);
+	void dr_shift(vdev_t &dev, uint8_t tdi);
+	/*!
+	 * \brief apply DR_BSCAN_SPI register to first flash pins
+	 */
+	void bscan_update(vdev_t &dev);
+
+	/* SPI flash model (Winbond W25Q128 like) */
+	void flash_select(vflash_t &flash);
+	void flash_deselect(vflash_t &flash);
+	uint8_t flash_out(const vflash_t &flash);
+	void flash_clock(vflash_t &flash, uint8_t mosi);
+	void flash_byte(vflash_t &flash, uint8_t b);
+
+	/*!
+	 * \brief add a command to pending transfer
+	 * \param[in] bytes: command size on the link
+	 * \param[in] clk: number of TCK cycles
+	 */
+	void account(uint32_t bytes, uint64_t clk);
+
+	int8_t _verbose;
+	int _state;                  /*!< TAP state (Jtag::tapState_t) */
+	uint8_t _last_tdi;           /*!< TDI state kept by writeTMS */
+	std::vector<vdev_t> _devices; /*!< chain, index 0 nearest TDI */
+	std::string _flash_file;     /*!< flash image (may be empty) */
+
+	/* timing model */
+	uint32_t _buffer_size;       /*!< converter buffer size (Bytes) */
+	uint32_t _pending_bytes;     /*!< Bytes not yet transferred */
+	uint64_t _pending_clk;       /*!< TCK cycles not yet done */
+	uint32_t _latency_us;        /*!< latency per transfer */
+	uint32_t _bandwidth;         /*!< link bandwidth (0: unlimited) */
+	double _wait_us;             /*!< modeled time not yet waited */
+	uint32_t _nb_xfer;           /*!< number of transfers */
+	uint64_t _nb_bytes;          /*!< number of Bytes transferred */
+	double _total_us;            /*!< total modeled time */
+};
+#endif  // SRC_VIRTUALJTAG_HPP_
@@ -14,6 +14,7 @@
 #include "jtag.hpp"
 #include "bitparser.hpp"
 #include "common.hpp"
+#include "bitOps.hpp"
 #include "configBitstreamParser.hpp"
 #include "jedParser.hpp"
 #include "mcsParser.hpp"
@@ -26,6 +27,7 @@
 #include "xilinxMapParser.hpp"
 #include "part.hpp"
 #include "progressBar.hpp"
+#include "traceEvent.hpp"
 #if defined (_WIN64) || defined (_WIN32)
 #include "pathHelper.hpp"
 #endif
@@ -105,6 +107,7 @@ static void open_bitfile(
 	const std::string &filename, const std::string &extension,
 	ConfigBitstreamParser **parser, bool reverse, bool verbose)
 {
+	TraceSpan span("parse", "phase");
 	printInfo("Open file ", false);
 	if (extension == "bit") {
 		*parser = new BitParser(filename, reverse, verbose);
@@ -370,6 +373,12 @@ void Xilinx::program(unsigned int offset, bool unprotect_flash)
 	if (_mode == Device::NONE_MODE || _mode == Device::READ_MODE)
 		return;
 
+	if (_broadcast_list.size() > 1 && (_mode != Device::MEM_MODE ||
+			_fpga_family == XC95_FAMILY || _fpga_family == XC2C_FAMILY ||
+			_fpga_family == XCF_FAMILY || _fpga_family == SPARTAN3_FAMILY))
+		throw std::runtime_error("Error: multiple devices configuration "
+			"only supported for SRAM write");
+
 	if (_mode == Device::FLASH_MODE && _file_extension == "jed") {
 		JedParser *jed;
 		printInfo("Open file ", false);
@@ -437,9 +446,7 @@ void Xilinx::program(unsigned int offset, bool unprotect_flash)
 			select_flash_chip(SECONDARY_FLASH);
 			program_spi(secondary_bit, offset, unprotect_flash);
 		}
-
-		reset();
-
+		/* reset (or not, with skip_reset) done by post_flash_access */
 	} else {
 		if (_fpga_family == SPARTAN3_FAMILY)
 			xc3s_flow_program(bit);
@@ -488,7 +495,7 @@ bool Xilinx::load_bridge()
 	bitname = PathHelper::absolutePath(bitname);
 #endif
 
-	std::cout << "use: " << bitname << std::endl;
+	printInfo("use: " + bitname);
 
 	/* first: load spi over jtag */
 	try {
@@ -508,6 +515,7 @@ bool Xilinx::load_bridge()
 void Xilinx::program_spi(ConfigBitstreamParser * bit, unsigned int offset,
 		bool unprotect_flash)
 {
+	TraceSpan span("Xilinx::program_spi", "device");
 	uint8_t *data = bit->getData();
 	int length = bit->getLength() / 8;
 	SPIInterface::write(offset, data, length, unprotect_flash);
@@ -515,7 +523,7 @@ void Xilinx::program_spi(ConfigBitstreamParser * bit, unsigned int offset,
 
 void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 {
-	std::cout << "load program" << std::endl;
+	printInfo("load program");
 	unsigned char *tx_buf;
 	unsigned char rx_buf[(_irlen >> 3) + 1];
 
@@ -538,12 +546,23 @@ void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 	 *    TCK five times. This ensures starting in        X     1   5
 	 *    the TLR (Test-Logic-Reset) state.
 	 */
-	_jtag->shiftIR(get_ircode(_ircode_map, "JPROGRAM"), NULL, _irlen);
+	shift_ircode("JPROGRAM");
 	/* test */
 	tx_buf = get_ircode(_ircode_map, "BYPASS");
-	do {
-		_jtag->shiftIR(tx_buf, rx_buf, _irlen);
-	} while (!(rx_buf[0] &0x01));
+	if (_broadcast_list.size() > 1) {
+		/* wait for end of clear for each device */
+		for (int dev : _broadcast_list) {
+			_jtag->device_select(dev);
+			do {
+				_jtag->shiftIR(tx_buf, rx_buf, _irlen);
+			} while (!(rx_buf[0] &0x01));
+		}
+		_jtag->device_select(_broadcast_list[0]);
+	} else {
+		do {
+			_jtag->shiftIR(tx_buf, rx_buf, _irlen);
+		} while (!(rx_buf[0] &0x01));
+	}
 	/*
 	 * 8: Move into the RTI state.                        X     0   10,000(1)
 	 */
@@ -556,7 +575,7 @@ void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 	 *     exiting SHIFT-IR, as defined in the            0     1   1
 	 *     IEEE standard.
 	 */
-	_jtag->shiftIR(get_ircode(_ircode_map, "CFG_IN"), NULL, _irlen);
+	shift_ircode("CFG_IN");
 	/*
 	 * 11: Enter the SELECT-DR state.                     X     1   2
 	 */
@@ -590,7 +609,14 @@ void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 	         */
 			tx_end = Jtag::SHIFT_DR;
 		}
-		_jtag->shiftDR(data+i, NULL, tx_len, tx_end);
+		/* all devices in CFG_IN receive the same stream: trailing
+		 * bits push the bitstream to the farthest one
+		 */
+		if (_broadcast_list.size() > 1)
+			_jtag->shiftDR_broadcast(_broadcast_list, 32, data+i, tx_len,
+				tx_end);
+		else
+			_jtag->shiftDR(data+i, NULL, tx_len, tx_end);
 		_jtag->flush();
 		progress.display(i);
 	}
@@ -608,7 +634,7 @@ void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 	 * 20: Load the last bit of the JSTART instruction.   0     1   1
 	 * 21: Move to the UPDATE-IR state.                   X     1   1
 	 */
-	_jtag->shiftIR(get_ircode(_ircode_map, "JSTART"), NULL, _irlen, Jtag::UPDATE_IR);
+	shift_ircode("JSTART", Jtag::UPDATE_IR);
 	/*
 	 * 22: Move to the RTI state and clock the
 	 *     startup sequence by applying a minimum         X     0   2000
@@ -623,6 +649,16 @@ void Xilinx::program_mem(ConfigBitstreamParser *bitfile)
 	_jtag->go_test_logic_reset();
 }
 
+void Xilinx::shift_ircode(const std::string &name, int end_state)
+{
+	if (_broadcast_list.size() > 1)
+		_jtag->shiftIR_broadcast(_broadcast_list,
+			get_ircode(_ircode_map, name), _irlen, end_state);
+	else
+		_jtag->shiftIR(get_ircode(_ircode_map, name), NULL, _irlen,
+			end_state);
+}
+
 bool Xilinx::dumpFlash(uint32_t base_addr, uint32_t len)
 {
 	if (_fpga_family == XC95_FAMILY || _fpga_family == XCF_FAMILY) {
@@ -1527,22 +1563,18 @@ int Xilinx::spi_put(uint8_t cmd,
 	jtx[0] = McsParser::reverseByte(cmd);
 	/* uint8_t jtx[xfer_len] = {McsParser::reverseByte(cmd)}; */
 	uint8_t jrx[xfer_len];
-	if (tx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i+1] = McsParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx + 1, tx, len);
 	/* addr BSCAN user1 */
-	_jtag->shiftIR(get_ircode(_ircode_map, _user_instruction), NULL, _irlen);
+	_jtag->shiftIR_cached(get_ircode(_ircode_map, _user_instruction), _irlen);
 	/* send first already stored cmd,
 	 * in the same time store each byte
 	 * to next
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = McsParser::reverseByte(jrx[i+1] >> 1) | (jrx[i+2] & 0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx + 1, len);
 	return 0;
 }
 
@@ -1551,22 +1583,18 @@ int Xilinx::spi_put(uint8_t *tx, uint8_t *rx, uint32_t len)
 	int xfer_len = len + ((rx == NULL) ? 0 : 1);
 	uint8_t jtx[xfer_len];
 	uint8_t jrx[xfer_len];
-	if (tx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			jtx[i] = McsParser::reverseByte(tx[i]);
-	}
+	if (tx != NULL)
+		bit_reverse_bytes(jtx, tx, len);
 	/* addr BSCAN user1 */
-	_jtag->shiftIR(get_ircode(_ircode_map, _user_instruction), NULL, _irlen);
+	_jtag->shiftIR_cached(get_ircode(_ircode_map, _user_instruction), _irlen);
 	/* send first already stored cmd,
 	 * in the same time store each byte
 	 * to next
 	 */
 	_jtag->shiftDR(jtx, (rx == NULL)? NULL: jrx, 8*xfer_len);
 
-	if (rx != NULL) {
-		for (uint32_t i=0; i < len; i++)
-			rx[i] = McsParser::reverseByte(jrx[i] >> 1) | (jrx[i+1] & 0x01);
-	}
+	if (rx != NULL)
+		bit_reverse_shift1(rx, jrx, len);
 	return 0;
 }
 
@@ -1578,8 +1606,9 @@ int Xilinx::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 	uint8_t tmp;
 	uint8_t tx = McsParser::reverseByte(cmd);
 	uint32_t count = 0;
+	char mess[64];
 
-	_jtag->shiftIR(get_ircode(_ircode_map, _user_instruction), NULL, _irlen, Jtag::UPDATE_IR);
+	_jtag->shiftIR_cached(get_ircode(_ircode_map, _user_instruction), _irlen, Jtag::UPDATE_IR);
 	_jtag->shiftDR(&tx, NULL, 8, Jtag::SHIFT_DR);
 
 	do {
@@ -1587,19 +1616,22 @@ int Xilinx::spi_wait(uint8_t cmd, uint8_t mask, uint8_t cond,
 		tmp = (McsParser::reverseByte(rx[0]>>1)) | (0x01 & rx[1]);
 		count++;
 		if (count == timeout){
-			printf("timeout: %x %x %x\n", tmp, rx[0], rx[1]);
+			snprintf(mess, sizeof(mess), "timeout: %x %x %x", tmp, rx[0],
+				rx[1]);
+			printError(mess);
 			break;
 		}
 		if (verbose) {
-			printf("%x %x %x %u\n", tmp, mask, cond, count);
+			snprintf(mess, sizeof(mess), "%x %x %x %u", tmp, mask, cond,
+				count);
+			printInfo(mess);
 		}
 	} while ((tmp & mask) != cond);
 	_jtag->shiftDR(dummy, rx, 8*2, Jtag::EXIT1_DR);
 	_jtag->go_test_logic_reset();
 
 	if (count == timeout) {
-		printf("%x\n", tmp);
-		std::cout << "wait: Error" << std::endl;
+		printError("wait: Error");
 		return -ETIME;
 	} else {
 		return 0;
@@ -31,6 +31,14 @@ class Xilinx: public Device, SPIInterface {
 		void program_spi(ConfigBitstreamParser * bit, unsigned int offset,
 				bool unprotect_flash);
 		void program_mem(ConfigBitstreamParser *bitfile);
+		/*!
+		 * \brief configure (SRAM) all devices in the list at the same
+		 *        time with the same bitstream. Devices must be identical
+		 * \param[in] devices: list of devices index in the chain
+		 */
+		void set_broadcast_list(const std::vector<int> &devices) {
+			_broadcast_list = devices;
+		}
 		bool dumpFlash(uint32_t base_addr, uint32_t len) override;
 
 		/*!
@@ -199,6 +207,15 @@ class Xilinx: public Device, SPIInterface {
 		 */
 		void select_flash_chip(xilinx_flash_chip_t flash_chip);
 
+		/*!
+		 * \brief load an instruction in the selected device or in
+		 *        all devices of the broadcast list
+		 * \param[in] name: instruction name
+		 * \param[in] end_state: state after scan
+		 */
+		void shift_ircode(const std::string &name,
+				int end_state = Jtag::RUN_TEST_IDLE);
+
 		std::string _device_package;
 		std::string _spiOverJtagPath; /**< spiOverJtag explicit path */
 		int _xc95_line_len; /**< xc95 only: number of col by flash line */
@@ -212,6 +229,7 @@ class Xilinx: public Device, SPIInterface {
 		std::string _secondary_file_extension; /* file type for the secondary flash file */
 		int _flash_chips; /* bitfield to select the target in boards with two flash chips */
 		std::string _user_instruction; /* which USER bscan instruction to interface with SPI */
+		std::vector<int> _broadcast_list; /* devices configured together (program_mem) */
 };
 
 #endif
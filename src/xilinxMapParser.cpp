@@ -11,6 +11,7 @@
 #include <sstream>
 #include <vector>
 
+#include "display.hpp"
 #include "jedParser.hpp"
 #include "xilinxMapParser.hpp"
 
@@ -77,7 +78,7 @@ int XilinxMapParser::parse()
 						int idx = stoi(cnt.substr(5));
 						map_val = ((_usercode >> idx) & 0x01) ? BIT_ONE : BIT_ZERO;
 					} else {
-						printf("unknown %s %s\n", cnt.c_str(), line.c_str());
+						printfInfo("unknown %s %s\n", cnt.c_str(), line.c_str());
 						return false;
 					}
 				}
@@ -16,6 +16,7 @@
 #include <unistd.h>
 #include <math.h>
 
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -23,7 +24,9 @@
 #include <utility>
 #include <vector>
 
+#include "bitOps.hpp"
 #include "display.hpp"
+#include "transportStats.hpp"
 
 using namespace std;
 
@@ -94,7 +97,7 @@ int XVC_client::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 	if (len == 0)
 		return ((flush_buffer) ? flush() : 0);
 
-	for (uint32_t pos = 0; pos < len; pos++) {
+	for (uint32_t pos = 0; pos < len;) {
 		// buffer full -> write
 		if (_num_bits == _buffer_size * 8) {
 			// write
@@ -102,17 +105,13 @@ int XVC_client::writeTMS(uint8_t *tms, uint32_t len, bool flush_buffer)
 			_num_bits = 0;
 		}
 
-		_last_tms = (tms[pos >> 3] & (1 << (pos & 0x07))) ? 1 : 0;
-
-		if (_last_tms)
-			_tms[(_num_bits >> 3)] |= (1 << (_num_bits & 0x07));
-		else
-			_tms[(_num_bits >> 3)] &= ~(1 << (_num_bits & 0x07));
-		if (_last_tdi)
-			_tditdo[(_num_bits >> 3)] |= (1 << (_num_bits & 0x07));
-		else
-			_tditdo[(_num_bits >> 3)] &= ~(1 << (_num_bits & 0x07));
-		_num_bits++;
+		// copy as much bits as possible: TMS from sequence, TDI unchanged
+		uint32_t xfer = std::min(len - pos, _buffer_size * 8 - _num_bits);
+		bit_copy(_tms, _num_bits, tms, pos, xfer);
+		bit_fill(_tditdo, _num_bits, xfer, _last_tdi);
+		pos += xfer;
+		_num_bits += xfer;
+		_last_tms = bit_get(tms, pos - 1);
 	}
 
 	// flush where it's asked or if the buffer is full
@@ -209,9 +208,9 @@ int XVC_client::setClkFreq(uint32_t clkHz)
 		return -EXIT_FAILURE;
 	}
 
-	printf("freq %d %lf %d %d\n", clkHz, clk_periodf, clk_period,
+	printfInfo("freq %d %lf %d %d\n", clkHz, clk_periodf, clk_period,
 			atoi((const char *)_xfer_buf));
-	printf("%x %x %x %x\n", _xfer_buf[0], _xfer_buf[1],
+	printfInfo("%x %x %x %x\n", _xfer_buf[0], _xfer_buf[1],
 			_xfer_buf[2], _xfer_buf[3]);
 
 	_clkHZ = clkHz;
@@ -247,6 +246,7 @@ ssize_t XVC_client::xfer_pkt(const string &instr,
 	ssize_t len = tx_size;
 
 	/* 1. instruction */
+	uint64_t t = stats_start();
 	if (send(_sock, instr.c_str(), instr.size(), 0) == -1) {
 		printError("Send instruction failed");
 		return -1;
@@ -258,22 +258,25 @@ ssize_t XVC_client::xfer_pkt(const string &instr,
 			return -1;
 		}
 	}
+	stats_xfer_out(instr.size() + ((tx) ? tx_size : 0), t);
 
 	if (rx) {
+		t = stats_start();
 		len = recv(_sock, rx, rx_size, 0);
+		stats_xfer_in((len < 0) ? 0 : len, t);
 		if (len < 0) {
 			printError("Receive error");
 		} else if (len == 0) {
-			fprintf(stderr, "Client orderly shut down the connection.\n");
+			printfError("Client orderly shut down the connection.\n");
 		}
 		rx[len] = '\0';
 		if (_verbose) {
 			printInfo("received " + std::to_string(len) + " Bytes (" +
 					std::to_string(len * 8) + ")");
-			printf("\t");
+			printfInfo("\t");
 			for (int i = 0; i < len; i++)
-				printf("%02x ", rx[i]);
-			printf("\n");
+				printfInfo("%02x ", rx[i]);
+			printfInfo("\n");
 		}
 	}
 
@@ -370,68 +370,11 @@ int XVC_server::handle_data(int fd)
 	return 0;
 }
 
-/* loops over tms_seq, extracts bit by bit values and update
+/* follows tms_seq (8 bits per lookup) and update
  * jtag "virtual" state accordingly.
  */
 Jtag::tapState_t XVC_server::set_state(const uint8_t *tms_seq, uint32_t len)
 {
-	for (uint32_t i = 0; i < len; i++) {
-		uint8_t tms = !!(tms_seq[i >> 3] & (1 << (i & 0x07)));
-		switch (_state) {
-			case Jtag::TEST_LOGIC_RESET:
-				_state = (tms) ? Jtag::TEST_LOGIC_RESET : Jtag::RUN_TEST_IDLE;
-				break;
-			case Jtag::RUN_TEST_IDLE:
-				_state = (tms) ? Jtag::SELECT_DR_SCAN : Jtag::RUN_TEST_IDLE;
-				break;
-			case Jtag::SELECT_DR_SCAN:
-				_state = (tms) ? Jtag::SELECT_IR_SCAN: Jtag::CAPTURE_DR;
-				break;
-			case Jtag::CAPTURE_DR:
-				_state = (tms) ? Jtag::EXIT1_DR : Jtag::SHIFT_DR;
-				break;
-			case Jtag::SHIFT_DR:
-				_state = (tms) ? Jtag::EXIT1_DR : Jtag::CAPTURE_DR;
-				break;
-			case Jtag::EXIT1_DR:
-				_state = (tms) ? Jtag::UPDATE_DR : Jtag::PAUSE_DR;
-				break;
-			case Jtag::PAUSE_DR:
-				_state = (tms) ? Jtag::EXIT2_DR : Jtag::PAUSE_DR;
-				break;
-			case Jtag::EXIT2_DR:
-				_state = (tms) ? Jtag::UPDATE_DR : Jtag::SHIFT_DR;
-				break;
-			case Jtag::UPDATE_DR:
-				_state = (tms) ? Jtag::SELECT_DR_SCAN : Jtag::RUN_TEST_IDLE;
-				break;
-
-			case Jtag::SELECT_IR_SCAN:
-				_state = (tms) ? Jtag::TEST_LOGIC_RESET : Jtag::CAPTURE_IR;
-				break;
-			case Jtag::CAPTURE_IR:
-				_state = (tms) ? Jtag::EXIT1_IR : Jtag::SHIFT_IR;
-				break;
-			case Jtag::SHIFT_IR:
-				_state = (tms) ? Jtag::EXIT1_IR : Jtag::CAPTURE_IR;
-				break;
-			case Jtag::EXIT1_IR:
-				_state = (tms) ? Jtag::UPDATE_IR : Jtag::PAUSE_IR;
-				break;
-			case Jtag::PAUSE_IR:
-				_state = (tms) ? Jtag::EXIT2_IR : Jtag::PAUSE_IR;
-				break;
-			case Jtag::EXIT2_IR:
-				_state = (tms) ? Jtag::UPDATE_IR : Jtag::SHIFT_IR;
-				break;
-			case Jtag::UPDATE_IR:
-				_state = (tms) ? Jtag::SELECT_DR_SCAN : Jtag::RUN_TEST_IDLE;
-				break;
-			default:
-				/* pass */
-				break;
-		}
-	}
-
+	_state = Jtag::walk_tms(_state, tms_seq, len);
 	return _state;
 }